@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compare simplified timeline PAL against PALOLD
+// Same synthetic workloads are submitted to both engines with fixed queue
+// depth, and simulated throughput, mean latency and wall clock time of each
+// engine are printed.
+//
+// Usage: pal_benchmark <config file> [# requests] [queue depth]
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "pal/pal.hh"
+#include "pal/pal_lite.hh"
+#include "pal/pal_old.hh"
+#include "util/algorithm.hh"
+#include "util/simplessd.hh"
+
+using namespace SimpleSSD;
+
+// Minimal discrete event engine driving PAL
+class EventEngine : public Simulator {
+ private:
+  uint64_t tick;
+  Event counter;
+  std::unordered_map<Event, EventFunction> events;
+  std::multimap<uint64_t, Event> queue;
+
+ public:
+  EventEngine() : tick(0), counter(0) {}
+
+  uint64_t getCurrentTick() override { return tick; }
+
+  Event allocateEvent(EventFunction func) override {
+    events.emplace(++counter, func);
+
+    return counter;
+  }
+
+  void scheduleEvent(Event eid, uint64_t when) override {
+    descheduleEvent(eid);
+    queue.emplace(when, eid);
+  }
+
+  void descheduleEvent(Event eid) override {
+    for (auto iter = queue.begin(); iter != queue.end(); iter++) {
+      if (iter->second == eid) {
+        queue.erase(iter);
+
+        break;
+      }
+    }
+  }
+
+  bool isScheduled(Event eid, uint64_t *when) override {
+    for (auto &iter : queue) {
+      if (iter.second == eid) {
+        if (when) {
+          *when = iter.first;
+        }
+
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void deallocateEvent(Event eid) override {
+    descheduleEvent(eid);
+    events.erase(eid);
+  }
+
+  // Run events until tick
+  void runUntil(uint64_t until) {
+    while (queue.size() > 0 && queue.begin()->first <= until) {
+      auto iter = queue.begin();
+      Event eid = iter->second;
+
+      tick = iter->first;
+      queue.erase(iter);
+
+      events[eid](tick);
+    }
+
+    tick = MAX(tick, until);
+  }
+};
+
+typedef enum {
+  WORKLOAD_SEQ_WRITE,
+  WORKLOAD_RAND_WRITE,
+  WORKLOAD_SEQ_READ,
+  WORKLOAD_RAND_READ,
+  WORKLOAD_MIXED,  // 70% random read, 30% random write
+  WORKLOAD_NUM
+} WORKLOAD;
+
+const char workloadName[WORKLOAD_NUM][16] = {
+    "seq. write", "rand. write", "seq. read", "rand. read", "mixed 7:3"};
+
+typedef struct {
+  double bandwidth;  // MB/s
+  double latency;    // us
+  double wallTime;   // ms
+} Result;
+
+Result run(EventEngine &timeline, PAL::AbstractPAL *pal,
+           PAL::Parameter &param, WORKLOAD workload, uint64_t count,
+           uint32_t depth) {
+  std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>>
+      inflight;
+  std::mt19937_64 gen(0);
+  std::uniform_int_distribution<uint32_t> blockDist(0, param.superBlock - 1);
+  std::uniform_int_distribution<uint32_t> pageDist(0, param.page - 1);
+  std::uniform_int_distribution<uint32_t> ratioDist(0, 9);
+  uint64_t lastFinishedAt = 0;
+  uint64_t sumLatency = 0;
+  uint64_t bytes = 0;
+  Result result;
+
+  auto begin = std::chrono::steady_clock::now();
+
+  for (uint64_t i = 0; i < count; i++) {
+    PAL::Request req(param.pageInSuperPage);
+    uint64_t arrived = getTick();
+    uint64_t tick;
+    bool write = false;
+
+    // Submit when one of requests in flight completes
+    if (inflight.size() == depth) {
+      arrived = MAX(arrived, inflight.top());
+      inflight.pop();
+    }
+
+    req.ioFlag.set();
+
+    switch (workload) {
+      case WORKLOAD_SEQ_WRITE:
+      case WORKLOAD_SEQ_READ:
+        req.blockIndex = (i / param.page) % param.superBlock;
+        req.pageIndex = i % param.page;
+        write = workload == WORKLOAD_SEQ_WRITE;
+
+        break;
+      default:
+        req.blockIndex = blockDist(gen);
+        req.pageIndex = pageDist(gen);
+        write = workload == WORKLOAD_RAND_WRITE ||
+                (workload == WORKLOAD_MIXED && ratioDist(gen) < 3);
+
+        break;
+    }
+
+    // PAL sees arrival as current tick
+    timeline.runUntil(arrived);
+    tick = arrived;
+
+    if (write) {
+      // Block is erased before its first page is written
+      if (workload == WORKLOAD_SEQ_WRITE && req.pageIndex == 0) {
+        pal->erase(req, tick);
+      }
+
+      pal->write(req, tick);
+    }
+    else {
+      pal->read(req, tick);
+    }
+
+    inflight.push(tick);
+    sumLatency += tick - arrived;
+    bytes += param.superPageSize;
+    lastFinishedAt = MAX(lastFinishedAt, tick);
+  }
+
+  auto end = std::chrono::steady_clock::now();
+
+  result.bandwidth = lastFinishedAt > 0
+                         ? bytes / ((double)lastFinishedAt / 1e12) / 1e6
+                         : 0.;
+  result.latency = (double)sumLatency / count / 1e6;
+  result.wallTime =
+      std::chrono::duration<double, std::milli>(end - begin).count();
+
+  return result;
+}
+
+int main(int argc, char *argv[]) {
+  uint64_t count = 100000;
+  uint32_t depth = 32;
+
+  if (argc < 2) {
+    printf("Usage: %s <config file> [# requests] [queue depth]\n", argv[0]);
+
+    return 1;
+  }
+
+  if (argc > 2) {
+    count = strtoull(argv[2], nullptr, 10);
+  }
+
+  if (argc > 3) {
+    depth = strtoul(argv[3], nullptr, 10);
+  }
+
+  if (count == 0 || depth == 0) {
+    printf("# requests and queue depth should be larger than 0\n");
+
+    return 1;
+  }
+
+  EventEngine engine;
+  ConfigReader conf =
+      initSimpleSSDEngine(&engine, nullptr, &std::cerr, argv[1]);
+  PAL::PAL pal(conf);
+  PAL::Parameter &param = *pal.getInfo();
+
+  printf("%" PRIu64 " requests of %u bytes, queue depth %u\n", count,
+         param.superPageSize, depth);
+  printf("%-12s | %-8s | %10s | %12s | %10s\n", "Workload", "Engine",
+         "MB/s", "Latency(us)", "Wall(ms)");
+
+  for (int i = 0; i < WORKLOAD_NUM; i++) {
+    Result result[2];
+
+    // Each engine runs on its own timeline
+    for (int j = 0; j < 2; j++) {
+      EventEngine timeline;
+      PAL::AbstractPAL *target;
+
+      setSimulator(&timeline);
+
+      if (j == 0) {
+        target = new PAL::PALOLD(param, conf);
+      }
+      else {
+        target = new PAL::PALLite(param, conf);
+      }
+
+      result[j] = run(timeline, target, param, (WORKLOAD)i, count, depth);
+
+      delete target;
+    }
+
+    for (int j = 0; j < 2; j++) {
+      printf("%-12s | %-8s | %10.2f | %12.2f | %10.2f\n",
+             j == 0 ? workloadName[i] : "", j == 0 ? "PALOLD" : "PALLite",
+             result[j].bandwidth, result[j].latency, result[j].wallTime);
+    }
+
+    printf("%-12s | %-8s | %9.2f%% | %11.2f%% | %9.2fx\n", "", "Error",
+           (result[1].bandwidth / result[0].bandwidth - 1.) * 100.,
+           (result[1].latency / result[0].latency - 1.) * 100.,
+           result[0].wallTime / result[1].wallTime);
+  }
+
+  setSimulator(&engine);
+  releaseSimpleSSDEngine();
+
+  return 0;
+}
@@ -22,156 +22,53 @@
 #include <algorithm>
 #include <cstring>
 
+#include "util/algorithm.hh"
+
 namespace SimpleSSD {
 
 namespace FTL {
 
-Block::Block(uint32_t blockIdx, uint32_t count, uint32_t ioUnit)
-    : idx(blockIdx),
-      pageCount(count),
-      ioUnitInPage(ioUnit),
-      pValidBits(nullptr),
-      pErasedBits(nullptr),
-      pLPNs(nullptr),
-      ppLPNs(nullptr),
-      lastAccessed(0),
-      eraseCount(0) {
-  if (ioUnitInPage == 1) {
-    pValidBits = new Bitset(pageCount);
-    pErasedBits = new Bitset(pageCount);
-
-    pLPNs = (uint64_t *)calloc(pageCount, sizeof(uint64_t));
-  }
-  else if (ioUnitInPage > 1) {
-    Bitset copy(ioUnitInPage);
-
-    validBits = std::vector<Bitset>(pageCount, copy);
-    erasedBits = std::vector<Bitset>(pageCount, copy);
-
-    ppLPNs = (uint64_t **)calloc(pageCount, sizeof(uint64_t *));
-
-    for (uint32_t i = 0; i < pageCount; i++) {
-      ppLPNs[i] = (uint64_t *)calloc(ioUnitInPage, sizeof(uint64_t));
-    }
-  }
-  else {
+BlockArena::BlockArena(uint32_t count, uint32_t page, uint32_t ioUnit)
+    : blockCount(count), pageCount(page), ioUnitInPage(ioUnit) {
+  if (ioUnitInPage == 0) {
     panic("Invalid I/O unit in page");
   }
 
-  // C-style allocation
-  pNextWritePageIndex = (uint32_t *)calloc(ioUnitInPage, sizeof(uint32_t));
-
-  erase();
-  eraseCount = 0;
-}
-
-Block::Block(const Block &old)
-    : Block(old.idx, old.pageCount, old.ioUnitInPage) {
-  if (ioUnitInPage == 1) {
-    *pValidBits = *old.pValidBits;
-    *pErasedBits = *old.pErasedBits;
+  bitmapSize = DIVCEIL((uint64_t)pageCount * ioUnitInPage, 64);
 
-    memcpy(pLPNs, old.pLPNs, pageCount * sizeof(uint64_t));
-  }
-  else {
-    validBits = old.validBits;
-    erasedBits = old.erasedBits;
+  validBits.resize((uint64_t)blockCount * bitmapSize, 0);
+  erasedBits.resize((uint64_t)blockCount * bitmapSize, 0);
+  lpns.resize((uint64_t)blockCount * pageCount * ioUnitInPage, 0);
+  nextWritePageIndex.resize((uint64_t)blockCount * ioUnitInPage, 0);
+  lastAccessed.resize(blockCount, 0);
+  eraseCount.resize(blockCount, 0);
 
-    for (uint32_t i = 0; i < pageCount; i++) {
-      memcpy(ppLPNs[i], old.ppLPNs[i], ioUnitInPage * sizeof(uint64_t));
-    }
+  // All blocks are erased
+  for (uint32_t i = 0; i < blockCount; i++) {
+    Block(*this, i).erase();
   }
 
-  memcpy(pNextWritePageIndex, old.pNextWritePageIndex,
-         ioUnitInPage * sizeof(uint32_t));
-
-  eraseCount = old.eraseCount;
+  std::fill(eraseCount.begin(), eraseCount.end(), 0);
 }
 
-Block::Block(Block &&old) noexcept
-    : idx(std::move(old.idx)),
-      pageCount(std::move(old.pageCount)),
-      ioUnitInPage(std::move(old.ioUnitInPage)),
-      pNextWritePageIndex(std::move(old.pNextWritePageIndex)),
-      pValidBits(std::move(old.pValidBits)),
-      pErasedBits(std::move(old.pErasedBits)),
-      pLPNs(std::move(old.pLPNs)),
-      validBits(std::move(old.validBits)),
-      erasedBits(std::move(old.erasedBits)),
-      ppLPNs(std::move(old.ppLPNs)),
-      lastAccessed(std::move(old.lastAccessed)),
-      eraseCount(std::move(old.eraseCount)) {
-  // TODO Use std::exchange to set old value to null (C++14)
-  old.idx = 0;
-  old.pageCount = 0;
-  old.ioUnitInPage = 0;
-  old.pNextWritePageIndex = nullptr;
-  old.pValidBits = nullptr;
-  old.pErasedBits = nullptr;
-  old.pLPNs = nullptr;
-  old.ppLPNs = nullptr;
-  old.lastAccessed = 0;
-  old.eraseCount = 0;
-}
-
-Block::~Block() {
-  free(pNextWritePageIndex);
-  free(pLPNs);
-
-  delete pValidBits;
-  delete pErasedBits;
-
-  if (ppLPNs) {
-    for (uint32_t i = 0; i < pageCount; i++) {
-      free(ppLPNs[i]);
-    }
-
-    free(ppLPNs);
-  }
-
-  pNextWritePageIndex = nullptr;
-  pLPNs = nullptr;
-  pValidBits = nullptr;
-  pErasedBits = nullptr;
-  ppLPNs = nullptr;
+uint32_t BlockArena::getBlockCount() {
+  return blockCount;
 }
 
-Block &Block::operator=(const Block &rhs) {
-  if (this != &rhs) {
-    this->~Block();
-    *this = Block(rhs);  // Call copy constructor
+Block::Block(BlockArena &parent, uint32_t blockIdx)
+    : arena(&parent),
+      idx(blockIdx),
+      pageCount(parent.pageCount),
+      ioUnitInPage(parent.ioUnitInPage) {
+  if (idx >= arena->blockCount) {
+    panic("Block index out of range");
   }
 
-  return *this;
-}
-
-Block &Block::operator=(Block &&rhs) {
-  if (this != &rhs) {
-    this->~Block();
-
-    idx = std::move(rhs.idx);
-    pageCount = std::move(rhs.pageCount);
-    ioUnitInPage = std::move(rhs.ioUnitInPage);
-    pNextWritePageIndex = std::move(rhs.pNextWritePageIndex);
-    pValidBits = std::move(rhs.pValidBits);
-    pErasedBits = std::move(rhs.pErasedBits);
-    pLPNs = std::move(rhs.pLPNs);
-    validBits = std::move(rhs.validBits);
-    erasedBits = std::move(rhs.erasedBits);
-    ppLPNs = std::move(rhs.ppLPNs);
-    lastAccessed = std::move(rhs.lastAccessed);
-    eraseCount = std::move(rhs.eraseCount);
-
-    rhs.pNextWritePageIndex = nullptr;
-    rhs.pValidBits = nullptr;
-    rhs.pErasedBits = nullptr;
-    rhs.pLPNs = nullptr;
-    rhs.ppLPNs = nullptr;
-    rhs.lastAccessed = 0;
-    rhs.eraseCount = 0;
-  }
-
-  return *this;
+  pValidBits = arena->validBits.data() + (uint64_t)idx * arena->bitmapSize;
+  pErasedBits = arena->erasedBits.data() + (uint64_t)idx * arena->bitmapSize;
+  pLPNs = arena->lpns.data() + (uint64_t)idx * pageCount * ioUnitInPage;
+  pNextWritePageIndex =
+      arena->nextWritePageIndex.data() + (uint64_t)idx * ioUnitInPage;
 }
 
 uint32_t Block::getBlockIndex() const {
@@ -179,22 +76,52 @@ uint32_t Block::getBlockIndex() const {
 }
 
 uint64_t Block::getLastAccessedTime() {
-  return lastAccessed;
+  return arena->lastAccessed[idx];
 }
 
 uint32_t Block::getEraseCount() {
-  return eraseCount;
+  return arena->eraseCount[idx];
 }
 
-uint32_t Block::getValidPageCount() {
+// Count pages which have at least one valid (or dirty) I/O unit
+uint32_t Block::countPages(bool dirty) {
+  uint64_t bitCount = (uint64_t)pageCount * ioUnitInPage;
   uint32_t ret = 0;
+  uint64_t word;
+
+  // Dirty: Valid(false), Erased(false)
+  auto getWord = [&](uint64_t i) -> uint64_t {
+    word = dirty ? ~(pValidBits[i] | pErasedBits[i]) : pValidBits[i];
+
+    if (i == bitCount / 64) {
+      word &= (1ull << (bitCount % 64)) - 1;
+    }
+
+    return word;
+  };
 
   if (ioUnitInPage == 1) {
-    ret = pValidBits->count();
+    for (uint64_t i = 0; i < arena->bitmapSize; i++) {
+      ret += popcount(getWord(i));
+    }
   }
   else {
-    for (auto &iter : validBits) {
-      if (iter.any()) {
+    for (uint64_t bit = 0; bit < bitCount;) {
+      uint64_t left = ioUnitInPage;
+      bool any = false;
+
+      while (left > 0) {
+        uint64_t offset = bit % 64;
+        uint64_t length = MIN(left, 64 - offset);
+        uint64_t mask =
+            length == 64 ? ~0ull : ((1ull << length) - 1) << offset;
+
+        any |= (getWord(bit / 64) & mask) != 0;
+        bit += length;
+        left -= length;
+      }
+
+      if (any) {
         ret++;
       }
     }
@@ -203,38 +130,23 @@ uint32_t Block::getValidPageCount() {
   return ret;
 }
 
+uint32_t Block::getValidPageCount() {
+  return countPages(false);
+}
+
 uint32_t Block::getValidPageCountRaw() {
   uint32_t ret = 0;
 
-  if (ioUnitInPage == 1) {
-    // Same as getValidPageCount()
-    ret = pValidBits->count();
-  }
-  else {
-    for (auto &iter : validBits) {
-      ret += iter.count();
-    }
+  // Bits after last page are always zero
+  for (uint64_t i = 0; i < arena->bitmapSize; i++) {
+    ret += popcount(pValidBits[i]);
   }
 
   return ret;
 }
 
 uint32_t Block::getDirtyPageCount() {
-  uint32_t ret = 0;
-
-  if (ioUnitInPage == 1) {
-    ret = (~(*pValidBits | *pErasedBits)).count();
-  }
-  else {
-    for (uint32_t i = 0; i < pageCount; i++) {
-      // Dirty: Valid(false), Erased(false)
-      if ((~(validBits.at(i) | erasedBits.at(i))).any()) {
-        ret++;
-      }
-    }
-  }
-
-  return ret;
+  return countPages(true);
 }
 
 uint32_t Block::getNextWritePageIndex() {
@@ -255,17 +167,22 @@ uint32_t Block::getNextWritePageIndex(uint32_t idx) {
 
 bool Block::getPageInfo(uint32_t pageIndex, std::vector<uint64_t> &lpn,
                         Bitset &map) {
-  if (ioUnitInPage == 1 && map.size() == 1) {
+  if (pageIndex >= pageCount) {
+    panic("Page index out of range");
+  }
+
+  if (map.size() == ioUnitInPage) {
     map.reset();
-    if (pValidBits->test(pageIndex)) {
-      map.set();
+
+    for (uint32_t i = 0; i < ioUnitInPage; i++) {
+      if (testBit(false, pageIndex, i)) {
+        map.set(i);
+      }
     }
-    lpn = std::vector<uint64_t>(1, pLPNs[pageIndex]);
-  }
-  else if (map.size() == ioUnitInPage) {
-    map = validBits.at(pageIndex);
-    lpn = std::vector<uint64_t>(ppLPNs[pageIndex],
-                                ppLPNs[pageIndex] + ioUnitInPage);
+
+    lpn = std::vector<uint64_t>(pLPNs + (uint64_t)pageIndex * ioUnitInPage,
+                                pLPNs + (uint64_t)(pageIndex + 1) *
+                                            ioUnitInPage);
   }
   else {
     panic("I/O map size mismatch");
@@ -277,18 +194,15 @@ bool Block::getPageInfo(uint32_t pageIndex, std::vector<uint64_t> &lpn,
 bool Block::read(uint32_t pageIndex, uint32_t idx, uint64_t tick) {
   bool read = false;
 
-  if (ioUnitInPage == 1 && idx == 0) {
-    read = pValidBits->test(pageIndex);
-  }
-  else if (idx < ioUnitInPage) {
-    read = validBits.at(pageIndex).test(idx);
+  if (idx < ioUnitInPage && pageIndex < pageCount) {
+    read = testBit(false, pageIndex, idx);
   }
   else {
     panic("I/O map size mismatch");
   }
 
   if (read) {
-    lastAccessed = tick;
+    arena->lastAccessed[this->idx] = tick;
   }
 
   return read;
@@ -299,13 +213,8 @@ bool Block::write(uint32_t pageIndex, uint64_t lpn, uint32_t idx,
   bool write = false;
 
   // mjo: ioUnitInPage == 1 means superpage is disabled
-  if (ioUnitInPage == 1 && idx == 0) {
-    // mjo: Super page disabled
-    write = pErasedBits->test(pageIndex);
-  }
-  else if (idx < ioUnitInPage) {
-    // mjo: Superpage enabled
-    write = erasedBits.at(pageIndex).test(idx);
+  if (idx < ioUnitInPage && pageIndex < pageCount) {
+    write = testBit(true, pageIndex, idx);
   }
   else {
     panic("I/O map size mismatch");
@@ -316,20 +225,12 @@ bool Block::write(uint32_t pageIndex, uint64_t lpn, uint32_t idx,
       panic("Write to block should sequential");
     }
 
-    lastAccessed = tick;
+    arena->lastAccessed[this->idx] = tick;
 
-    if (ioUnitInPage == 1) {
-      pErasedBits->reset(pageIndex);
-      pValidBits->set(pageIndex);
+    setBit(true, pageIndex, idx, false);
+    setBit(false, pageIndex, idx, true);
 
-      pLPNs[pageIndex] = lpn;
-    }
-    else {
-      erasedBits.at(pageIndex).reset(idx);
-      validBits.at(pageIndex).set(idx);
-
-      ppLPNs[pageIndex][idx] = lpn;
-    }
+    pLPNs[(uint64_t)pageIndex * ioUnitInPage + idx] = lpn;
 
     pNextWritePageIndex[idx] = pageIndex + 1;
   }
@@ -341,30 +242,116 @@ bool Block::write(uint32_t pageIndex, uint64_t lpn, uint32_t idx,
 }
 
 void Block::erase() {
-  if (ioUnitInPage == 1) {
-    pValidBits->reset();
-    pErasedBits->set();
-  }
-  else {
-    for (auto &iter : validBits) {
-      iter.reset();
-    }
-    for (auto &iter : erasedBits) {
-      iter.set();
-    }
+  uint64_t bitCount = (uint64_t)pageCount * ioUnitInPage;
+  uint32_t size = arena->bitmapSize;
+
+  memset(pValidBits, 0, size * sizeof(uint64_t));
+  memset(pErasedBits, 0xFF, size * sizeof(uint64_t));
+
+  // Keep bits after last page zero
+  if (bitCount % 64) {
+    pErasedBits[size - 1] = (1ull << (bitCount % 64)) - 1;
   }
 
   memset(pNextWritePageIndex, 0, sizeof(uint32_t) * ioUnitInPage);
 
-  eraseCount++;
+  arena->eraseCount[idx]++;
 }
 
 void Block::invalidate(uint32_t pageIndex, uint32_t idx) {
-  if (ioUnitInPage == 1) {
-    pValidBits->reset(pageIndex);
+  if (idx < ioUnitInPage && pageIndex < pageCount) {
+    setBit(false, pageIndex, idx, false);
+  }
+  else {
+    panic("I/O map size mismatch");
+  }
+}
+
+bool Block::testBit(bool erased, uint32_t pageIndex, uint32_t idx) {
+  uint64_t bit = (uint64_t)pageIndex * ioUnitInPage + idx;
+  uint64_t *bits = erased ? pErasedBits : pValidBits;
+
+  return bits[bit / 64] & (1ull << (bit % 64));
+}
+
+void Block::setBit(bool erased, uint32_t pageIndex, uint32_t idx, bool value) {
+  uint64_t bit = (uint64_t)pageIndex * ioUnitInPage + idx;
+  uint64_t *bits = erased ? pErasedBits : pValidBits;
+
+  if (value) {
+    bits[bit / 64] |= 1ull << (bit % 64);
   }
   else {
-    validBits.at(pageIndex).reset(idx);
+    bits[bit / 64] &= ~(1ull << (bit % 64));
+  }
+}
+
+// Bitmaps are packed in page-major order, so state does not depend on
+// ioUnitInPage specific layout
+void Block::saveState(std::vector<uint8_t> &data) {
+  uint64_t bitCount = (uint64_t)pageCount * ioUnitInPage;
+  std::vector<uint8_t> bits(DIVCEIL(bitCount, 8));
+
+  pushValue(data, idx);
+  pushValue(data, pageCount);
+  pushValue(data, ioUnitInPage);
+  pushValue(data, arena->lastAccessed[idx]);
+  pushValue(data, arena->eraseCount[idx]);
+  pushArray(data, pNextWritePageIndex, ioUnitInPage * sizeof(uint32_t));
+
+  for (int erased = 0; erased < 2; erased++) {
+    memset(bits.data(), 0, bits.size());
+
+    for (uint64_t i = 0; i < bitCount; i++) {
+      if (testBit(erased, i / ioUnitInPage, i % ioUnitInPage)) {
+        bits[i / 8] |= 1 << (i % 8);
+      }
+    }
+
+    pushArray(data, bits.data(), bits.size());
+  }
+
+  pushArray(data, pLPNs,
+            (uint64_t)pageCount * ioUnitInPage * sizeof(uint64_t));
+}
+
+void Block::loadState(std::vector<uint8_t> &data) {
+  uint64_t bitCount = (uint64_t)pageCount * ioUnitInPage;
+  std::vector<uint8_t> bits(DIVCEIL(bitCount, 8));
+  uint32_t value;
+
+  popArray(data, pLPNs,
+           (uint64_t)pageCount * ioUnitInPage * sizeof(uint64_t));
+
+  for (int erased = 1; erased >= 0; erased--) {
+    popArray(data, bits.data(), bits.size());
+
+    for (uint64_t i = 0; i < bitCount; i++) {
+      setBit(erased, i / ioUnitInPage, i % ioUnitInPage,
+             bits[i / 8] & (1 << (i % 8)));
+    }
+  }
+
+  popArray(data, pNextWritePageIndex, ioUnitInPage * sizeof(uint32_t));
+  popValue(data, arena->eraseCount[idx]);
+  popValue(data, arena->lastAccessed[idx]);
+
+  popValue(data, value);
+
+  if (value != ioUnitInPage) {
+    panic("I/O unit in page mismatch");
+  }
+
+  popValue(data, value);
+
+  if (value != pageCount) {
+    panic("Page count mismatch");
+  }
+
+  popValue(data, value);
+
+  if (value != idx) {
+    panic("Block index mismatch");
   }
 }
 
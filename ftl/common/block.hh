@@ -23,42 +23,60 @@
 #include <cinttypes>
 #include <vector>
 
+#include "sim/state.hh"
 #include "util/bitset.hh"
 
 namespace SimpleSSD {
 
 namespace FTL {
 
-class Block {
+class Block;
+
+// Metadata of all blocks in structure-of-arrays form
+// Each array is allocated once and indexed by block index, so Block is
+// just a view of its slice. Valid/erased bitmaps of a block are packed
+// in page-major order (bit of (page, idx) is page * ioUnitInPage + idx).
+class BlockArena {
+ private:
+  friend Block;
+
+  uint32_t blockCount;
+  uint32_t pageCount;
+  uint32_t ioUnitInPage;
+  uint32_t bitmapSize;  // # of 64bit words in bitmap of one block
+
+  std::vector<uint64_t> validBits;
+  std::vector<uint64_t> erasedBits;
+  std::vector<uint64_t> lpns;
+  std::vector<uint32_t> nextWritePageIndex;
+  std::vector<uint64_t> lastAccessed;
+  std::vector<uint32_t> eraseCount;
+
+ public:
+  BlockArena(uint32_t, uint32_t, uint32_t);
+
+  uint32_t getBlockCount();
+};
+
+class Block : public StateObject {
  private:
+  BlockArena *arena;
   uint32_t idx;
   uint32_t pageCount;
   uint32_t ioUnitInPage;
-  uint32_t *pNextWritePageIndex;
 
-  // Following variables are used when ioUnitInPage == 1
-  // mjo: Each bit represents a page in a block
-  Bitset *pValidBits;
-  Bitset *pErasedBits;
+  // Slices of arena
+  uint64_t *pValidBits;
+  uint64_t *pErasedBits;
   uint64_t *pLPNs;
+  uint32_t *pNextWritePageIndex;
 
-  // Following variables are used when ioUnitInPage > 1
-  // mjo: Each element represents a superpage. Superpage is introduced to minimize a page-mapping table.
-  std::vector<Bitset> validBits;
-  std::vector<Bitset> erasedBits;
-  uint64_t **ppLPNs;
-
-  uint64_t lastAccessed;
-  uint32_t eraseCount;
+  bool testBit(bool, uint32_t, uint32_t);
+  void setBit(bool, uint32_t, uint32_t, bool);
+  uint32_t countPages(bool);
 
  public:
-  Block(uint32_t, uint32_t, uint32_t);
-  Block(const Block &);      // Copy constructor
-  Block(Block &&) noexcept;  // Move constructor
-  ~Block();
-
-  Block &operator=(const Block &);  // Copy assignment
-  Block &operator=(Block &&);       // Move assignment
+  Block(BlockArena &, uint32_t);
 
   uint32_t getBlockIndex() const;
   uint64_t getLastAccessedTime();
@@ -73,6 +91,9 @@ class Block {
   bool write(uint32_t, uint64_t, uint32_t, uint64_t);
   void erase();
   void invalidate(uint32_t, uint32_t);
+
+  void saveState(std::vector<uint8_t> &) override;
+  void loadState(std::vector<uint8_t> &) override;
 };
 
 }  // namespace FTL
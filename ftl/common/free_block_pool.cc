@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ftl/common/free_block_pool.hh"
+
+#include "sim/trace.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+FreeBlockPool::FreeBlockPool(uint32_t units) : pools(units), blockCount(0) {}
+
+uint32_t FreeBlockPool::getBlockCount() {
+  return blockCount;
+}
+
+FreeBlockPool::Pool &FreeBlockPool::at(uint32_t idx) {
+  return pools.at(idx);
+}
+
+std::vector<FreeBlockPool::Pool>::iterator FreeBlockPool::begin() {
+  return pools.begin();
+}
+
+std::vector<FreeBlockPool::Pool>::iterator FreeBlockPool::end() {
+  return pools.end();
+}
+
+void FreeBlockPool::clear() {
+  for (auto &pool : pools) {
+    pool.clear();
+  }
+
+  blockCount = 0;
+}
+
+// Insert block to bucket of its erase count in given parallel unit
+void FreeBlockPool::insert(uint32_t idx, Block &&block, bool front) {
+  auto &list = pools.at(idx)[block.getEraseCount()];
+
+  if (front) {
+    list.emplace_front(std::move(block));
+  }
+  else {
+    list.emplace_back(std::move(block));
+  }
+
+  blockCount++;
+}
+
+// Move free block of given parallel unit to block list and return its index
+// Returns most erased free block if worn is set, least erased one otherwise.
+// Falls back to other parallel units when given one has no free block.
+uint32_t FreeBlockPool::take(uint32_t idx, bool worn,
+                             std::unordered_map<uint32_t, Block> &blocks) {
+  uint32_t blockIndex;
+
+  if (idx >= pools.size()) {
+    panic("Index out of range");
+  }
+
+  if (blockCount == 0) {
+    panic("No free block left");
+  }
+
+  auto pool = &pools.at(idx);
+
+  if (pool->empty()) {
+    // Just use least (or most) erased one in other parallel units
+    for (auto &iter : pools) {
+      if (iter.size() > 0 &&
+          (pool->empty() ||
+           (worn ? iter.rbegin()->first > pool->rbegin()->first
+                 : iter.begin()->first < pool->begin()->first))) {
+        pool = &iter;
+      }
+    }
+  }
+
+  auto bucket = worn ? std::prev(pool->end()) : pool->begin();
+  auto &list = bucket->second;
+
+  blockIndex = list.front().getBlockIndex();
+
+  // Insert found block to block list
+  if (blocks.find(blockIndex) != blocks.end()) {
+    panic("Corrupted");
+  }
+
+  blocks.emplace(blockIndex, std::move(list.front()));
+
+  // Remove found block from free block list
+  list.pop_front();
+
+  if (list.empty()) {
+    pool->erase(bucket);
+  }
+
+  blockCount--;
+
+  return blockIndex;
+}
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
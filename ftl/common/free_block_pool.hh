@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FTL_COMMON_FREE_BLOCK_POOL__
+#define __FTL_COMMON_FREE_BLOCK_POOL__
+
+#include <cinttypes>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "ftl/common/block.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+// Free blocks of each parallel unit, bucketed by erase count
+// Blocks are taken from the front of a bucket and returned to its back, so
+// blocks with same erase count are reused in FIFO order.
+class FreeBlockPool {
+ public:
+  typedef std::map<uint32_t, std::list<Block>> Pool;
+
+ private:
+  std::vector<Pool> pools;
+  uint32_t blockCount;  // For some libraries which std::list::size() is O(n)
+
+ public:
+  FreeBlockPool(uint32_t);
+
+  uint32_t getBlockCount();
+  Pool &at(uint32_t);
+  std::vector<Pool>::iterator begin();
+  std::vector<Pool>::iterator end();
+
+  void clear();
+  void insert(uint32_t, Block &&, bool = false);
+  uint32_t take(uint32_t, bool, std::unordered_map<uint32_t, Block> &);
+};
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ftl/common/stream_classifier.hh"
+
+#include "sim/trace.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+FrequencyClassifier::FrequencyClassifier(uint64_t lpnCount, uint8_t t)
+    : counter(lpnCount, 0), threshold(t), window(lpnCount), writes(0) {}
+
+WRITE_STREAM FrequencyClassifier::classify(Request &req) {
+  uint8_t &count = counter.at(req.lpn);
+  bool hot;
+
+  if (count < 0xFF) {
+    count++;
+  }
+
+  hot = count >= threshold;
+
+  // Aging
+  if (++writes == window) {
+    for (auto &iter : counter) {
+      iter >>= 1;
+    }
+
+    writes = 0;
+  }
+
+  return hot ? STREAM_HOST_HOT : STREAM_HOST_COLD;
+}
+
+void FrequencyClassifier::saveState(std::vector<uint8_t> &data) {
+  pushArray(data, counter.data(), counter.size());
+  pushValue(data, writes);
+}
+
+void FrequencyClassifier::loadState(std::vector<uint8_t> &data) {
+  popValue(data, writes);
+  popArray(data, counter.data(), counter.size());
+}
+
+WRITE_STREAM DirectiveClassifier::classify(Request &req) {
+  return req.streamID == 0 ? STREAM_HOST_HOT : STREAM_HOST_COLD;
+}
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __FTL_COMMON_STREAM_CLASSIFIER__
+#define __FTL_COMMON_STREAM_CLASSIFIER__
+
+#include <cinttypes>
+#include <vector>
+
+#include "sim/state.hh"
+#include "util/def.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+// Write streams. Each stream has its own write frontier (set of open blocks)
+typedef enum {
+  STREAM_HOST_HOT,   // Frequently updated host data
+  STREAM_HOST_COLD,  // Rarely updated host data
+  STREAM_GC,         // Data relocated by garbage collection
+  STREAM_COUNT,
+} WRITE_STREAM;
+
+// Decides which stream host write goes to
+class StreamClassifier : public StateObject {
+ public:
+  StreamClassifier() {}
+  virtual ~StreamClassifier() {}
+
+  virtual WRITE_STREAM classify(Request &) = 0;
+};
+
+// Per-LPN saturating update counter with aging
+// All counters are halved every window writes, so LPN is hot when it is
+// updated threshold times in recent window.
+class FrequencyClassifier : public StreamClassifier {
+ private:
+  std::vector<uint8_t> counter;
+  uint8_t threshold;
+  uint64_t window;
+  uint64_t writes;
+
+ public:
+  FrequencyClassifier(uint64_t, uint8_t);
+
+  WRITE_STREAM classify(Request &) override;
+
+  void saveState(std::vector<uint8_t> &) override;
+  void loadState(std::vector<uint8_t> &) override;
+};
+
+// Stream ID given by host (NVMe streams directive)
+// Writes without stream ID go to hot stream, and writes with any stream ID
+// go to cold stream. FTL has only two host frontiers, so distinct nonzero
+// stream IDs are not separated from each other; host should use stream ID 0
+// for frequently updated data and any other ID for the rest.
+class DirectiveClassifier : public StreamClassifier {
+ public:
+  DirectiveClassifier() {}
+
+  WRITE_STREAM classify(Request &) override;
+};
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
+
+#endif
@@ -0,0 +1,383 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ftl/common/victim_index.hh"
+
+#include <algorithm>
+#include <limits>
+
+#include "sim/trace.hh"
+#include "util/algorithm.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+VictimIndex::VictimIndex(uint32_t count, uint32_t max, bool heap)
+    : blockCount(count),
+      maxValidCount(max),
+      useHeap(heap),
+      validCount(count, 0),
+      lastAccessed(count, 0),
+      position(count, count),
+      bucketHead(max + 1, count),
+      prev(count, count),
+      next(count, count),
+      minBucket(max + 1),
+      heapEntries(0) {
+  candidates.reserve(blockCount);
+
+  if (useHeap) {
+    heaps.resize(maxValidCount + 1);
+  }
+}
+
+// Min-heap of last accessed time
+bool VictimIndex::compareEntry(const HeapEntry &a, const HeapEntry &b) {
+  return a.lastAccessed > b.lastAccessed;
+}
+
+void VictimIndex::link(uint32_t blockIndex) {
+  uint32_t bucket = validCount[blockIndex];
+
+  prev[blockIndex] = blockCount;
+  next[blockIndex] = bucketHead[bucket];
+
+  if (next[blockIndex] < blockCount) {
+    prev[next[blockIndex]] = blockIndex;
+  }
+
+  bucketHead[bucket] = blockIndex;
+
+  if (bucket < minBucket) {
+    minBucket = bucket;
+  }
+}
+
+void VictimIndex::unlink(uint32_t blockIndex) {
+  uint32_t bucket = validCount[blockIndex];
+
+  if (prev[blockIndex] < blockCount) {
+    next[prev[blockIndex]] = next[blockIndex];
+  }
+  else {
+    bucketHead[bucket] = next[blockIndex];
+  }
+
+  if (next[blockIndex] < blockCount) {
+    prev[next[blockIndex]] = prev[blockIndex];
+  }
+
+  prev[blockIndex] = blockCount;
+  next[blockIndex] = blockCount;
+}
+
+void VictimIndex::pushHeap(uint32_t blockIndex) {
+  if (!useHeap) {
+    return;
+  }
+
+  auto &heap = heaps[validCount[blockIndex]];
+
+  heap.push_back({lastAccessed[blockIndex], blockIndex});
+  std::push_heap(heap.begin(), heap.end(), compareEntry);
+
+  heapEntries++;
+
+  // Too many stale entries
+  if (heapEntries > 2 * candidates.size() + maxValidCount) {
+    rebuildHeap();
+  }
+}
+
+void VictimIndex::rebuildHeap() {
+  for (auto &heap : heaps) {
+    heap.clear();
+  }
+
+  for (auto &iter : candidates) {
+    heaps[validCount[iter]].push_back({lastAccessed[iter], iter});
+  }
+
+  for (auto &heap : heaps) {
+    std::make_heap(heap.begin(), heap.end(), compareEntry);
+  }
+
+  heapEntries = candidates.size();
+}
+
+bool VictimIndex::isStale(uint32_t bucket, HeapEntry &entry) {
+  return !isCandidate(entry.blockIndex) ||
+         validCount[entry.blockIndex] != bucket ||
+         lastAccessed[entry.blockIndex] != entry.lastAccessed;
+}
+
+float VictimIndex::getCostBenefit(uint32_t blockIndex, uint64_t tick) {
+  float utilization = (float)validCount[blockIndex] / maxValidCount;
+  uint64_t age = tick > lastAccessed[blockIndex]
+                     ? tick - lastAccessed[blockIndex]
+                     : 1;
+
+  return utilization / ((1 - utilization) * age);
+}
+
+void VictimIndex::sample(uint64_t count, std::mt19937 &gen,
+                         std::vector<uint32_t> &list) {
+  if (count >= candidates.size()) {
+    list.insert(list.end(), candidates.begin(), candidates.end());
+
+    return;
+  }
+
+  std::uniform_int_distribution<uint64_t> dist(0, candidates.size() - 1);
+  uint64_t begin = list.size();
+
+  while (list.size() - begin < count) {
+    uint32_t blockIndex = candidates[dist(gen)];
+
+    if (std::find(list.begin() + begin, list.end(), blockIndex) ==
+        list.end()) {
+      list.push_back(blockIndex);
+    }
+  }
+}
+
+bool VictimIndex::isCandidate(uint32_t blockIndex) {
+  return position.at(blockIndex) < blockCount;
+}
+
+uint32_t VictimIndex::getValidCount(uint32_t blockIndex) {
+  return validCount.at(blockIndex);
+}
+
+uint64_t VictimIndex::getCandidateCount() {
+  return candidates.size();
+}
+
+// Called when block is fully written
+void VictimIndex::insert(uint32_t blockIndex, uint64_t tick) {
+  if (isCandidate(blockIndex)) {
+    touch(blockIndex, tick);
+
+    return;
+  }
+
+  position[blockIndex] = candidates.size();
+  candidates.push_back(blockIndex);
+  lastAccessed[blockIndex] = tick;
+
+  link(blockIndex);
+  pushHeap(blockIndex);
+}
+
+// Called when block is erased
+void VictimIndex::erase(uint32_t blockIndex) {
+  if (isCandidate(blockIndex)) {
+    uint32_t last = candidates.back();
+
+    unlink(blockIndex);
+
+    candidates[position[blockIndex]] = last;
+    position[last] = position[blockIndex];
+    candidates.pop_back();
+    position[blockIndex] = blockCount;
+  }
+
+  validCount[blockIndex] = 0;
+}
+
+// Called when I/O unit is written
+void VictimIndex::increase(uint32_t blockIndex) {
+  if (validCount.at(blockIndex) >= maxValidCount) {
+    panic("Valid page count overflow");
+  }
+
+  if (isCandidate(blockIndex)) {
+    unlink(blockIndex);
+    validCount[blockIndex]++;
+    link(blockIndex);
+    pushHeap(blockIndex);
+  }
+  else {
+    validCount[blockIndex]++;
+  }
+}
+
+// Called when I/O units are invalidated
+void VictimIndex::decrease(uint32_t blockIndex, uint32_t count) {
+  if (validCount.at(blockIndex) < count) {
+    panic("Valid page count underflow");
+  }
+
+  if (isCandidate(blockIndex)) {
+    unlink(blockIndex);
+    validCount[blockIndex] -= count;
+    link(blockIndex);
+    pushHeap(blockIndex);
+  }
+  else {
+    validCount[blockIndex] -= count;
+  }
+}
+
+// Called when block is read
+void VictimIndex::touch(uint32_t blockIndex, uint64_t tick) {
+  if (isCandidate(blockIndex) && lastAccessed[blockIndex] != tick) {
+    lastAccessed[blockIndex] = tick;
+
+    pushHeap(blockIndex);
+  }
+}
+
+void VictimIndex::selectGreedy(uint64_t count, std::vector<uint32_t> &list) {
+  for (uint32_t bucket = minBucket;
+       bucket <= maxValidCount && list.size() < count; bucket++) {
+    uint32_t blockIndex = bucketHead[bucket];
+
+    if (blockIndex == blockCount && bucket == minBucket) {
+      minBucket++;
+    }
+
+    for (; blockIndex < blockCount && list.size() < count;
+         blockIndex = next[blockIndex]) {
+      list.push_back(blockIndex);
+    }
+  }
+}
+
+void VictimIndex::selectCostBenefit(uint64_t count, uint64_t tick,
+                                    std::vector<uint32_t> &list) {
+  uint64_t begin = list.size();
+
+  if (!useHeap) {
+    panic("Cost-benefit index is not enabled");
+  }
+
+  while (list.size() - begin < count) {
+    uint32_t victim = blockCount;
+    uint32_t victimBucket = 0;
+    float victimWeight = std::numeric_limits<float>::infinity();
+
+    // In each bucket, the oldest block has the lowest weight
+    for (uint32_t bucket = 0; bucket <= maxValidCount; bucket++) {
+      auto &heap = heaps[bucket];
+
+      while (heap.size() > 0 && isStale(bucket, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), compareEntry);
+        heap.pop_back();
+        heapEntries--;
+      }
+
+      if (heap.size() > 0) {
+        float weight = getCostBenefit(heap.front().blockIndex, tick);
+
+        if (victim == blockCount || weight < victimWeight) {
+          victim = heap.front().blockIndex;
+          victimBucket = bucket;
+          victimWeight = weight;
+        }
+      }
+    }
+
+    if (victim == blockCount) {
+      break;
+    }
+
+    // Hide selected block until selection finishes
+    auto &heap = heaps[victimBucket];
+
+    std::pop_heap(heap.begin(), heap.end(), compareEntry);
+    heap.pop_back();
+    heapEntries--;
+
+    position[victim] += blockCount;
+    list.push_back(victim);
+  }
+
+  // Restore selected blocks
+  for (uint64_t i = begin; i < list.size(); i++) {
+    position[list.at(i)] -= blockCount;
+    pushHeap(list.at(i));
+  }
+}
+
+void VictimIndex::selectRandom(uint64_t count, std::mt19937 &gen,
+                               std::vector<uint32_t> &list) {
+  sample(count, gen, list);
+}
+
+void VictimIndex::selectDChoice(uint64_t count, uint32_t d, std::mt19937 &gen,
+                                std::vector<uint32_t> &list) {
+  std::vector<uint32_t> selected;
+
+  sample(count * d, gen, selected);
+
+  std::sort(selected.begin(), selected.end(),
+            [this](uint32_t a, uint32_t b) -> bool {
+              return validCount[a] < validCount[b];
+            });
+
+  count = MIN(count, selected.size());
+
+  list.insert(list.end(), selected.begin(), selected.begin() + count);
+}
+
+// Bucket lists are saved as is to keep order of blocks with same weight
+void VictimIndex::saveState(std::vector<uint8_t> &data) {
+  uint64_t size = candidates.size();
+
+  pushArray(data, validCount.data(), blockCount * sizeof(uint32_t));
+  pushArray(data, lastAccessed.data(), blockCount * sizeof(uint64_t));
+  pushArray(data, candidates.data(), size * sizeof(uint32_t));
+  pushValue(data, size);
+  pushArray(data, position.data(), blockCount * sizeof(uint32_t));
+  pushArray(data, bucketHead.data(), bucketHead.size() * sizeof(uint32_t));
+  pushArray(data, prev.data(), blockCount * sizeof(uint32_t));
+  pushArray(data, next.data(), blockCount * sizeof(uint32_t));
+  pushValue(data, minBucket);
+}
+
+void VictimIndex::loadState(std::vector<uint8_t> &data) {
+  uint64_t size;
+
+  popValue(data, minBucket);
+  popArray(data, next.data(), blockCount * sizeof(uint32_t));
+  popArray(data, prev.data(), blockCount * sizeof(uint32_t));
+  popArray(data, bucketHead.data(), bucketHead.size() * sizeof(uint32_t));
+  popArray(data, position.data(), blockCount * sizeof(uint32_t));
+  popValue(data, size);
+
+  if (size > blockCount) {
+    panic("Invalid candidate count");
+  }
+
+  candidates.resize(size);
+
+  popArray(data, candidates.data(), size * sizeof(uint32_t));
+  popArray(data, lastAccessed.data(), blockCount * sizeof(uint64_t));
+  popArray(data, validCount.data(), blockCount * sizeof(uint32_t));
+
+  if (useHeap) {
+    rebuildHeap();
+  }
+}
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FTL_COMMON_VICTIM_INDEX__
+#define __FTL_COMMON_VICTIM_INDEX__
+
+#include <cinttypes>
+#include <random>
+#include <vector>
+
+#include "sim/state.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+// Index of GC victim candidates (fully written blocks)
+// Candidates are bucketed by valid page count (counted in I/O unit), so
+// greedy selection just walks buckets from the lowest one. For cost-benefit
+// policy, each bucket also keeps a min-heap of last accessed time. Heap
+// entries are not updated in place; stale ones are dropped when they reach
+// the top, and all heaps are rebuilt when stale entries pile up.
+class VictimIndex : public StateObject {
+ private:
+  typedef struct {
+    uint64_t lastAccessed;
+    uint32_t blockIndex;
+  } HeapEntry;
+
+  uint32_t blockCount;
+  uint32_t maxValidCount;
+  bool useHeap;
+
+  std::vector<uint32_t> validCount;    // Valid I/O units of all blocks
+  std::vector<uint64_t> lastAccessed;  // Last accessed time of candidates
+
+  // Candidate list for random sampling
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> position;  // Index in candidates or blockCount
+
+  // Doubly linked list of each bucket
+  std::vector<uint32_t> bucketHead;
+  std::vector<uint32_t> prev;
+  std::vector<uint32_t> next;
+  uint32_t minBucket;
+
+  std::vector<std::vector<HeapEntry>> heaps;
+  uint64_t heapEntries;
+
+  static bool compareEntry(const HeapEntry &, const HeapEntry &);
+
+  void link(uint32_t);
+  void unlink(uint32_t);
+  void pushHeap(uint32_t);
+  void rebuildHeap();
+  bool isStale(uint32_t, HeapEntry &);
+  float getCostBenefit(uint32_t, uint64_t);
+  void sample(uint64_t, std::mt19937 &, std::vector<uint32_t> &);
+
+ public:
+  VictimIndex(uint32_t, uint32_t, bool);
+
+  bool isCandidate(uint32_t);
+  uint32_t getValidCount(uint32_t);
+  uint64_t getCandidateCount();
+
+  void insert(uint32_t, uint64_t);
+  void erase(uint32_t);
+  void increase(uint32_t);
+  void decrease(uint32_t, uint32_t = 1);
+  void touch(uint32_t, uint64_t);
+
+  void selectGreedy(uint64_t, std::vector<uint32_t> &);
+  void selectCostBenefit(uint64_t, uint64_t, std::vector<uint32_t> &);
+  void selectRandom(uint64_t, std::mt19937 &, std::vector<uint32_t> &);
+  void selectDChoice(uint64_t, uint32_t, std::mt19937 &,
+                     std::vector<uint32_t> &);
+
+  void saveState(std::vector<uint8_t> &) override;
+  void loadState(std::vector<uint8_t> &) override;
+};
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
+
+#endif
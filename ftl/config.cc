@@ -37,7 +37,24 @@ const char NAME_GC_RECLAIM_BLOCK[] = "GCReclaimBlocks";
 const char NAME_GC_RECLAIM_THRESHOLD[] = "GCReclaimThreshold";
 const char NAME_GC_EVICT_POLICY[] = "EvictPolicy";
 const char NAME_GC_D_CHOICE_PARAM[] = "DChoiceParam";
+const char NAME_GC_USE_COPYBACK[] = "EnableCopyback";
 const char NAME_USE_RANDOM_IO_TWEAK[] = "EnableRandomIOTweak";
+const char NAME_SNAPSHOT_LOAD_PATH[] = "LoadSnapshot";
+const char NAME_SNAPSHOT_SAVE_PATH[] = "SaveSnapshot";
+const char NAME_BGC_ENABLE[] = "EnableBackgroundGC";
+const char NAME_BGC_IDLE_TIME[] = "BGCIdleTime";
+const char NAME_BGC_THRESHOLD[] = "BGCThreshold";
+const char NAME_STREAM_MODE[] = "WriteStreamMode";
+const char NAME_STREAM_HOT_THRESHOLD[] = "HotWriteThreshold";
+const char NAME_SLC_CACHE_RATIO[] = "SLCCacheRatio";
+const char NAME_SWL_ENABLE[] = "EnableStaticWL";
+const char NAME_SWL_THRESHOLD[] = "StaticWLThreshold";
+const char NAME_SWL_BUDGET[] = "StaticWLBudget";
+const char NAME_PLACEMENT_ENABLE[] = "EnablePageTypePlacement";
+const char NAME_READ_HOT_THRESHOLD[] = "HotReadThreshold";
+const char NAME_NKMAP_N[] = "NKMapN";
+const char NAME_NKMAP_K[] = "NKMapK";
+const char NAME_DFTL_CACHE_SIZE[] = "DFTLCacheSize";
 
 Config::Config() {
   mapping = PAGE_MAPPING;
@@ -52,7 +69,22 @@ Config::Config() {
   gcMode = GC_MODE_0;
   evictPolicy = POLICY_GREEDY;
   dChoiceParam = 3;
+  gcCopyback = false;
   randomIOTweak = true;
+  bgcEnable = false;
+  bgcIdleTime = 1000000000;
+  bgcThreshold = 0.1f;
+  streamMode = STREAM_MODE_NONE;
+  hotThreshold = 2;
+  slcCacheRatio = 0.f;
+  swlEnable = false;
+  swlThreshold = 100;
+  swlBudget = 0.05f;
+  placementEnable = false;
+  readHotThreshold = 4;
+  nkmapN = 16;
+  nkmapK = 4;
+  dftlCacheSize = 1048576;
 }
 
 bool Config::setConfig(const char *name, const char *value) {
@@ -94,9 +126,60 @@ bool Config::setConfig(const char *name, const char *value) {
   else if (MATCH_NAME(NAME_GC_D_CHOICE_PARAM)) {
     dChoiceParam = strtoul(value, nullptr, 10);
   }
+  else if (MATCH_NAME(NAME_GC_USE_COPYBACK)) {
+    gcCopyback = convertBool(value);
+  }
   else if (MATCH_NAME(NAME_USE_RANDOM_IO_TWEAK)) {
     randomIOTweak = convertBool(value);
   }
+  else if (MATCH_NAME(NAME_SNAPSHOT_LOAD_PATH)) {
+    snapshotLoadPath = value;
+  }
+  else if (MATCH_NAME(NAME_SNAPSHOT_SAVE_PATH)) {
+    snapshotSavePath = value;
+  }
+  else if (MATCH_NAME(NAME_BGC_ENABLE)) {
+    bgcEnable = convertBool(value);
+  }
+  else if (MATCH_NAME(NAME_BGC_IDLE_TIME)) {
+    bgcIdleTime = strtoull(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_BGC_THRESHOLD)) {
+    bgcThreshold = strtof(value, nullptr);
+  }
+  else if (MATCH_NAME(NAME_STREAM_MODE)) {
+    streamMode = (STREAM_MODE)strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_STREAM_HOT_THRESHOLD)) {
+    hotThreshold = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_SLC_CACHE_RATIO)) {
+    slcCacheRatio = strtof(value, nullptr);
+  }
+  else if (MATCH_NAME(NAME_SWL_ENABLE)) {
+    swlEnable = convertBool(value);
+  }
+  else if (MATCH_NAME(NAME_SWL_THRESHOLD)) {
+    swlThreshold = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_SWL_BUDGET)) {
+    swlBudget = strtof(value, nullptr);
+  }
+  else if (MATCH_NAME(NAME_PLACEMENT_ENABLE)) {
+    placementEnable = convertBool(value);
+  }
+  else if (MATCH_NAME(NAME_READ_HOT_THRESHOLD)) {
+    readHotThreshold = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_NKMAP_N)) {
+    nkmapN = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_NKMAP_K)) {
+    nkmapK = strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_DFTL_CACHE_SIZE)) {
+    dftlCacheSize = strtoul(value, nullptr, 10);
+  }
   else {
     ret = false;
   }
@@ -105,7 +188,7 @@ bool Config::setConfig(const char *name, const char *value) {
 }
 
 void Config::update() {
-  if (gcMode == GC_MODE_0 && reclaimBlock == 0) {
+  if ((gcMode == GC_MODE_0 || gcMode == GC_MODE_2) && reclaimBlock == 0) {
     panic("Invalid GCReclaimBlocks");
   }
 
@@ -113,6 +196,10 @@ void Config::update() {
     panic("Invalid GCReclaimThreshold");
   }
 
+  if (gcMode == GC_MODE_2 && reclaimThreshold <= gcThreshold) {
+    panic("Invalid GCReclaimThreshold");
+  }
+
   if (fillingRatio < 0.f || fillingRatio > 1.f) {
     panic("Invalid FillingRatio");
   }
@@ -120,6 +207,47 @@ void Config::update() {
   if (invalidRatio < 0.f || invalidRatio > 1.f) {
     panic("Invalid InvalidPageRatio");
   }
+
+  if (bgcEnable && bgcThreshold < gcThreshold) {
+    panic("Invalid BGCThreshold");
+  }
+
+  if (streamMode > STREAM_MODE_DIRECTIVE) {
+    panic("Invalid WriteStreamMode");
+  }
+
+  if (streamMode == STREAM_MODE_FREQUENCY &&
+      (hotThreshold == 0 || hotThreshold > 255)) {
+    panic("Invalid HotWriteThreshold");
+  }
+
+  if (slcCacheRatio < 0.f || slcCacheRatio >= overProvision) {
+    panic("Invalid SLCCacheRatio");
+  }
+
+  if (swlEnable && swlThreshold == 0) {
+    panic("Invalid StaticWLThreshold");
+  }
+
+  if (swlEnable && (swlBudget <= 0.f || swlBudget > 1.f)) {
+    panic("Invalid StaticWLBudget");
+  }
+
+  if (placementEnable && (readHotThreshold == 0 || readHotThreshold > 255)) {
+    panic("Invalid HotReadThreshold");
+  }
+
+  if (mapping == NK_MAPPING && nkmapN == 0) {
+    panic("Invalid NKMapN");
+  }
+
+  if (mapping == NK_MAPPING && nkmapK == 0) {
+    panic("Invalid NKMapK");
+  }
+
+  if (mapping == DEMAND_PAGE_MAPPING && dftlCacheSize == 0) {
+    panic("Invalid DFTLCacheSize");
+  }
 }
 
 int64_t Config::readInt(uint32_t idx) {
@@ -135,6 +263,9 @@ int64_t Config::readInt(uint32_t idx) {
     case FTL_GC_EVICT_POLICY:
       ret = evictPolicy;
       break;
+    case FTL_STREAM_MODE:
+      ret = streamMode;
+      break;
   }
 
   return ret;
@@ -156,6 +287,27 @@ uint64_t Config::readUint(uint32_t idx) {
     case FTL_GC_D_CHOICE_PARAM:
       ret = dChoiceParam;
       break;
+    case FTL_BGC_IDLE_TIME:
+      ret = bgcIdleTime;
+      break;
+    case FTL_STREAM_HOT_THRESHOLD:
+      ret = hotThreshold;
+      break;
+    case FTL_SWL_THRESHOLD:
+      ret = swlThreshold;
+      break;
+    case FTL_READ_HOT_THRESHOLD:
+      ret = readHotThreshold;
+      break;
+    case FTL_NKMAP_N:
+      ret = nkmapN;
+      break;
+    case FTL_NKMAP_K:
+      ret = nkmapK;
+      break;
+    case FTL_DFTL_CACHE_SIZE:
+      ret = dftlCacheSize;
+      break;
   }
 
   return ret;
@@ -180,6 +332,15 @@ float Config::readFloat(uint32_t idx) {
     case FTL_GC_RECLAIM_THRESHOLD:
       ret = reclaimThreshold;
       break;
+    case FTL_BGC_THRESHOLD_RATIO:
+      ret = bgcThreshold;
+      break;
+    case FTL_SLC_CACHE_RATIO:
+      ret = slcCacheRatio;
+      break;
+    case FTL_SWL_BUDGET:
+      ret = swlBudget;
+      break;
   }
 
   return ret;
@@ -192,6 +353,33 @@ bool Config::readBoolean(uint32_t idx) {
     case FTL_USE_RANDOM_IO_TWEAK:
       ret = randomIOTweak;
       break;
+    case FTL_GC_USE_COPYBACK:
+      ret = gcCopyback;
+      break;
+    case FTL_BGC_ENABLE:
+      ret = bgcEnable;
+      break;
+    case FTL_SWL_ENABLE:
+      ret = swlEnable;
+      break;
+    case FTL_PLACEMENT_ENABLE:
+      ret = placementEnable;
+      break;
+  }
+
+  return ret;
+}
+
+std::string Config::readString(uint32_t idx) {
+  std::string ret;
+
+  switch (idx) {
+    case FTL_SNAPSHOT_LOAD_PATH:
+      ret = snapshotLoadPath;
+      break;
+    case FTL_SNAPSHOT_SAVE_PATH:
+      ret = snapshotSavePath;
+      break;
   }
 
   return ret;
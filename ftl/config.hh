@@ -20,6 +20,8 @@
 #ifndef __FTL_CONFIG__
 #define __FTL_CONFIG__
 
+#include <string>
+
 #include "sim/base_config.hh"
 
 namespace SimpleSSD {
@@ -40,20 +42,40 @@ typedef enum {
   FTL_GC_RECLAIM_THRESHOLD,
   FTL_GC_EVICT_POLICY,
   FTL_GC_D_CHOICE_PARAM,
+  FTL_GC_USE_COPYBACK,
   FTL_USE_RANDOM_IO_TWEAK,
+  FTL_SNAPSHOT_LOAD_PATH,
+  FTL_SNAPSHOT_SAVE_PATH,
+  FTL_BGC_ENABLE,
+  FTL_BGC_IDLE_TIME,
+  FTL_BGC_THRESHOLD_RATIO,
+  FTL_STREAM_MODE,
+  FTL_STREAM_HOT_THRESHOLD,
+  FTL_SLC_CACHE_RATIO,
+  FTL_SWL_ENABLE,
+  FTL_SWL_THRESHOLD,
+  FTL_SWL_BUDGET,
+  FTL_PLACEMENT_ENABLE,
+  FTL_READ_HOT_THRESHOLD,
 
   /* N+K Mapping configuration*/
   FTL_NKMAP_N,
   FTL_NKMAP_K,
+
+  /* DFTL configuration */
+  FTL_DFTL_CACHE_SIZE,
 } FTL_CONFIG;
 
 typedef enum {
   PAGE_MAPPING,
+  DEMAND_PAGE_MAPPING,  // DFTL
+  NK_MAPPING,           // N+K hybrid mapping
 } MAPPING;
 
 typedef enum {
   GC_MODE_0,  // Reclaim fixed number of blocks
   GC_MODE_1,  // Reclaim blocks until threshold
+  GC_MODE_2,  // Reclaim few pages on each write, between thresholds
 } GC_MODE;
 
 typedef enum {
@@ -69,6 +91,12 @@ typedef enum {
   POLICY_DCHOICE,
 } EVICT_POLICY;
 
+typedef enum {
+  STREAM_MODE_NONE,       // Single write frontier for all writes
+  STREAM_MODE_FREQUENCY,  // Classify host writes by update frequency
+  STREAM_MODE_DIRECTIVE,  // Classify host writes by stream ID of host
+} STREAM_MODE;
+
 class Config : public BaseConfig {
  private:
   MAPPING mapping;             //!< Default: PAGE_MAPPING
@@ -83,7 +111,27 @@ class Config : public BaseConfig {
   GC_MODE gcMode;              //!< Default: FTL_GC_MODE_0
   EVICT_POLICY evictPolicy;    //!< Default: POLICY_GREEDY
   uint64_t dChoiceParam;       //!< Default: 3
+  bool gcCopyback;             //!< Default: false
   bool randomIOTweak;          //!< Default: true
+  bool bgcEnable;              //!< Default: false
+  uint64_t bgcIdleTime;        //!< Default: 1000000000 (1ms)
+  float bgcThreshold;          //!< Default: 0.1 (10%)
+  STREAM_MODE streamMode;      //!< Default: STREAM_MODE_NONE
+  uint64_t hotThreshold;       //!< Default: 2
+  float slcCacheRatio;         //!< Default: 0.0 (Disabled)
+  bool swlEnable;              //!< Default: false
+  uint64_t swlThreshold;       //!< Default: 100
+  float swlBudget;             //!< Default: 0.05 (5%)
+  bool placementEnable;        //!< Default: false
+  uint64_t readHotThreshold;   //!< Default: 4
+
+  std::string snapshotLoadPath;  //!< Default: "" (Fill drive in initialize)
+  std::string snapshotSavePath;  //!< Default: "" (Do not save)
+
+  uint64_t nkmapN;  //!< Default: 16
+  uint64_t nkmapK;  //!< Default: 4
+
+  uint64_t dftlCacheSize;  //!< Default: 1048576 (1MiB)
 
  public:
   Config();
@@ -95,6 +143,7 @@ class Config : public BaseConfig {
   uint64_t readUint(uint32_t) override;
   float readFloat(uint32_t) override;
   bool readBoolean(uint32_t) override;
+  std::string readString(uint32_t) override;
 };
 
 }  // namespace FTL
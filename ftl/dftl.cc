@@ -0,0 +1,378 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ftl/dftl.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#include "util/algorithm.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+// Size of mapping entry of one I/O unit (block index and page index)
+const uint64_t ENTRY_SIZE = 8;
+
+static uint64_t getEntriesInPage(ConfigReader &conf, Parameter &param) {
+  uint64_t bitsetSize = conf.readBoolean(CONFIG_FTL, FTL_USE_RANDOM_IO_TWEAK)
+                            ? param.ioUnitInPage
+                            : 1;
+
+  return MAX(param.pageSize / (ENTRY_SIZE * bitsetSize), 1);
+}
+
+static uint64_t getTranslationPageCount(ConfigReader &conf,
+                                        Parameter &param) {
+  return DIVCEIL(param.totalLogicalBlocks * param.pagesInBlock,
+                 getEntriesInPage(conf, param));
+}
+
+DFTL::DFTL(ConfigReader &c, Parameter &p, PAL::PAL *l, DRAM::AbstractDRAM *d)
+    : PageMapping(c, p, l, d, getTranslationPageCount(c, p)),
+      entriesInPage(getEntriesInPage(c, p)),
+      nTranslationPages(nMetaPages),
+      cacheCapacity(MAX(conf.readUint(CONFIG_FTL, FTL_DFTL_CACHE_SIZE) /
+                            (ENTRY_SIZE * bitsetSize),
+                        1)),
+      dirtyEntries(nTranslationPages, 0) {
+  cmt.reserve(MIN(cacheCapacity, status.totalLogicalPages));
+
+  memset(&dftlStat, 0, sizeof(dftlStat));
+}
+
+DFTL::~DFTL() {}
+
+bool DFTL::initialize() {
+  PageMapping::initialize();
+
+  debugprint(LOG_FTL_DFTL,
+             "%" PRIu64 " LPNs per translation page, %" PRIu64
+             " translation pages", entriesInPage, nTranslationPages);
+  debugprint(LOG_FTL_DFTL, "Cached mapping table holds %" PRIu64 " LPNs",
+             cacheCapacity);
+
+  return true;
+}
+
+void DFTL::read(Request &req, uint64_t &tick) {
+  if (req.ioFlag.count() > 0) {
+    loadMapping(req.lpn, false, tick);
+  }
+
+  PageMapping::read(req, tick);
+}
+
+void DFTL::write(Request &req, uint64_t &tick) {
+  if (req.ioFlag.count() > 0) {
+    loadMapping(req.lpn, true, tick);
+  }
+
+  PageMapping::write(req, tick);
+}
+
+void DFTL::trim(Request &req, uint64_t &tick) {
+  loadMapping(req.lpn, true, tick);
+
+  PageMapping::trim(req, tick);
+}
+
+// Translation pages of range are updated once, instead of loading each LPN
+// into CMT
+void DFTL::trim(LPNRange &range, uint64_t &tick) {
+  PageMapping::trim(range, tick);
+
+  flushTranslationPages(range, tick);
+}
+
+void DFTL::format(LPNRange &range, uint64_t &tick) {
+  PageMapping::format(range, tick);
+
+  flushTranslationPages(range, tick);
+}
+
+// Write translation pages which hold filled LPNs
+void DFTL::fillMetadata() {
+  uint64_t written = 0;
+
+  for (uint64_t tpn = 0; tpn < nTranslationPages; tpn++) {
+    if (countMappedLPNs(tpn * entriesInPage, (tpn + 1) * entriesInPage) > 0) {
+      fillSequential(status.totalLogicalPages + tpn, 1);
+      written++;
+    }
+  }
+
+  debugprint(LOG_FTL_DFTL, "%" PRIu64 " translation pages written", written);
+}
+
+
+void DFTL::loadMapping(uint64_t lpn, bool dirty, uint64_t &tick) {
+  uint64_t tpn = lpn / entriesInPage;
+  auto iter = cmt.find(lpn);
+
+  if (lpn >= status.totalLogicalPages) {
+    panic("LPN out of range");
+  }
+
+  if (iter != cmt.end()) {
+    dftlStat.hit++;
+
+    lruList.splice(lruList.begin(), lruList, iter->second);
+  }
+  else {
+    dftlStat.miss++;
+
+    while (cmt.size() >= cacheCapacity) {
+      evictMapping(tick);
+    }
+
+    // Translation page is not written when no LPN in it is written
+    if (isMapped(status.totalLogicalPages + tpn)) {
+      readTranslationPage(tpn, tick);
+    }
+
+    lruList.push_front({lpn, false});
+    cmt.emplace(lpn, lruList.begin());
+
+    pDRAM->write(nullptr, ENTRY_SIZE * bitsetSize, tick);
+  }
+
+  if (dirty && !lruList.front().dirty) {
+    lruList.front().dirty = true;
+    dirtyEntries.at(tpn)++;
+  }
+}
+
+void DFTL::evictMapping(uint64_t &tick) {
+  CacheEntry entry = lruList.back();
+
+  // All dirty entries in same translation page are written back together
+  if (entry.dirty) {
+    dftlStat.dirtyEvictions++;
+
+    flushTranslationPage(entry.lpn / entriesInPage, tick);
+  }
+
+  debugprint(LOG_FTL_DFTL, "EVICT | LPN %" PRIu64 " | %s", entry.lpn,
+             entry.dirty ? "dirty" : "clean");
+
+  cmt.erase(entry.lpn);
+  lruList.pop_back();
+}
+
+void DFTL::readTranslationPage(uint64_t tpn, uint64_t &tick) {
+  Request req(param.ioUnitInPage);
+
+  req.lpn = status.totalLogicalPages + tpn;
+  req.ioFlag.set();
+
+  readInternal(req, tick);
+
+  dftlStat.translationReads++;
+}
+
+void DFTL::writeTranslationPage(uint64_t tpn, uint64_t &tick) {
+  Request req(param.ioUnitInPage);
+
+  req.lpn = status.totalLogicalPages + tpn;
+  req.ioFlag.set();
+
+  writeInternal(req, tick);
+
+  dftlStat.translationWrites++;
+}
+
+// Write back translation pages of unmapped range
+void DFTL::flushTranslationPages(LPNRange &range, uint64_t &tick) {
+  uint64_t lpnEnd = MIN(range.slpn + range.nlp, status.totalLogicalPages);
+
+  if (range.slpn >= lpnEnd) {
+    return;
+  }
+
+  for (uint64_t tpn = range.slpn / entriesInPage;
+       tpn <= (lpnEnd - 1) / entriesInPage; tpn++) {
+    flushTranslationPage(tpn, tick);
+  }
+}
+
+// Update translation page in NAND with current mappings
+void DFTL::flushTranslationPage(uint64_t tpn, uint64_t &tick) {
+  uint64_t lpnBegin = tpn * entriesInPage;
+  uint64_t lpnEnd = MIN(lpnBegin + entriesInPage, status.totalLogicalPages);
+
+  debugprint(LOG_FTL_DFTL, "FLUSH | Translation page %" PRIu64, tpn);
+
+  // Read-modify-write
+  if (dirtyEntries.at(tpn) > 0) {
+    pDRAM->read(nullptr, ENTRY_SIZE * bitsetSize * dirtyEntries.at(tpn),
+                tick);
+  }
+
+  if (isMapped(status.totalLogicalPages + tpn)) {
+    readTranslationPage(tpn, tick);
+  }
+
+  writeTranslationPage(tpn, tick);
+
+  // Now all cached entries of this page are clean
+  if (dirtyEntries.at(tpn) > 0) {
+    if (cmt.size() < lpnEnd - lpnBegin) {
+      for (auto &iter : lruList) {
+        if (iter.lpn >= lpnBegin && iter.lpn < lpnEnd) {
+          iter.dirty = false;
+        }
+      }
+    }
+    else {
+      for (uint64_t lpn = lpnBegin; lpn < lpnEnd; lpn++) {
+        auto iter = cmt.find(lpn);
+
+        if (iter != cmt.end()) {
+          iter->second->dirty = false;
+        }
+      }
+    }
+
+    dirtyEntries.at(tpn) = 0;
+  }
+}
+
+// Valid pages are moved by GC, so their mappings should be updated too.
+// Mappings in CMT are updated in place, others need translation page update.
+void DFTL::doGarbageCollection(std::vector<uint32_t> &blocksToReclaim,
+                               uint64_t &tick, uint32_t pageLimit) {
+  std::vector<uint64_t> lpns;
+  std::vector<uint64_t> pages;
+  std::vector<uint64_t> moved;
+  Bitset bit(param.ioUnitInPage);
+  uint32_t copied = 0;
+
+  // Collect user LPNs which will be moved
+  for (auto &iter : blocksToReclaim) {
+    auto block = blocks.find(iter);
+
+    if (block == blocks.end()) {
+      continue;
+    }
+
+    // Same pages as PageMapping::doGarbageCollection will relocate
+    for (uint32_t pageIndex = 0; pageIndex < param.pagesInBlock; pageIndex++) {
+      if (pageLimit > 0 && copied == pageLimit) {
+        break;
+      }
+
+      if (block->second.getPageInfo(pageIndex, lpns, bit)) {
+        for (uint32_t idx = 0; idx < param.ioUnitInPage; idx++) {
+          if (bit.test(idx) && lpns.at(idx) < status.totalLogicalPages) {
+            moved.push_back(lpns.at(idx));
+          }
+        }
+
+        copied++;
+      }
+    }
+  }
+
+  PageMapping::doGarbageCollection(blocksToReclaim, tick, pageLimit);
+
+  std::sort(moved.begin(), moved.end());
+  moved.erase(std::unique(moved.begin(), moved.end()), moved.end());
+
+  for (auto &lpn : moved) {
+    uint64_t tpn = lpn / entriesInPage;
+    auto iter = cmt.find(lpn);
+
+    if (iter != cmt.end()) {
+      if (!iter->second->dirty) {
+        iter->second->dirty = true;
+        dirtyEntries.at(tpn)++;
+      }
+    }
+    else if (pages.empty() || pages.back() != tpn) {
+      pages.push_back(tpn);
+    }
+  }
+
+  // Incremental GC updates translation pages once, when its victim is drained
+  pendingPages.insert(pendingPages.end(), pages.begin(), pages.end());
+
+  if (gcVictim < param.totalPhysicalBlocks) {
+    return;
+  }
+
+  // Flushing may invoke GC again
+  pages.swap(pendingPages);
+  pendingPages.clear();
+
+  std::sort(pages.begin(), pages.end());
+  pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+
+  for (auto &tpn : pages) {
+    flushTranslationPage(tpn, tick);
+  }
+}
+
+void DFTL::getStatList(std::vector<Stats> &list, std::string prefix) {
+  Stats temp;
+
+  PageMapping::getStatList(list, prefix);
+
+  temp.name = prefix + "dftl.cache.hit";
+  temp.desc = "Total hit count of cached mapping table";
+  list.push_back(temp);
+
+  temp.name = prefix + "dftl.cache.miss";
+  temp.desc = "Total miss count of cached mapping table";
+  list.push_back(temp);
+
+  temp.name = prefix + "dftl.cache.dirty_evictions";
+  temp.desc = "Total dirty entries evicted from cached mapping table";
+  list.push_back(temp);
+
+  temp.name = prefix + "dftl.translation.read";
+  temp.desc = "Total translation page reads";
+  list.push_back(temp);
+
+  temp.name = prefix + "dftl.translation.write";
+  temp.desc = "Total translation page writes";
+  list.push_back(temp);
+}
+
+void DFTL::getStatValues(std::vector<double> &values) {
+  PageMapping::getStatValues(values);
+
+  values.push_back(dftlStat.hit);
+  values.push_back(dftlStat.miss);
+  values.push_back(dftlStat.dirtyEvictions);
+  values.push_back(dftlStat.translationReads);
+  values.push_back(dftlStat.translationWrites);
+}
+
+void DFTL::resetStatValues() {
+  PageMapping::resetStatValues();
+
+  memset(&dftlStat, 0, sizeof(dftlStat));
+}
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __FTL_DFTL__
+#define __FTL_DFTL__
+
+#include <cinttypes>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "ftl/page_mapping.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+// Demand-based page mapping (DFTL)
+// Gupta, Aayush, Youngjae Kim, and Bhuvan Urgaonkar.
+// "DFTL: a flash translation layer employing demand-based selective caching
+// of page-level address mappings." ASPLOS (2009)
+//
+// Whole mapping table is stored in translation pages in NAND, and only
+// recently used entries are kept in cached mapping table (CMT) in DRAM.
+// Translation pages are logical pages placed after user pages, so they are
+// allocated and garbage collected like other pages. Mapping of them acts as
+// global translation directory.
+class DFTL : public PageMapping {
+ private:
+  typedef struct {
+    uint64_t lpn;
+    bool dirty;
+  } CacheEntry;
+
+  uint64_t entriesInPage;  // # of LPNs in one translation page
+  uint64_t nTranslationPages;
+  uint64_t cacheCapacity;  // # of LPNs in CMT
+
+  // CMT in LRU order (front is most recently used)
+  std::list<CacheEntry> lruList;
+  std::unordered_map<uint64_t, std::list<CacheEntry>::iterator> cmt;
+  std::vector<uint32_t> dirtyEntries;  // # of dirty entries in CMT per page
+  std::vector<uint64_t> pendingPages;  // Updated by unfinished incremental GC
+
+  struct {
+    uint64_t hit;
+    uint64_t miss;
+    uint64_t dirtyEvictions;
+    uint64_t translationReads;
+    uint64_t translationWrites;
+  } dftlStat;
+
+  void loadMapping(uint64_t, bool, uint64_t &);
+  void evictMapping(uint64_t &);
+  void readTranslationPage(uint64_t, uint64_t &);
+  void writeTranslationPage(uint64_t, uint64_t &);
+  void flushTranslationPage(uint64_t, uint64_t &);
+  void flushTranslationPages(LPNRange &, uint64_t &);
+
+  void fillMetadata() override;
+
+  void doGarbageCollection(std::vector<uint32_t> &, uint64_t &,
+                           uint32_t = 0) override;
+
+ public:
+  DFTL(ConfigReader &, Parameter &, PAL::PAL *, DRAM::AbstractDRAM *);
+  ~DFTL();
+
+  bool initialize() override;
+
+  void read(Request &, uint64_t &) override;
+  void write(Request &, uint64_t &) override;
+  void trim(Request &, uint64_t &) override;
+  void trim(LPNRange &, uint64_t &) override;
+
+  void format(LPNRange &, uint64_t &) override;
+
+  void getStatList(std::vector<Stats> &, std::string) override;
+  void getStatValues(std::vector<double> &) override;
+  void resetStatValues() override;
+};
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
+
+#endif
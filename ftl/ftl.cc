@@ -19,6 +19,8 @@
 
 #include "ftl/ftl.hh"
 
+#include "ftl/dftl.hh"
+#include "ftl/nk_mapping.hh"
 #include "ftl/page_mapping.hh"
 
 namespace SimpleSSD {
@@ -44,6 +46,14 @@ FTL::FTL(ConfigReader &c, DRAM::AbstractDRAM *d) : conf(c), pDRAM(d) {
     case PAGE_MAPPING:
       pFTL = new PageMapping(conf, param, pPAL, pDRAM);
       break;
+    case DEMAND_PAGE_MAPPING:
+      pFTL = new DFTL(conf, param, pPAL, pDRAM);
+      break;
+    case NK_MAPPING:
+      pFTL = new NKMapping(conf, param, pPAL, pDRAM);
+      break;
+    default:
+      panic("Invalid mapping mode");
   }
 
   if (param.totalPhysicalBlocks <=
@@ -89,6 +99,15 @@ void FTL::trim(Request &req, uint64_t &tick) {
   tick += applyLatency(CPU::FTL, CPU::TRIM);
 }
 
+void FTL::trim(LPNRange &range, uint64_t &tick) {
+  debugprint(LOG_FTL, "TRIM  | LPN %" PRIu64 " + %" PRIu64, range.slpn,
+             range.nlp);
+
+  pFTL->trim(range, tick);
+
+  tick += applyLatency(CPU::FTL, CPU::TRIM);
+}
+
 void FTL::format(LPNRange &range, uint64_t &tick) {
   pFTL->format(range, tick);
 
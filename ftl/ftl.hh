@@ -55,6 +55,7 @@ class FTL : public StatObject {
   void read(Request &, uint64_t &);
   void write(Request &, uint64_t &);
   void trim(Request &, uint64_t &);
+  void trim(LPNRange &, uint64_t &);
 
   void format(LPNRange &, uint64_t &);
 
@@ -0,0 +1,897 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ftl/nk_mapping.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+#include "util/algorithm.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+NKMapping::NKMapping(ConfigReader &c, Parameter &p, PAL::PAL *l,
+                     DRAM::AbstractDRAM *d)
+    : AbstractFTL(p, l, d),
+      conf(c),
+      nDataBlocks(conf.readUint(CONFIG_FTL, FTL_NKMAP_N)),
+      nLogBlocks(conf.readUint(CONFIG_FTL, FTL_NKMAP_K)),
+      nReserved(0),
+      blockArena(param.totalPhysicalBlocks, param.pagesInBlock,
+                 param.ioUnitInPage),
+      freeBlocks(param.pageCountToMaxPerf),
+      lastFreeBlockIndex(0),
+      dataBlocks(param.totalLogicalBlocks, param.totalPhysicalBlocks),
+      groups(DIVCEIL(param.totalLogicalBlocks, nDataBlocks)),
+      nMappedLPNs(0) {
+  status.totalLogicalPages =
+      (uint64_t)param.totalLogicalBlocks * param.pagesInBlock;
+
+  // At least one free block is needed to merge
+  nReserved = MAX(
+      (uint32_t)(param.totalPhysicalBlocks *
+                 conf.readFloat(CONFIG_FTL, FTL_GC_THRESHOLD_RATIO)),
+      1);
+
+  blocks.reserve(param.totalPhysicalBlocks);
+  mappedLPNs.resize(DIVCEIL(status.totalLogicalPages, 64), 0);
+
+  for (uint32_t i = 0; i < param.totalPhysicalBlocks; i++) {
+    freeBlocks.insert(convertBlockIdx(i), Block(blockArena, i));
+  }
+
+  memset(&stat, 0, sizeof(stat));
+}
+
+NKMapping::~NKMapping() {}
+
+bool NKMapping::initialize() {
+  uint64_t nPagesToWarmup;
+  uint64_t nPagesToInvalidate;
+  uint64_t tick = 0;
+  FILLING_MODE mode;
+  Request req(param.ioUnitInPage);
+
+  debugprint(LOG_FTL_NK_MAPPING, "Initialization started");
+
+  if (conf.readString(CONFIG_FTL, FTL_SNAPSHOT_LOAD_PATH).length() > 0 ||
+      conf.readString(CONFIG_FTL, FTL_SNAPSHOT_SAVE_PATH).length() > 0) {
+    warn("ftl: N+K mapping does not support snapshot. Filling drive instead.");
+  }
+
+  nPagesToWarmup =
+      status.totalLogicalPages * conf.readFloat(CONFIG_FTL, FTL_FILL_RATIO);
+  nPagesToInvalidate = status.totalLogicalPages *
+                       conf.readFloat(CONFIG_FTL, FTL_INVALID_PAGE_RATIO);
+  mode = (FILLING_MODE)conf.readUint(CONFIG_FTL, FTL_FILLING_MODE);
+
+  debugprint(LOG_FTL_NK_MAPPING,
+             "%u logical blocks per group, up to %u log blocks per group",
+             nDataBlocks, nLogBlocks);
+  debugprint(LOG_FTL_NK_MAPPING,
+             "Total logical pages to fill: %" PRIu64 " (%.2f %%)",
+             nPagesToWarmup,
+             nPagesToWarmup * 100.f / status.totalLogicalPages);
+  debugprint(LOG_FTL_NK_MAPPING,
+             "Total invalidated pages to create: %" PRIu64 " (%.2f %%)",
+             nPagesToInvalidate,
+             nPagesToInvalidate * 100.f / status.totalLogicalPages);
+
+  std::random_device rd;
+  std::mt19937_64 gen(rd());
+
+  req.ioFlag.set();
+
+  // Step 1. Filling
+  // Pages are written in LPN order, so all of them go to data blocks
+  if (mode == FILLING_MODE_0 || mode == FILLING_MODE_1) {
+    for (req.lpn = 0; req.lpn < nPagesToWarmup; req.lpn++) {
+      writeInternal(req, tick, false);
+    }
+  }
+  else {
+    std::uniform_int_distribution<uint64_t> dist(0,
+                                                 status.totalLogicalPages - 1);
+    std::vector<bool> selected(status.totalLogicalPages, false);
+    uint64_t count = 0;
+
+    nPagesToWarmup = MIN(nPagesToWarmup, status.totalLogicalPages);
+
+    while (count < nPagesToWarmup) {
+      uint64_t lpn = dist(gen);
+
+      if (!selected.at(lpn)) {
+        selected.at(lpn) = true;
+        count++;
+      }
+    }
+
+    for (req.lpn = 0; req.lpn < status.totalLogicalPages; req.lpn++) {
+      if (selected.at(req.lpn)) {
+        writeInternal(req, tick, false);
+      }
+    }
+  }
+
+  // Step 2. Invalidating
+  // Overwrites go to log blocks, and may be merged
+  if (mode == FILLING_MODE_0) {
+    for (req.lpn = 0; req.lpn < nPagesToInvalidate; req.lpn++) {
+      writeInternal(req, tick, false);
+    }
+  }
+  else if (nPagesToInvalidate > 0) {
+    uint64_t range =
+        mode == FILLING_MODE_1 ? nPagesToWarmup : status.totalLogicalPages;
+
+    if (range > 0) {
+      std::uniform_int_distribution<uint64_t> dist(0, range - 1);
+
+      for (uint64_t i = 0; i < nPagesToInvalidate; i++) {
+        req.lpn = dist(gen);
+
+        writeInternal(req, tick, false);
+      }
+    }
+  }
+
+  debugprint(LOG_FTL_NK_MAPPING,
+             "Filling finished. %" PRIu64 " switch merges, %" PRIu64
+             " full merges",
+             stat.switchMerges, stat.fullMerges);
+  debugprint(LOG_FTL_NK_MAPPING, "Initialization finished");
+
+  // Merges during initialization are not counted
+  memset(&stat, 0, sizeof(stat));
+
+  return true;
+}
+
+void NKMapping::read(Request &req, uint64_t &tick) {
+  uint64_t begin = tick;
+
+  if (req.ioFlag.count() > 0) {
+    readInternal(req, tick);
+
+    debugprint(LOG_FTL_NK_MAPPING,
+               "READ  | LPN %" PRIu64 " | %" PRIu64 " - %" PRIu64 " (%" PRIu64
+               ")",
+               req.lpn, begin, tick, tick - begin);
+  }
+  else {
+    warn("FTL got empty request");
+  }
+
+  tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::READ);
+}
+
+void NKMapping::write(Request &req, uint64_t &tick) {
+  uint64_t begin = tick;
+
+  if (req.ioFlag.count() > 0) {
+    writeInternal(req, tick);
+
+    debugprint(LOG_FTL_NK_MAPPING,
+               "WRITE | LPN %" PRIu64 " | %" PRIu64 " - %" PRIu64 " (%" PRIu64
+               ")",
+               req.lpn, begin, tick, tick - begin);
+  }
+  else {
+    warn("FTL got empty request");
+  }
+
+  tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::WRITE);
+}
+
+void NKMapping::trim(Request &req, uint64_t &tick) {
+  uint64_t begin = tick;
+
+  trimInternal(req, tick);
+
+  debugprint(LOG_FTL_NK_MAPPING,
+             "TRIM  | LPN %" PRIu64 " | %" PRIu64 " - %" PRIu64 " (%" PRIu64
+             ")",
+             req.lpn, begin, tick, tick - begin);
+
+  tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::TRIM);
+}
+
+void NKMapping::trim(LPNRange &range, uint64_t &tick) {
+  uint64_t lpnEnd = MIN(range.slpn + range.nlp, status.totalLogicalPages);
+  uint64_t begin = tick;
+
+  if (range.slpn < lpnEnd) {
+    uint64_t lbnBegin = range.slpn / param.pagesInBlock;
+    uint64_t lbnEnd = (lpnEnd - 1) / param.pagesInBlock + 1;
+
+    pDRAM->read(&dataBlocks.at(lbnBegin), 8 * (lbnEnd - lbnBegin), tick);
+
+    unmapRange(range.slpn, lpnEnd);
+
+    tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::TRIM_INTERNAL);
+  }
+
+  debugprint(LOG_FTL_NK_MAPPING,
+             "TRIM  | LPN %" PRIu64 " + %" PRIu64 " | %" PRIu64 " - %" PRIu64
+             " (%" PRIu64 ")",
+             range.slpn, range.nlp, begin, tick, tick - begin);
+
+  tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::TRIM);
+}
+
+void NKMapping::format(LPNRange &range, uint64_t &tick) {
+  uint64_t lpnEnd = MIN(range.slpn + range.nlp, status.totalLogicalPages);
+  uint64_t finishedAt = tick;
+  uint64_t beginAt;
+
+  if (range.slpn >= lpnEnd) {
+    return;
+  }
+
+  unmapRange(range.slpn, lpnEnd);
+
+  // Erase blocks left without valid pages
+  uint64_t lbnBegin = range.slpn / param.pagesInBlock;
+  uint64_t lbnEnd = (lpnEnd - 1) / param.pagesInBlock + 1;
+
+  for (uint64_t lbn = lbnBegin; lbn < lbnEnd; lbn++) {
+    uint32_t &dataBlock = dataBlocks.at(lbn);
+
+    if (dataBlock >= param.totalPhysicalBlocks) {
+      continue;
+    }
+
+    auto block = blocks.find(dataBlock);
+
+    if (block == blocks.end()) {
+      panic("No such block");
+    }
+
+    if (block->second.getValidPageCount() == 0) {
+      beginAt = tick;
+
+      eraseInternal(dataBlock, beginAt);
+
+      finishedAt = MAX(finishedAt, beginAt);
+      dataBlock = param.totalPhysicalBlocks;
+    }
+  }
+
+  for (uint64_t group = lbnBegin / nDataBlocks;
+       group <= (lbnEnd - 1) / nDataBlocks; group++) {
+    auto &logBlocks = groups.at(group).logBlocks;
+
+    for (auto iter = logBlocks.begin(); iter != logBlocks.end();) {
+      auto block = blocks.find(*iter);
+
+      if (block == blocks.end()) {
+        panic("No such block");
+      }
+
+      if (block->second.getValidPageCount() == 0) {
+        beginAt = tick;
+
+        eraseInternal(*iter, beginAt);
+
+        finishedAt = MAX(finishedAt, beginAt);
+        iter = logBlocks.erase(iter);
+      }
+      else {
+        iter++;
+      }
+    }
+  }
+
+  tick = finishedAt;
+  tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::FORMAT);
+}
+
+Status *NKMapping::getStatus(uint64_t lpnBegin, uint64_t lpnEnd) {
+  status.freePhysicalBlocks = freeBlocks.getBlockCount();
+
+  if (lpnBegin == 0 && lpnEnd >= status.totalLogicalPages) {
+    status.mappedLogicalPages = nMappedLPNs;
+  }
+  else {
+    status.mappedLogicalPages = countMappedLPNs(lpnBegin, lpnEnd);
+  }
+
+  return &status;
+}
+
+uint32_t NKMapping::convertBlockIdx(uint32_t blockIndex) {
+  return blockIndex % param.pageCountToMaxPerf;
+}
+
+// Get least erased free block in given parallel unit
+uint32_t NKMapping::getFreeBlock(uint32_t idx) {
+  return freeBlocks.take(idx, false, blocks);
+}
+
+// Latest copy of LPN is in log block if any, or in data block
+bool NKMapping::getMapping(uint64_t lpn,
+                           std::pair<uint32_t, uint32_t> &mapping) {
+  uint64_t lbn = lpn / param.pagesInBlock;
+
+  if (!isMapped(lpn)) {
+    return false;
+  }
+
+  auto &logMap = groups.at(lbn / nDataBlocks).logMap;
+  auto iter = logMap.find(lpn);
+
+  if (iter != logMap.end()) {
+    mapping = iter->second;
+  }
+  else {
+    mapping = {dataBlocks.at(lbn), lpn % param.pagesInBlock};
+  }
+
+  return mapping.first < param.totalPhysicalBlocks;
+}
+
+bool NKMapping::isMapped(uint64_t lpn) {
+  return mappedLPNs[lpn / 64] & ((uint64_t)1 << (lpn % 64));
+}
+
+void NKMapping::setMapped(uint64_t lpn, bool mapped) {
+  uint64_t &word = mappedLPNs[lpn / 64];
+  uint64_t mask = (uint64_t)1 << (lpn % 64);
+
+  if (mapped && !(word & mask)) {
+    word |= mask;
+    nMappedLPNs++;
+  }
+  else if (!mapped && (word & mask)) {
+    word &= ~mask;
+    nMappedLPNs--;
+  }
+}
+
+uint64_t NKMapping::countMappedLPNs(uint64_t lpnBegin, uint64_t lpnEnd) {
+  uint64_t count = 0;
+
+  lpnEnd = MIN(lpnEnd, status.totalLogicalPages);
+
+  if (lpnBegin >= lpnEnd) {
+    return 0;
+  }
+
+  uint64_t first = lpnBegin / 64;
+  uint64_t last = (lpnEnd - 1) / 64;
+  uint64_t headMask = ~(uint64_t)0 << (lpnBegin % 64);
+  uint64_t tailMask = ~(uint64_t)0 >> (63 - (lpnEnd - 1) % 64);
+
+  if (first == last) {
+    return popcount(mappedLPNs[first] & headMask & tailMask);
+  }
+
+  count += popcount(mappedLPNs[first] & headMask);
+
+  for (uint64_t i = first + 1; i < last; i++) {
+    count += popcount(mappedLPNs[i]);
+  }
+
+  count += popcount(mappedLPNs[last] & tailMask);
+
+  return count;
+}
+
+// Invalidate latest copy of LPN, but keep it mapped
+void NKMapping::invalidate(uint64_t lpn) {
+  std::pair<uint32_t, uint32_t> mapping;
+
+  if (getMapping(lpn, mapping)) {
+    auto block = blocks.find(mapping.first);
+
+    if (block == blocks.end()) {
+      panic("Block is not in use");
+    }
+
+    for (uint32_t idx = 0; idx < param.ioUnitInPage; idx++) {
+      block->second.invalidate(mapping.second, idx);
+    }
+
+    groups.at(lpn / param.pagesInBlock / nDataBlocks).logMap.erase(lpn);
+  }
+}
+
+// Invalidate and unmap all mapped LPNs in range
+void NKMapping::unmapRange(uint64_t lpnBegin, uint64_t lpnEnd) {
+  for (uint64_t lpn = lpnBegin; lpn < lpnEnd; lpn++) {
+    // Skip whole word when no LPN in it is mapped
+    if (mappedLPNs[lpn / 64] == 0) {
+      lpn = lpn / 64 * 64 + 63;
+
+      continue;
+    }
+
+    if (isMapped(lpn)) {
+      invalidate(lpn);
+      setMapped(lpn, false);
+    }
+  }
+}
+
+// Select group which has the most log blocks, or groups.size() if no group
+// has log block
+uint32_t NKMapping::selectVictimGroup(uint64_t &tick) {
+  uint32_t victim = groups.size();
+  uint64_t count = 0;
+
+  for (uint32_t i = 0; i < groups.size(); i++) {
+    if (groups.at(i).logBlocks.size() > count) {
+      victim = i;
+      count = groups.at(i).logBlocks.size();
+    }
+  }
+
+  tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::SELECT_VICTIM_BLOCK);
+
+  return victim;
+}
+
+// Log block which holds whole logical block in order just becomes data block
+bool NKMapping::switchMerge(Group &group, uint32_t logBlock, uint64_t &tick,
+                            bool sendToPAL) {
+  auto block = blocks.find(logBlock);
+  std::vector<uint64_t> lpns;
+  Bitset bit(param.ioUnitInPage);
+  uint64_t lbn = 0;
+
+  for (uint32_t pageIndex = 0; pageIndex < param.pagesInBlock; pageIndex++) {
+    if (!block->second.getPageInfo(pageIndex, lpns, bit) || !bit.all()) {
+      return false;
+    }
+
+    if (pageIndex == 0) {
+      if (lpns.at(0) % param.pagesInBlock != 0) {
+        return false;
+      }
+
+      lbn = lpns.at(0) / param.pagesInBlock;
+    }
+    else if (lpns.at(0) != lbn * param.pagesInBlock + pageIndex) {
+      return false;
+    }
+  }
+
+  uint32_t dataBlock = dataBlocks.at(lbn);
+
+  for (uint32_t pageIndex = 0; pageIndex < param.pagesInBlock; pageIndex++) {
+    group.logMap.erase(lbn * param.pagesInBlock + pageIndex);
+  }
+
+  dataBlocks.at(lbn) = logBlock;
+
+  // All pages of old data block are overwritten
+  if (dataBlock < param.totalPhysicalBlocks) {
+    eraseInternal(dataBlock, tick, sendToPAL);
+  }
+
+  stat.switchMerges++;
+
+  return true;
+}
+
+// Copy latest pages of logical block to new data block
+void NKMapping::fullMerge(uint64_t lbn, uint64_t &tick, bool sendToPAL) {
+  auto &group = groups.at(lbn / nDataBlocks);
+  PAL::Request req(param.ioUnitInPage);
+  std::vector<uint64_t> lpns;
+  Bitset bit(param.ioUnitInPage);
+  uint32_t dataBlock = dataBlocks.at(lbn);
+  uint32_t newBlock = param.totalPhysicalBlocks;
+  uint64_t beginAt;
+  uint64_t readFinishedAt = tick;
+  uint64_t finishedAt = tick;
+
+  req.ioFlag.set();
+  req.gc = true;
+
+  for (uint32_t offset = 0; offset < param.pagesInBlock; offset++) {
+    uint64_t lpn = lbn * param.pagesInBlock + offset;
+    std::pair<uint32_t, uint32_t> source;
+    auto log = group.logMap.find(lpn);
+
+    if (log != group.logMap.end()) {
+      source = log->second;
+      group.logMap.erase(log);
+    }
+    else if (dataBlock < param.totalPhysicalBlocks) {
+      auto block = blocks.find(dataBlock);
+
+      if (block == blocks.end()) {
+        panic("No such block");
+      }
+
+      if (!block->second.getPageInfo(offset, lpns, bit)) {
+        continue;
+      }
+
+      source = {dataBlock, offset};
+    }
+    else {
+      continue;
+    }
+
+    auto block = blocks.find(source.first);
+
+    if (block == blocks.end()) {
+      panic("No such block");
+    }
+
+    for (uint32_t idx = 0; idx < param.ioUnitInPage; idx++) {
+      block->second.invalidate(source.second, idx);
+    }
+
+    if (newBlock == param.totalPhysicalBlocks) {
+      newBlock = getFreeBlock(convertBlockIdx(lbn));
+    }
+
+    block = blocks.find(newBlock);
+
+    for (uint32_t idx = 0; idx < param.ioUnitInPage; idx++) {
+      block->second.write(offset, lpn, idx, tick);
+    }
+
+    // Program of each page starts when its read finishes
+    if (sendToPAL) {
+      beginAt = tick;
+
+      req.blockIndex = source.first;
+      req.pageIndex = source.second;
+
+      pPAL->read(req, beginAt);
+
+      readFinishedAt = MAX(readFinishedAt, beginAt);
+
+      req.blockIndex = newBlock;
+      req.pageIndex = offset;
+
+      pPAL->write(req, beginAt);
+
+      finishedAt = MAX(finishedAt, beginAt);
+    }
+
+    stat.mergeCopies++;
+  }
+
+  dataBlocks.at(lbn) = newBlock;
+
+  if (dataBlock < param.totalPhysicalBlocks) {
+    beginAt = readFinishedAt;
+
+    eraseInternal(dataBlock, beginAt, sendToPAL);
+
+    finishedAt = MAX(finishedAt, beginAt);
+  }
+
+  stat.fullMerges++;
+
+  tick = finishedAt;
+}
+
+// Merge all log blocks of group
+// Log blocks are erased after merge finishes, so that data are never lost
+void NKMapping::merge(uint32_t groupIndex, uint64_t &tick, bool sendToPAL) {
+  auto &group = groups.at(groupIndex);
+  std::vector<uint64_t> lbns;
+  uint64_t begin = tick;
+  uint64_t finishedAt = tick;
+  uint64_t beginAt;
+
+  for (auto iter = group.logBlocks.begin(); iter != group.logBlocks.end();) {
+    beginAt = tick;
+
+    if (switchMerge(group, *iter, beginAt, sendToPAL)) {
+      finishedAt = MAX(finishedAt, beginAt);
+      iter = group.logBlocks.erase(iter);
+    }
+    else {
+      iter++;
+    }
+  }
+
+  for (auto &iter : group.logMap) {
+    lbns.push_back(iter.first / param.pagesInBlock);
+  }
+
+  std::sort(lbns.begin(), lbns.end());
+  lbns.erase(std::unique(lbns.begin(), lbns.end()), lbns.end());
+
+  for (auto &lbn : lbns) {
+    beginAt = tick;
+
+    fullMerge(lbn, beginAt, sendToPAL);
+
+    finishedAt = MAX(finishedAt, beginAt);
+  }
+
+  tick = finishedAt;
+
+  for (auto &iter : group.logBlocks) {
+    beginAt = tick;
+
+    eraseInternal(iter, beginAt, sendToPAL);
+
+    finishedAt = MAX(finishedAt, beginAt);
+  }
+
+  group.logBlocks.clear();
+
+  debugprint(LOG_FTL_NK_MAPPING,
+             "MERGE | Group %u | %zu logical blocks | %" PRIu64 " - %" PRIu64
+             " (%" PRIu64 ")",
+             groupIndex, lbns.size(), begin, finishedAt, finishedAt - begin);
+
+  tick = finishedAt;
+
+  if (sendToPAL) {
+    tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::DO_GARBAGE_COLLECTION);
+  }
+}
+
+void NKMapping::readInternal(Request &req, uint64_t &tick) {
+  PAL::Request palRequest(req);
+  std::pair<uint32_t, uint32_t> mapping;
+
+  pDRAM->read(&dataBlocks.at(req.lpn / param.pagesInBlock), 8, tick);
+
+  if (getMapping(req.lpn, mapping)) {
+    auto block = blocks.find(mapping.first);
+
+    if (block == blocks.end()) {
+      panic("Block is not in use");
+    }
+
+    for (uint32_t idx = 0; idx < param.ioUnitInPage; idx++) {
+      if (req.ioFlag.test(idx)) {
+        block->second.read(mapping.second, idx, tick);
+      }
+    }
+
+    palRequest.blockIndex = mapping.first;
+    palRequest.pageIndex = mapping.second;
+
+    pPAL->read(palRequest, tick);
+
+    tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::READ_INTERNAL);
+  }
+}
+
+void NKMapping::writeInternal(Request &req, uint64_t &tick, bool sendToPAL) {
+  PAL::Request palRequest(req);
+  std::pair<uint32_t, uint32_t> mapping;
+  uint64_t lbn = req.lpn / param.pagesInBlock;
+  uint32_t offset = req.lpn % param.pagesInBlock;
+  uint32_t groupIndex = lbn / nDataBlocks;
+  auto &group = groups.at(groupIndex);
+  uint32_t &dataBlock = dataBlocks.at(lbn);
+  bool inLog = false;
+
+  if (sendToPAL) {
+    pDRAM->read(&dataBlock, 8, tick);
+  }
+
+  if (getMapping(req.lpn, mapping)) {
+    // We have to read old data
+    if (sendToPAL && !req.ioFlag.all()) {
+      palRequest.blockIndex = mapping.first;
+      palRequest.pageIndex = mapping.second;
+      palRequest.ioFlag = req.ioFlag;
+      palRequest.ioFlag.flip();
+
+      pPAL->read(palRequest, tick);
+    }
+
+    invalidate(req.lpn);
+  }
+  else {
+    setMapped(req.lpn, true);
+  }
+
+  // Find page to write
+  while (true) {
+    uint32_t victim = groupIndex;
+
+    if (dataBlock == param.totalPhysicalBlocks) {
+      // Reclaim log blocks first when running out of free blocks
+      if (freeBlocks.getBlockCount() <= nReserved) {
+        victim = selectVictimGroup(tick);
+
+        if (victim < groups.size()) {
+          merge(victim, tick, sendToPAL);
+
+          continue;
+        }
+      }
+
+      dataBlock = getFreeBlock(convertBlockIdx(lbn));
+    }
+
+    // Write in place when page is not programmed yet
+    auto block = blocks.find(dataBlock);
+
+    if (offset >= block->second.getNextWritePageIndex()) {
+      mapping = {dataBlock, offset};
+
+      break;
+    }
+
+    // Append to open log block
+    if (group.logBlocks.size() > 0) {
+      block = blocks.find(group.logBlocks.back());
+
+      if (block->second.getNextWritePageIndex() < param.pagesInBlock) {
+        mapping = {block->first, block->second.getNextWritePageIndex()};
+        inLog = true;
+
+        break;
+      }
+    }
+
+    // Open new log block, or merge
+    if (group.logBlocks.size() < nLogBlocks) {
+      victim = freeBlocks.getBlockCount() > nReserved
+                   ? (uint32_t)groups.size()
+                   : selectVictimGroup(tick);
+
+      // Borrow free block when no group has log block to merge
+      if (victim == groups.size()) {
+        group.logBlocks.push_back(getFreeBlock(lastFreeBlockIndex));
+        lastFreeBlockIndex =
+            (lastFreeBlockIndex + 1) % param.pageCountToMaxPerf;
+
+        continue;
+      }
+    }
+
+    merge(victim, tick, sendToPAL);
+  }
+
+  auto block = blocks.find(mapping.first);
+
+  for (uint32_t idx = 0; idx < param.ioUnitInPage; idx++) {
+    block->second.write(mapping.second, req.lpn, idx, tick);
+  }
+
+  if (inLog) {
+    group.logMap[req.lpn] = mapping;
+
+    stat.logWrites++;
+  }
+
+  // Exclude CPU operation when initializing
+  if (sendToPAL) {
+    pDRAM->write(&dataBlock, 8, tick);
+
+    palRequest.blockIndex = mapping.first;
+    palRequest.pageIndex = mapping.second;
+    palRequest.ioFlag.set();
+
+    pPAL->write(palRequest, tick);
+
+    tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::WRITE_INTERNAL);
+  }
+}
+
+void NKMapping::trimInternal(Request &req, uint64_t &tick) {
+  pDRAM->read(&dataBlocks.at(req.lpn / param.pagesInBlock), 8, tick);
+
+  if (isMapped(req.lpn)) {
+    invalidate(req.lpn);
+    setMapped(req.lpn, false);
+  }
+
+  tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::TRIM_INTERNAL);
+}
+
+void NKMapping::eraseInternal(uint32_t blockIndex, uint64_t &tick,
+                              bool sendToPAL) {
+  static uint64_t threshold =
+      conf.readUint(CONFIG_FTL, FTL_BAD_BLOCK_THRESHOLD);
+  auto block = blocks.find(blockIndex);
+
+  // Sanity checks
+  if (block == blocks.end()) {
+    panic("No such block");
+  }
+
+  if (block->second.getValidPageCount() != 0) {
+    panic("There are valid pages in victim block");
+  }
+
+  block->second.erase();
+
+  if (sendToPAL) {
+    PAL::Request req(param.ioUnitInPage);
+
+    req.blockIndex = blockIndex;
+    req.pageIndex = 0;
+    req.ioFlag.set();
+    req.gc = true;  // Blocks are erased only when merged or formatted
+
+    pPAL->erase(req, tick);
+  }
+
+  // Check erase count
+  uint32_t erasedCount = block->second.getEraseCount();
+
+  if (erasedCount < threshold) {
+    // Insert block to free block list
+    freeBlocks.insert(convertBlockIdx(blockIndex), std::move(block->second));
+  }
+
+  // Remove block from block list
+  blocks.erase(block);
+
+  if (sendToPAL) {
+    tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::ERASE_INTERNAL);
+  }
+}
+
+void NKMapping::getStatList(std::vector<Stats> &list, std::string prefix) {
+  Stats temp;
+
+  temp.name = prefix + "nk_mapping.merge.switch";
+  temp.desc = "Total switch merge count";
+  list.push_back(temp);
+
+  temp.name = prefix + "nk_mapping.merge.full";
+  temp.desc = "Total logical blocks merged by full merge";
+  list.push_back(temp);
+
+  temp.name = prefix + "nk_mapping.merge.page_copies";
+  temp.desc = "Total copied superpages during full merge";
+  list.push_back(temp);
+
+  temp.name = prefix + "nk_mapping.log.page_writes";
+  temp.desc = "Total superpages written to log blocks";
+  list.push_back(temp);
+
+  temp.name = prefix + "nk_mapping.mapping_table_size";
+  temp.desc = "Size of block and log mapping table in bytes";
+  list.push_back(temp);
+}
+
+void NKMapping::getStatValues(std::vector<double> &values) {
+  // 4 bytes per data block, 8 bytes per page of log blocks
+  uint64_t tableSize =
+      (uint64_t)param.totalLogicalBlocks * 4 +
+      (uint64_t)groups.size() * nLogBlocks * param.pagesInBlock * 8;
+
+  values.push_back(stat.switchMerges);
+  values.push_back(stat.fullMerges);
+  values.push_back(stat.mergeCopies);
+  values.push_back(stat.logWrites);
+  values.push_back(tableSize);
+}
+
+void NKMapping::resetStatValues() {
+  memset(&stat, 0, sizeof(stat));
+}
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
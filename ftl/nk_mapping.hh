@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __FTL_NK_MAPPING__
+#define __FTL_NK_MAPPING__
+
+#include <cinttypes>
+#include <unordered_map>
+#include <vector>
+
+#include "ftl/abstract_ftl.hh"
+#include "ftl/common/block.hh"
+#include "ftl/common/free_block_pool.hh"
+#include "ftl/ftl.hh"
+#include "pal/pal.hh"
+
+namespace SimpleSSD {
+
+namespace FTL {
+
+// N+K hybrid mapping
+// Park, Chanik, et al.
+// "A reconfigurable FTL (flash translation layer) architecture for NAND
+// flash-based applications." ACM TECS (2008)
+//
+// Logical blocks are grouped by N. Each logical block is mapped to a data
+// block in block level, and page offset in block never changes. Overwrites
+// and out-of-order writes go to log blocks of the group, which are mapped in
+// page level. When the group needs more than K log blocks, or device runs
+// out of free blocks, log blocks of the group are merged into data blocks.
+// Superpage is the unit of mapping, so partial writes read old data first.
+class NKMapping : public AbstractFTL {
+ private:
+  ConfigReader &conf;
+
+  uint32_t nDataBlocks;  // N, logical blocks in one group
+  uint32_t nLogBlocks;   // K, maximum log blocks of one group
+  uint32_t nReserved;    // Free blocks to keep before borrowing log block
+
+  BlockArena blockArena;
+  std::unordered_map<uint32_t, Block> blocks;
+  FreeBlockPool freeBlocks;
+  uint32_t lastFreeBlockIndex;  // Unit of next log block
+
+  // Block level mapping (totalPhysicalBlocks if not mapped)
+  std::vector<uint32_t> dataBlocks;
+
+  typedef struct {
+    std::vector<uint32_t> logBlocks;  // Last one is open
+    std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> logMap;
+  } Group;
+
+  std::vector<Group> groups;
+
+  std::vector<uint64_t> mappedLPNs;  // One bit per LPN
+  uint64_t nMappedLPNs;
+
+  struct {
+    uint64_t switchMerges;
+    uint64_t fullMerges;
+    uint64_t mergeCopies;  // Superpages copied by full merge
+    uint64_t logWrites;    // Superpages written to log blocks
+  } stat;
+
+  uint32_t convertBlockIdx(uint32_t);
+  uint32_t getFreeBlock(uint32_t);
+  bool getMapping(uint64_t, std::pair<uint32_t, uint32_t> &);
+  bool isMapped(uint64_t);
+  void setMapped(uint64_t, bool);
+  uint64_t countMappedLPNs(uint64_t, uint64_t);
+  void invalidate(uint64_t);
+  void unmapRange(uint64_t, uint64_t);
+
+  uint32_t selectVictimGroup(uint64_t &);
+  bool switchMerge(Group &, uint32_t, uint64_t &, bool);
+  void fullMerge(uint64_t, uint64_t &, bool);
+  void merge(uint32_t, uint64_t &, bool);
+
+  void readInternal(Request &, uint64_t &);
+  void writeInternal(Request &, uint64_t &, bool = true);
+  void trimInternal(Request &, uint64_t &);
+  void eraseInternal(uint32_t, uint64_t &, bool = true);
+
+ public:
+  NKMapping(ConfigReader &, Parameter &, PAL::PAL *, DRAM::AbstractDRAM *);
+  ~NKMapping();
+
+  bool initialize() override;
+
+  void read(Request &, uint64_t &) override;
+  void write(Request &, uint64_t &) override;
+  void trim(Request &, uint64_t &) override;
+  void trim(LPNRange &, uint64_t &) override;
+
+  void format(LPNRange &, uint64_t &) override;
+
+  Status *getStatus(uint64_t, uint64_t) override;
+
+  void getStatList(std::vector<Stats> &, std::string) override;
+  void getStatValues(std::vector<double> &) override;
+  void resetStatValues() override;
+};
+
+}  // namespace FTL
+
+}  // namespace SimpleSSD
+
+#endif
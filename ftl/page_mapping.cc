@@ -20,70 +20,300 @@
 #include "ftl/page_mapping.hh"
 
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <limits>
 #include <random>
 #include <tuple>
 
 #include "util/algorithm.hh"
 #include "util/bitset.hh"
-#include "util/statistics.hh"
-#include "util/flatten.hh"
 
 namespace SimpleSSD {
 
 namespace FTL {
 
+// Snapshot file layout
+// Header is followed by sections, and each section starts at SNAPSHOT_ALIGN
+// aligned offset, so L2P table and bitmaps can be mapped in place.
+// Increase SNAPSHOT_VERSION when the layout of any section changes.
+const char SNAPSHOT_MAGIC[8] = {'S', 'S', 'D', 'F', 'T', 'L', 'S', 'S'};
+const uint32_t SNAPSHOT_VERSION = 9;
+const uint64_t SNAPSHOT_ALIGN = 4096;
+
+// Bin width of read latency distribution in ns
+const uint64_t READ_LATENCY_BIN = 100;
+
+typedef enum {
+  SNAPSHOT_TABLE,        // L2P table
+  SNAPSHOT_MAPPED_LPNS,  // Bitmap of mapped LPNs
+  SNAPSHOT_WRITE_COUNT,  // Write count of all physical pages
+  SNAPSHOT_BLOCKS,       // Block states
+  SNAPSHOT_STATE,        // Free block pools, write frontier and stats
+  SNAPSHOT_SECTION_COUNT,
+} SNAPSHOT_SECTION;
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t bitsetSize;
+  uint64_t totalPhysicalBlocks;
+  uint64_t totalLogicalBlocks;
+  uint64_t pagesInBlock;
+  uint64_t ioUnitInPage;
+  uint64_t pageCountToMaxPerf;
+  uint64_t offset[SNAPSHOT_SECTION_COUNT];
+  uint64_t length[SNAPSHOT_SECTION_COUNT];
+} SnapshotHeader;
+
+typedef enum {
+  BLOCK_RETIRED,  // Erase count exceeded threshold
+  BLOCK_IN_USE,
+  BLOCK_FREE,
+} SNAPSHOT_BLOCK_STATE;
+
+static void writeData(FILE *file, const void *data, uint64_t size) {
+  if (size > 0 && fwrite(data, size, 1, file) != 1) {
+    panic("ftl: Failed to write snapshot");
+  }
+}
+
+static void readData(FILE *file, void *data, uint64_t size) {
+  if (size > 0 && fread(data, size, 1, file) != 1) {
+    panic("ftl: Failed to read snapshot");
+  }
+}
+
+static void beginSection(FILE *file, SnapshotHeader &header,
+                         SNAPSHOT_SECTION section) {
+  static const uint8_t zero[SNAPSHOT_ALIGN] = {0};
+  uint64_t offset = ftell(file);
+  uint64_t padding = DIVCEIL(offset, SNAPSHOT_ALIGN) * SNAPSHOT_ALIGN - offset;
+
+  writeData(file, zero, padding);
+
+  header.offset[section] = offset + padding;
+}
+
+static void endSection(FILE *file, SnapshotHeader &header,
+                       SNAPSHOT_SECTION section) {
+  header.length[section] = ftell(file) - header.offset[section];
+}
+
+static void seekSection(FILE *file, SnapshotHeader &header,
+                        SNAPSHOT_SECTION section, uint64_t length) {
+  if (length != std::numeric_limits<uint64_t>::max() &&
+      header.length[section] != length) {
+    panic("ftl: Snapshot section %u has invalid length", section);
+  }
+
+  if (fseek(file, header.offset[section], SEEK_SET) != 0) {
+    panic("ftl: Failed to read snapshot");
+  }
+}
+
 PageMapping::PageMapping(ConfigReader &c, Parameter &p, PAL::PAL *l,
-                         DRAM::AbstractDRAM *d)
+                         DRAM::AbstractDRAM *d, uint64_t metaPages)
     : AbstractFTL(p, l, d),
       pPAL(l),
       conf(c),
-      lastFreeBlock(param.pageCountToMaxPerf),
-      lastFreeBlockIOMap(param.ioUnitInPage),
-      bReclaimMore(false) {
+      // mjo: RandomTweak is only used when Superpaging is enabled.
+      // So, it's not my business :)
+      bRandomTweak(conf.readBoolean(CONFIG_FTL, FTL_USE_RANDOM_IO_TWEAK)),
+      bitsetSize(bRandomTweak ? param.ioUnitInPage : 1),
+      nMetaPages(metaPages),
+      blockArena(param.totalPhysicalBlocks, param.pagesInBlock,
+                 param.ioUnitInPage),
+      freeBlocks(param.pageCountToMaxPerf),
+      victims(param.totalPhysicalBlocks, param.pagesInBlock * bitsetSize,
+              (EVICT_POLICY)conf.readInt(CONFIG_FTL, FTL_GC_EVICT_POLICY) ==
+                  POLICY_COST_BENEFIT),
+      pClassifier(nullptr),
+      bReclaimMore(false),
+      bCopyback(conf.readBoolean(CONFIG_FTL, FTL_GC_USE_COPYBACK)),
+      gcVictim(param.totalPhysicalBlocks),
+      bInIncrementalGC(false),
+      bBackgroundGC(conf.readBoolean(CONFIG_FTL, FTL_BGC_ENABLE)),
+      bInBackgroundGC(false),
+      lastIOFinishedAt(0),
+      bgcFinishedAt(0),
+      bgcEvent(0),
+      bgcPreemptions(0),
+      nSLCBlocks(0),
+      slcPagesInBlock(param.pagesInBlock),
+      slcFreeBlocks(param.pageCountToMaxPerf),
+      nSLCFreeBlocks(0),
+      slcLastFreeBlock(param.pageCountToMaxPerf, param.totalPhysicalBlocks),
+      slcLastFreeBlockIndex(0),
+      bInFolding(false),
+      bStaticWL(conf.readBoolean(CONFIG_FTL, FTL_SWL_ENABLE)),
+      bInWearLeveling(false),
+      wlCredit(0.f),
+      bPlacement(conf.readBoolean(CONFIG_FTL, FTL_PLACEMENT_ENABLE)),
+      readHotThreshold(
+          (uint8_t)conf.readUint(CONFIG_FTL, FTL_READ_HOT_THRESHOLD)),
+      reads(0) {
+  float slcRatio = conf.readFloat(CONFIG_FTL, FTL_SLC_CACHE_RATIO);
+  auto nandType =
+      (PAL::NAND_TYPE)conf.readInt(CONFIG_PAL, PAL::NAND_FLASH_TYPE);
+
+  status.totalLogicalPages = param.totalLogicalBlocks * param.pagesInBlock;
+
   blocks.reserve(param.totalPhysicalBlocks);
-  table.reserve(param.totalLogicalBlocks * param.pagesInBlock);
-  write_cycle.resize(param.totalPhysicalBlocks, vector<int>(param.pagesInBlock));
+  table.resize((status.totalLogicalPages + nMetaPages) * bitsetSize,
+               {param.totalPhysicalBlocks, param.pagesInBlock});
+  mappedLPNs.resize(DIVCEIL(status.totalLogicalPages + nMetaPages, 64), 0);
+  nMappedLPNs = 0;
+  writeCount.resize((uint64_t)param.totalPhysicalBlocks * param.pagesInBlock,
+                    0);
+  writeCountDist.insert(0, writeCount.size());
+
+  // pSLC region has same number of blocks in all parallel units
+  if (slcRatio > 0.f) {
+    if (nandType == PAL::NAND_SLC) {
+      warn("ftl: SLC write cache is not used with SLC NAND");
+    }
+    else {
+      nSLCBlocks = (uint32_t)(param.totalPhysicalBlocks * slcRatio) /
+                   param.pageCountToMaxPerf * param.pageCountToMaxPerf;
+      slcPagesInBlock =
+          param.pagesInBlock / (nandType == PAL::NAND_MLC ? 2 : 3);
+
+      if (nSLCBlocks == 0 || slcPagesInBlock == 0) {
+        panic("ftl: Too small SLC write cache");
+      }
+
+      if (param.totalPhysicalBlocks - nSLCBlocks <=
+          param.totalLogicalBlocks + param.pageCountToMaxPerf) {
+        panic("ftl: Too large SLC write cache");
+      }
+    }
+  }
 
   for (uint32_t i = 0; i < param.totalPhysicalBlocks; i++) {
-    freeBlocks.emplace_back(Block(i, param.pagesInBlock, param.ioUnitInPage));
+    if (i < nSLCBlocks) {
+      slcFreeBlocks.at(convertBlockIdx(i)).emplace_back(blockArena, i);
+    }
+    else {
+      freeBlocks.insert(convertBlockIdx(i), Block(blockArena, i));
+    }
   }
 
-  nFreeBlocks = param.totalPhysicalBlocks;
+  nSLCFreeBlocks = nSLCBlocks;
 
-  status.totalLogicalPages = param.totalLogicalBlocks * param.pagesInBlock;
+  switch ((STREAM_MODE)conf.readInt(CONFIG_FTL, FTL_STREAM_MODE)) {
+    case STREAM_MODE_NONE:
+      break;
+    case STREAM_MODE_FREQUENCY:
+      pClassifier = new FrequencyClassifier(
+          status.totalLogicalPages + nMetaPages,
+          (uint8_t)conf.readUint(CONFIG_FTL, FTL_STREAM_HOT_THRESHOLD));
+      break;
+    case STREAM_MODE_DIRECTIVE:
+      pClassifier = new DirectiveClassifier();
+      break;
+    default:
+      panic("Invalid write stream mode");
+  }
+
+  frontiers.resize(pClassifier ? STREAM_COUNT : 1);
 
   // Allocate free blocks
-  for (uint32_t i = 0; i < param.pageCountToMaxPerf; i++) {
-    lastFreeBlock.at(i) = getFreeBlock(i);
+  for (auto &frontier : frontiers) {
+    frontier.lastFreeBlock.resize(param.pageCountToMaxPerf);
+    frontier.lastFreeBlockIOMap = Bitset(param.ioUnitInPage);
+    frontier.lastFreeBlockIndex = 0;
+    frontier.worn = false;
+
+    for (uint32_t i = 0; i < param.pageCountToMaxPerf; i++) {
+      frontier.lastFreeBlock.at(i) = getFreeBlock(i);
+    }
+  }
+
+  wlFrontier.lastFreeBlockIOMap = Bitset(param.ioUnitInPage);
+  wlFrontier.lastFreeBlockIndex = 0;
+  wlFrontier.worn = true;
+
+  if (bStaticWL) {
+    eraseCountDist.insert(0, param.totalPhysicalBlocks);
+
+    wlFrontier.lastFreeBlock.resize(param.pageCountToMaxPerf);
+
+    for (uint32_t i = 0; i < param.pageCountToMaxPerf; i++) {
+      wlFrontier.lastFreeBlock.at(i) = getFreeBlock(i, true);
+    }
   }
 
-  lastFreeBlockIndex = 0;
+  fastFrontier.lastFreeBlockIOMap = Bitset(param.ioUnitInPage);
+  fastFrontier.lastFreeBlockIndex = 0;
+  fastFrontier.worn = false;
+
+  if (bPlacement) {
+    fastFrontier.lastFreeBlock.resize(param.pageCountToMaxPerf);
+
+    for (uint32_t i = 0; i < param.pageCountToMaxPerf; i++) {
+      fastFrontier.lastFreeBlock.at(i) = getFreeBlock(i);
+    }
+
+    readCount.resize(status.totalLogicalPages + nMetaPages, 0);
+  }
 
   memset(&stat, 0, sizeof(stat));
+  memset(&bgcStat, 0, sizeof(bgcStat));
+  memset(&slcStat, 0, sizeof(slcStat));
+  memset(&foldStat, 0, sizeof(foldStat));
+  memset(&wlStat, 0, sizeof(wlStat));
+  memset(&placementStat, 0, sizeof(placementStat));
+  memset(streamWrites, 0, sizeof(streamWrites));
+  metaWrites = 0;
+
+  for (auto &iter : readLatency) {
+    iter.sum = 0;
+    iter.max = 0;
+  }
 
-  // mjo: RandomTweak is only used when Superpaging is enabled.
-  // So, it's not my business :)
-  bRandomTweak = conf.readBoolean(CONFIG_FTL, FTL_USE_RANDOM_IO_TWEAK);
-  bitsetSize = bRandomTweak ? param.ioUnitInPage : 1;
+  // Folding of pSLC blocks runs in idle time as background GC does
+  if (bBackgroundGC || nSLCBlocks > 0) {
+    bgcEvent = allocate([this](uint64_t tick) { backgroundGC(tick); });
+  }
 }
 
-PageMapping::~PageMapping() {}
+PageMapping::~PageMapping() {
+  delete pClassifier;
+}
 
 bool PageMapping::initialize() {
   uint64_t nPagesToWarmup;
   uint64_t nPagesToInvalidate;
   uint64_t nTotalLogicalPages;
   uint64_t maxPagesBeforeGC;
-  uint64_t tick;
   uint64_t valid;
   uint64_t invalid;
   FILLING_MODE mode;
 
-  Request req(param.ioUnitInPage);
-
   debugprint(LOG_FTL_PAGE_MAPPING, "Initialization started");
 
+  // Skip filling if snapshot is available
+  std::string snapshot = conf.readString(CONFIG_FTL, FTL_SNAPSHOT_LOAD_PATH);
+
+  if (snapshot.length() > 0) {
+    if (loadSnapshot(snapshot)) {
+      calculateTotalPages(valid, invalid);
+      debugprint(LOG_FTL_PAGE_MAPPING,
+                 "Snapshot loaded from %s. Page status:", snapshot.c_str());
+      debugprint(LOG_FTL_PAGE_MAPPING,
+                 "  Total valid physical pages: %" PRIu64, valid);
+      debugprint(LOG_FTL_PAGE_MAPPING,
+                 "  Total invalid physical pages: %" PRIu64, invalid);
+      debugprint(LOG_FTL_PAGE_MAPPING, "Initialization finished");
+
+      return true;
+    }
+
+    warn("ftl: Failed to open snapshot %s. Filling drive instead.",
+         snapshot.c_str());
+  }
+
   nTotalLogicalPages = param.totalLogicalBlocks * param.pagesInBlock;
   //mjo: By modifying this field, you can accelerate the first GC
   nPagesToWarmup =
@@ -95,7 +325,10 @@ bool PageMapping::initialize() {
       param.pagesInBlock *
       (param.totalPhysicalBlocks *
            (1 - conf.readFloat(CONFIG_FTL, FTL_GC_THRESHOLD_RATIO)) -
-       param.pageCountToMaxPerf);  // # free blocks to maintain
+       param.pageCountToMaxPerf * (frontiers.size() + (bStaticWL ? 1 : 0) +
+                                   (bPlacement ? 1 : 0)) -
+       nSLCBlocks) -
+      nMetaPages;  // # free blocks to maintain, and metadata pages
 
   if (nPagesToWarmup + nPagesToInvalidate > maxPagesBeforeGC) {
     warn("ftl: Too high filling ratio. Adjusting invalidPageRatio.");
@@ -112,64 +345,33 @@ bool PageMapping::initialize() {
              nPagesToInvalidate,
              nPagesToInvalidate * 100.f / nTotalLogicalPages);
 
-  req.ioFlag.set();
+  std::random_device rd;
+  std::mt19937_64 gen(rd());
 
   // Step 1. Filling
   if (mode == FILLING_MODE_0 || mode == FILLING_MODE_1) {
     // Sequential
-    for (uint64_t i = 0; i < nPagesToWarmup; i++) {
-      tick = 0;
-      req.lpn = i;
-      writeInternal(req, tick, false);
-    }
+    fillSequential(0, nPagesToWarmup);
   }
   else {
     // Random
-    std::random_device rd;
-    std::mt19937_64 gen(rd());
-    std::uniform_int_distribution<uint64_t> dist(0, nTotalLogicalPages - 1);
-
-    for (uint64_t i = 0; i < nPagesToWarmup; i++) {
-      tick = 0;
-      req.lpn = dist(gen);
-      writeInternal(req, tick, false);
-    }
+    fillRandom(nPagesToWarmup, nTotalLogicalPages, gen);
   }
 
   // Step 2. Invalidating
   if (mode == FILLING_MODE_0) {
     // Sequential
-    for (uint64_t i = 0; i < nPagesToInvalidate; i++) {
-      tick = 0;
-      req.lpn = i;
-      writeInternal(req, tick, false);
-    }
+    fillSequential(0, nPagesToInvalidate);
   }
   else if (mode == FILLING_MODE_1) {
     // Random
     // We can successfully restrict range of LPN to create exact number of
     // invalid pages because we wrote in sequential mannor in step 1.
-    std::random_device rd;
-    std::mt19937_64 gen(rd());
-    std::uniform_int_distribution<uint64_t> dist(0, nPagesToWarmup - 1);
-
-    for (uint64_t i = 0; i < nPagesToInvalidate; i++) {
-      tick = 0;
-      req.lpn = dist(gen);
-      writeInternal(req, tick, false);
-    }
+    fillRandom(nPagesToInvalidate, nPagesToWarmup, gen);
   }
   else {
     // Random
-    std::random_device rd;
-    std::mt19937_64 gen(rd());
-    std::uniform_int_distribution<uint64_t> dist(0, nTotalLogicalPages - 1);
-
-    for (uint64_t i = 0; i < nPagesToInvalidate; i++) {
-      tick = 0;
-      req.lpn = dist(gen);
-      writeInternal(req, tick, false);
-    }
+    fillRandom(nPagesToInvalidate, nTotalLogicalPages, gen);
   }
 
   // Report
@@ -185,6 +387,20 @@ bool PageMapping::initialize() {
              " (%.2f %%, target: %" PRIu64 ", error: %" PRId64 ")",
              invalid, invalid * 100.f / nTotalLogicalPages, nPagesToInvalidate,
              (int64_t)(invalid - nPagesToInvalidate));
+
+  // Metadata pages are written before saving snapshot, so loading snapshot
+  // restores them too
+  fillMetadata();
+
+  snapshot = conf.readString(CONFIG_FTL, FTL_SNAPSHOT_SAVE_PATH);
+
+  if (snapshot.length() > 0) {
+    saveSnapshot(snapshot);
+
+    debugprint(LOG_FTL_PAGE_MAPPING, "Snapshot saved to %s",
+               snapshot.c_str());
+  }
+
   debugprint(LOG_FTL_PAGE_MAPPING, "Initialization finished");
 
   return true;
@@ -193,6 +409,8 @@ bool PageMapping::initialize() {
 void PageMapping::read(Request &req, uint64_t &tick) {
   uint64_t begin = tick;
 
+  preemptBackgroundGC(tick);
+
   if (req.ioFlag.count() > 0) {
     readInternal(req, tick);
 
@@ -206,11 +424,15 @@ void PageMapping::read(Request &req, uint64_t &tick) {
   }
 
   tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::READ);
+
+  scheduleBackgroundGC(tick);
 }
 
 void PageMapping::write(Request &req, uint64_t &tick) {
   uint64_t begin = tick;
 
+  preemptBackgroundGC(tick);
+
   if (req.ioFlag.count() > 0) {
     writeInternal(req, tick);
 
@@ -224,11 +446,15 @@ void PageMapping::write(Request &req, uint64_t &tick) {
   }
 
   tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::WRITE);
+
+  scheduleBackgroundGC(tick);
 }
 
 void PageMapping::trim(Request &req, uint64_t &tick) {
   uint64_t begin = tick;
 
+  preemptBackgroundGC(tick);
+
   trimInternal(req, tick);
 
   debugprint(LOG_FTL_PAGE_MAPPING,
@@ -237,38 +463,46 @@ void PageMapping::trim(Request &req, uint64_t &tick) {
              req.lpn, begin, tick, tick - begin);
 
   tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::TRIM);
+
+  scheduleBackgroundGC(tick);
 }
 
-void PageMapping::format(LPNRange &range, uint64_t &tick) {
-  PAL::Request req(param.ioUnitInPage);
+void PageMapping::trim(LPNRange &range, uint64_t &tick) {
   std::vector<uint32_t> list;
+  uint64_t lpnEnd = MIN(range.slpn + range.nlp, status.totalLogicalPages);
+  uint64_t begin = tick;
 
-  req.ioFlag.set();
+  preemptBackgroundGC(tick);
 
-  for (auto iter = table.begin(); iter != table.end();) {
-    if (iter->first >= range.slpn && iter->first < range.slpn + range.nlp) {
-      auto &mappingList = iter->second;
+  if (range.slpn < lpnEnd) {
+    // Mapping table entries of range are contiguous
+    pDRAM->read(getMappingList(range.slpn),
+                8 * bitsetSize * (lpnEnd - range.slpn), tick);
 
-      // Do trim
-      for (uint32_t idx = 0; idx < bitsetSize; idx++) {
-        auto &mapping = mappingList.at(idx);
-        auto block = blocks.find(mapping.first);
+    invalidateRange(range.slpn, lpnEnd, list);
 
-        if (block == blocks.end()) {
-          panic("Block is not in use");
-        }
+    tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::TRIM_INTERNAL);
+  }
 
-        block->second.invalidate(mapping.second, idx);
+  debugprint(LOG_FTL_PAGE_MAPPING,
+             "TRIM  | LPN %" PRIu64 " + %" PRIu64 " | %" PRIu64 " - %" PRIu64
+             " (%" PRIu64 ")",
+             range.slpn, range.nlp, begin, tick, tick - begin);
 
-        // Collect block indices
-        list.push_back(mapping.first);
-      }
+  tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::TRIM);
 
-      iter = table.erase(iter);
-    }
-    else {
-      iter++;
-    }
+  scheduleBackgroundGC(tick);
+}
+
+void PageMapping::format(LPNRange &range, uint64_t &tick) {
+  std::vector<uint32_t> list;
+
+  preemptBackgroundGC(tick);
+
+  uint64_t lpnEnd = MIN(range.slpn + range.nlp, status.totalLogicalPages);
+
+  if (range.slpn < lpnEnd) {
+    invalidateRange(range.slpn, lpnEnd, list);
   }
 
   // Get blocks to erase
@@ -280,95 +514,230 @@ void PageMapping::format(LPNRange &range, uint64_t &tick) {
   doGarbageCollection(list, tick);
 
   tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::FORMAT);
+
+  scheduleBackgroundGC(tick);
 }
 
 Status *PageMapping::getStatus(uint64_t lpnBegin, uint64_t lpnEnd) {
-  status.freePhysicalBlocks = nFreeBlocks;
+  status.freePhysicalBlocks = freeBlocks.getBlockCount();
 
   if (lpnBegin == 0 && lpnEnd >= status.totalLogicalPages) {
-    status.mappedLogicalPages = table.size();
+    status.mappedLogicalPages = nMappedLPNs;
   }
   else {
-    status.mappedLogicalPages = 0;
-
-    for (uint64_t lpn = lpnBegin; lpn < lpnEnd; lpn++) {
-      if (table.count(lpn) > 0) {
-        status.mappedLogicalPages++;
-      }
-    }
+    status.mappedLogicalPages = countMappedLPNs(lpnBegin, lpnEnd);
   }
 
   return &status;
 }
 
+std::pair<uint32_t, uint32_t> *PageMapping::getMappingList(uint64_t lpn) {
+  if (lpn >= status.totalLogicalPages + nMetaPages) {
+    panic("LPN out of range");
+  }
+
+  return table.data() + lpn * bitsetSize;
+}
+
+bool PageMapping::isMapped(uint64_t lpn) {
+  return mappedLPNs[lpn / 64] & ((uint64_t)1 << (lpn % 64));
+}
+
+// Metadata pages are not counted in nMappedLPNs
+void PageMapping::setMapped(uint64_t lpn, bool mapped) {
+  uint64_t &word = mappedLPNs[lpn / 64];
+  uint64_t mask = (uint64_t)1 << (lpn % 64);
+  uint64_t count = lpn < status.totalLogicalPages ? 1 : 0;
+
+  if (mapped && !(word & mask)) {
+    word |= mask;
+    nMappedLPNs += count;
+  }
+  else if (!mapped && (word & mask)) {
+    word &= ~mask;
+    nMappedLPNs -= count;
+  }
+}
+
+uint64_t PageMapping::countMappedLPNs(uint64_t lpnBegin, uint64_t lpnEnd) {
+  uint64_t count = 0;
+
+  lpnEnd = MIN(lpnEnd, status.totalLogicalPages);
+
+  if (lpnBegin >= lpnEnd) {
+    return 0;
+  }
+
+  uint64_t first = lpnBegin / 64;
+  uint64_t last = (lpnEnd - 1) / 64;
+  uint64_t headMask = ~(uint64_t)0 << (lpnBegin % 64);
+  uint64_t tailMask = ~(uint64_t)0 >> (63 - (lpnEnd - 1) % 64);
+
+  if (first == last) {
+    return popcount(mappedLPNs[first] & headMask & tailMask);
+  }
+
+  count += popcount(mappedLPNs[first] & headMask);
+
+  for (uint64_t i = first + 1; i < last; i++) {
+    count += popcount(mappedLPNs[i]);
+  }
+
+  count += popcount(mappedLPNs[last] & tailMask);
+
+  return count;
+}
+
 float PageMapping::freeBlockRatio() {
-  return (float)nFreeBlocks / param.totalPhysicalBlocks;
+  return (float)freeBlocks.getBlockCount() / param.totalPhysicalBlocks;
 }
 
 uint32_t PageMapping::convertBlockIdx(uint32_t blockIdx) {
   return blockIdx % param.pageCountToMaxPerf;
 }
 
-uint32_t PageMapping::getFreeBlock(uint32_t idx) {
-  uint32_t blockIndex = 0;
+bool PageMapping::isSLCBlock(uint32_t blockIndex) {
+  return blockIndex < nSLCBlocks;
+}
+
+// Pages of pSLC block are all LSB pages
+PAL::PAGE_TYPE PageMapping::getPageType(uint32_t blockIndex,
+                                        uint32_t pageIndex) {
+  if (isSLCBlock(blockIndex)) {
+    return PAL::PAGE_TYPE_LSB;
+  }
+
+  return pPAL->getPageType(pageIndex);
+}
+
+// Whether next page of open block written with I/O map is LSB page
+bool PageMapping::isNextPageFast(uint32_t blockIndex, Bitset &iomap) {
+  auto block = blocks.find(blockIndex);
+  uint32_t pageIndex = 0;
+
+  if (block == blocks.end()) {
+    panic("Corrupted");
+  }
 
-  if (idx >= param.pageCountToMaxPerf) {
-    panic("Index out of range");
+  for (uint32_t idx = 0; idx < bitsetSize; idx++) {
+    if (iomap.test(idx) || !bRandomTweak) {
+      pageIndex = MAX(pageIndex, block->second.getNextWritePageIndex(idx));
+    }
   }
 
-  if (nFreeBlocks > 0) {
-    // Search block which is blockIdx % param.pageCountToMaxPerf == idx
-    auto iter = freeBlocks.begin();
+  return getPageType(blockIndex, pageIndex) == PAL::PAGE_TYPE_LSB;
+}
 
-    for (; iter != freeBlocks.end(); iter++) {
-      blockIndex = iter->getBlockIndex();
+// Count read of LPN, counters are halved every LPN count reads
+void PageMapping::touchRead(uint64_t lpn) {
+  uint8_t &count = readCount.at(lpn);
 
-      if (blockIndex % param.pageCountToMaxPerf == idx) {
-        break;
-      }
+  if (count < 0xFF) {
+    count++;
+  }
+
+  if (++reads == readCount.size()) {
+    for (auto &iter : readCount) {
+      iter >>= 1;
     }
 
-    // Sanity check
-    if (iter == freeBlocks.end()) {
-      // Just use first one
-      iter = freeBlocks.begin();
-      blockIndex = iter->getBlockIndex();
+    reads = 0;
+  }
+}
+
+// FTL metadata and frequently read data are latency-critical
+bool PageMapping::isLatencyCritical(uint64_t lpn) {
+  return lpn >= status.totalLogicalPages ||
+         readCount.at(lpn) >= readHotThreshold;
+}
+
+// Returns open block of fast frontier in the same parallel unit instead of
+// given open block, when type of its next page suits the data
+// Latency-critical data goes to whichever block is at LSB page, and other
+// data fills slow pages of fast frontier.
+uint32_t PageMapping::placeByPageType(uint32_t blockIndex, Bitset &iomap,
+                                      bool critical) {
+  uint32_t fastIndex =
+      getLastFreeBlockInUnit(convertBlockIdx(blockIndex), fastFrontier);
+  bool fast = isNextPageFast(fastIndex, iomap);
+
+  if (critical) {
+    if (fast || !isNextPageFast(blockIndex, iomap)) {
+      blockIndex = fastIndex;
     }
+  }
+  else if (!fast) {
+    blockIndex = fastIndex;
+  }
+
+  return blockIndex;
+}
+
+// Returns open pSLC block of next parallel unit which has one, or
+// totalPhysicalBlocks if pSLC region is exhausted
+uint32_t PageMapping::getLastSLCBlock() {
+  for (uint32_t i = 1; i <= param.pageCountToMaxPerf; i++) {
+    uint32_t index = (slcLastFreeBlockIndex + i) % param.pageCountToMaxPerf;
+    auto &blockIndex = slcLastFreeBlock.at(index);
+
+    if (blockIndex == param.totalPhysicalBlocks) {
+      auto &pool = slcFreeBlocks.at(index);
+
+      if (pool.empty()) {
+        continue;
+      }
+
+      blockIndex = pool.front().getBlockIndex();
+
+      if (blocks.find(blockIndex) != blocks.end()) {
+        panic("Corrupted");
+      }
 
-    // Insert found block to block list
-    if (blocks.find(blockIndex) != blocks.end()) {
-      panic("Corrupted");
+      blocks.emplace(blockIndex, std::move(pool.front()));
+      pool.pop_front();
+      nSLCFreeBlocks--;
     }
 
-    blocks.emplace(blockIndex, std::move(*iter));
+    slcLastFreeBlockIndex = index;
 
-    // Remove found block from free block list
-    freeBlocks.erase(iter);
-    nFreeBlocks--;
+    return blockIndex;
   }
-  else {
-    panic("No free block left");
+
+  return param.totalPhysicalBlocks;
+}
+
+// Returns most erased free block if worn is set, least erased one otherwise
+uint32_t PageMapping::getFreeBlock(uint32_t idx, bool worn) {
+  return freeBlocks.take(idx, worn, blocks);
+}
+
+PageMapping::WriteFrontier &PageMapping::getFrontier(WRITE_STREAM stream) {
+  if (frontiers.size() == 1) {
+    return frontiers.front();
   }
 
-  return blockIndex;
+  return frontiers.at(stream);
 }
 
-uint32_t PageMapping::getLastFreeBlock(Bitset &iomap) {
-  if (!bRandomTweak || (lastFreeBlockIOMap & iomap).any()) {
+uint32_t PageMapping::getLastFreeBlock(Bitset &iomap,
+                                       WriteFrontier &frontier) {
+  auto &index = frontier.lastFreeBlockIndex;
+
+  if (!bRandomTweak || (frontier.lastFreeBlockIOMap & iomap).any()) {
     // Update lastFreeBlockIndex
-    lastFreeBlockIndex++;
+    index++;
 
-    if (lastFreeBlockIndex == param.pageCountToMaxPerf) {
-      lastFreeBlockIndex = 0;
+    if (index == param.pageCountToMaxPerf) {
+      index = 0;
     }
 
-    lastFreeBlockIOMap = iomap;
+    frontier.lastFreeBlockIOMap = iomap;
   }
   else {
-    lastFreeBlockIOMap |= iomap;
+    frontier.lastFreeBlockIOMap |= iomap;
   }
 
-  auto freeBlock = blocks.find(lastFreeBlock.at(lastFreeBlockIndex));
+  auto freeBlock = blocks.find(frontier.lastFreeBlock.at(index));
 
   // Sanity check
   if (freeBlock == blocks.end()) {
@@ -377,58 +746,37 @@ uint32_t PageMapping::getLastFreeBlock(Bitset &iomap) {
 
   // If current free block is full, get next block
   if (freeBlock->second.getNextWritePageIndex() == param.pagesInBlock) {
-    lastFreeBlock.at(lastFreeBlockIndex) = getFreeBlock(lastFreeBlockIndex);
+    frontier.lastFreeBlock.at(index) = getFreeBlock(index, frontier.worn);
 
     bReclaimMore = true;
   }
 
-  return lastFreeBlock.at(lastFreeBlockIndex);
+  return frontier.lastFreeBlock.at(index);
 }
 
-// calculate weight of each block regarding victim selection policy
-void PageMapping::calculateVictimWeight(
-    std::vector<std::pair<uint32_t, float>> &weight, const EVICT_POLICY policy,
-    uint64_t tick) {
-  float temp;
-
-  weight.reserve(blocks.size());
-
-  switch (policy) {
-    case POLICY_GREEDY:
-    case POLICY_RANDOM:
-    case POLICY_DCHOICE:
-      for (auto &iter : blocks) {
-        if (iter.second.getNextWritePageIndex() != param.pagesInBlock) {
-          // mjo: Pass not fully written blocks
-          continue;
-        }
-
-        // mjo: Store fully written blocks
-        weight.push_back({iter.first, iter.second.getValidPageCountRaw()});
-      }
-
-      break;
-    case POLICY_COST_BENEFIT:
-      for (auto &iter : blocks) {
-        if (iter.second.getNextWritePageIndex() != param.pagesInBlock) {
-          continue;
-        }
+// Same as getLastFreeBlock(), but use free block of given parallel unit
+uint32_t PageMapping::getLastFreeBlockInUnit(uint32_t index,
+                                             WriteFrontier &frontier) {
+  auto freeBlock = blocks.find(frontier.lastFreeBlock.at(index));
 
-        temp = (float)(iter.second.getValidPageCountRaw()) / param.pagesInBlock;
+  // Sanity check
+  if (freeBlock == blocks.end()) {
+    panic("Corrupted");
+  }
 
-        weight.push_back(
-            {iter.first,
-             temp / ((1 - temp) * (tick - iter.second.getLastAccessedTime()))});
-      }
+  // If current free block is full, get next block
+  if (freeBlock->second.getNextWritePageIndex() == param.pagesInBlock) {
+    frontier.lastFreeBlock.at(index) = getFreeBlock(index, frontier.worn);
 
-      break;
-    default:
-      panic("Invalid evict policy");
+    bReclaimMore = true;
   }
+
+  return frontier.lastFreeBlock.at(index);
 }
 
+// Select victims as GC mode specifies, or select count victims if given
 void PageMapping::selectVictimBlock(std::vector<uint32_t> &list,
-                                    uint64_t &tick) {
+                                    uint64_t &tick, uint64_t count) {
   static const GC_MODE mode = (GC_MODE)conf.readInt(CONFIG_FTL, FTL_GC_MODE);
   static const EVICT_POLICY policy =
       (EVICT_POLICY)conf.readInt(CONFIG_FTL, FTL_GC_EVICT_POLICY);
@@ -438,93 +786,106 @@ void PageMapping::selectVictimBlock(std::vector<uint32_t> &list,
   // In many cases, GCReclaimBlocks value is set to 1, so the code evicts
   // only one block
   uint64_t nBlocks = conf.readUint(CONFIG_FTL, FTL_GC_RECLAIM_BLOCK);
-  std::vector<std::pair<uint32_t, float>> weight;
 
   list.clear();
 
   // Calculate number of blocks to reclaim
-  if (mode == GC_MODE_0) {
+  if (count > 0) {
+    nBlocks = count;
+  }
+  else if (mode == GC_MODE_0 || mode == GC_MODE_2) {
     // DO NOTHING
   }
   else if (mode == GC_MODE_1) {
     static const float t = conf.readFloat(CONFIG_FTL, FTL_GC_RECLAIM_THRESHOLD);
 
-    nBlocks = param.totalPhysicalBlocks * t - nFreeBlocks;
+    nBlocks = param.totalPhysicalBlocks * t - freeBlocks.getBlockCount();
   }
   else {
     panic("Invalid GC mode");
   }
 
   // reclaim one more if last free block fully used
-  if (bReclaimMore) {
+  if (bReclaimMore && count == 0) {
     nBlocks += param.pageCountToMaxPerf;
 
     bReclaimMore = false;
   }
 
-  // Calculate weights of all blocks
-  // mjo: Get fully written blocks with their valid page ratio
-  calculateVictimWeight(weight, policy, tick);
-
-  if (policy == POLICY_RANDOM || policy == POLICY_DCHOICE) {
-    uint64_t randomRange =
-        policy == POLICY_RANDOM ? nBlocks : dChoiceParam * nBlocks;
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<uint64_t> dist(0, weight.size() - 1);
-    std::vector<std::pair<uint32_t, float>> selected;
-
-    while (selected.size() < randomRange) {
-      uint64_t idx = dist(gen);
-
-      if (weight.at(idx).first < std::numeric_limits<uint32_t>::max()) {
-        selected.push_back(weight.at(idx));
-        weight.at(idx).first = std::numeric_limits<uint32_t>::max();
-      }
-    }
+  // Select victims from the blocks with the lowest weight
+  // mjo: Only fully written blocks are in victim index
+  nBlocks = MIN(nBlocks, victims.getCandidateCount());
 
-    weight = std::move(selected);
-  }
+  switch (policy) {
+    case POLICY_GREEDY:
+      victims.selectGreedy(nBlocks, list);
 
-  // Sort weights
-  std::sort(
-      weight.begin(), weight.end(),
-      [](std::pair<uint32_t, float> a, std::pair<uint32_t, float> b) -> bool {
-        return a.second < b.second;
-      });
+      break;
+    case POLICY_COST_BENEFIT:
+      victims.selectCostBenefit(nBlocks, tick, list);
 
-  // Select victims from the blocks with the lowest weight
-  nBlocks = MIN(nBlocks, weight.size());
+      break;
+    case POLICY_RANDOM:
+    case POLICY_DCHOICE: {
+      std::random_device rd;
+      std::mt19937 gen(rd());
 
-  // mjo: Store logical block numbers
-  for (uint64_t i = 0; i < nBlocks; i++) {
-    list.push_back(weight.at(i).first);
+      if (policy == POLICY_RANDOM) {
+        victims.selectRandom(nBlocks, gen, list);
+      }
+      else {
+        victims.selectDChoice(nBlocks, dChoiceParam, gen, list);
+      }
+    } break;
+    default:
+      panic("Invalid evict policy");
   }
 
   tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::SELECT_VICTIM_BLOCK);
 }
 
+// Relocate valid pages of given blocks and erase them
+// If pageLimit is given, stop after relocating pageLimit valid superpages.
+// Blocks still having valid pages are not erased.
 void PageMapping::doGarbageCollection(std::vector<uint32_t> &blocksToReclaim,
-                                      uint64_t &tick) {
+                                      uint64_t &tick, uint32_t pageLimit) {
   PAL::Request req(param.ioUnitInPage);
   std::vector<PAL::Request> readRequests;
-  std::vector<PAL::Request> writeRequests;
-  std::vector<PAL::Request> eraseRequests;
+  std::vector<std::pair<PAL::Request, uint64_t>> eraseRequests;  // Victim
+  std::vector<std::pair<PAL::Request, PAL::Request>> copybackRequests;
   std::vector<uint64_t> lpns;
   Bitset bit(param.ioUnitInPage);
   uint64_t beginAt;
-  uint64_t readFinishedAt = tick;
   uint64_t writeFinishedAt = tick;
   uint64_t eraseFinishedAt = tick;
+  uint32_t copied = 0;
+
+  // Relocation is pipelined per page. Each write waits only for the read of
+  // its source page, and each victim is erased as soon as all of its valid
+  // pages are read out (or copied back).
+  std::vector<std::pair<PAL::Request, uint64_t>> writeRequests;  // Read index
+  std::vector<uint64_t> readVictims;      // Victim index of each read
+  std::vector<uint64_t> copybackVictims;  // Victim index of each copyback
+  std::vector<uint64_t> readFinishedAt;
+  std::vector<uint64_t> drainedAt(blocksToReclaim.size(), tick);
+  GCStat &gcStat = bInFolding        ? foldStat
+                   : bInWearLeveling ? wlStat
+                   : bInBackgroundGC ? bgcStat
+                                     : stat;
+  // Static wear-leveling moves cold data to the most erased blocks
+  WriteFrontier &frontier =
+      bInWearLeveling ? wlFrontier : getFrontier(STREAM_GC);
 
   if (blocksToReclaim.size() == 0) {
     return;
   }
 
+  req.gc = true;
+
   // For all blocks to reclaim, collecting request structure only
   // mjo: blocksToReclaim is sorted by valid-page-ratio
-  for (auto &iter : blocksToReclaim) {
-    auto block = blocks.find(iter);
+  for (uint64_t victim = 0; victim < blocksToReclaim.size(); victim++) {
+    auto block = blocks.find(blocksToReclaim.at(victim));
 
     if (block == blocks.end()) {
       panic("Invalid block");
@@ -532,6 +893,10 @@ void PageMapping::doGarbageCollection(std::vector<uint32_t> &blocksToReclaim,
 
     // Copy valid pages to free block
     for (uint32_t pageIndex = 0; pageIndex < param.pagesInBlock; pageIndex++) {
+      if (pageLimit > 0 && copied == pageLimit) {
+        break;
+      }
+
       // Valid?
       if (block->second.getPageInfo(pageIndex, lpns, bit)) {
         if (!bRandomTweak) {
@@ -539,14 +904,41 @@ void PageMapping::doGarbageCollection(std::vector<uint32_t> &blocksToReclaim,
         }
 
         // Retrive free block
-        auto freeBlock = blocks.find(getLastFreeBlock(bit));
+        // Copyback needs free block in the same parallel unit, and falls back
+        // to read and write when the unit has no free block
+        // Page register of pSLC block cannot be programmed to normal block
+        uint32_t unit = convertBlockIdx(block->first);
+        bool slc = isSLCBlock(block->first);
+        uint32_t freeBlockIndex =
+            bCopyback && !slc ? getLastFreeBlockInUnit(unit, frontier)
+                              : getLastFreeBlock(bit, frontier);
+        bool critical = false;
+
+        // Cold data migrated by static wear-leveling stays in worn blocks
+        if (bPlacement && !bInWearLeveling) {
+          for (uint32_t idx = 0; idx < bitsetSize; idx++) {
+            if (bit.test(idx) && isLatencyCritical(lpns.at(idx))) {
+              critical = true;
+            }
+          }
+
+          freeBlockIndex = placeByPageType(freeBlockIndex, bit, critical);
+        }
+
+        auto freeBlock = blocks.find(freeBlockIndex);
+        bool copyback = bCopyback && !slc &&
+                        convertBlockIdx(freeBlock->first) == unit;
 
         // Issue Read
         req.blockIndex = block->first;
         req.pageIndex = pageIndex;
         req.ioFlag = bit;
+        req.slc = slc;
 
-        readRequests.push_back(req);
+        if (!copyback) {
+          readRequests.push_back(req);
+          readVictims.push_back(victim);
+        }
 
         // Update mapping table
         uint32_t newBlockIdx = freeBlock->first;
@@ -562,28 +954,40 @@ void PageMapping::doGarbageCollection(std::vector<uint32_t> &blocksToReclaim,
           if (bit.test(idx)) {
             // Invalidate
             block->second.invalidate(pageIndex, idx);
+            victims.decrease(block->first);
 
-            auto mappingList = table.find(lpns.at(idx));
-
-            if (mappingList == table.end()) {
+            if (!isMapped(lpns.at(idx))) {
               panic("Invalid mapping table entry");
             }
 
-            pDRAM->read(&(*mappingList), 8 * param.ioUnitInPage, tick);
+            auto mappingList = getMappingList(lpns.at(idx));
 
-            auto &mapping = mappingList->second.at(idx);
+            pDRAM->read(mappingList, 8 * param.ioUnitInPage, tick);
+
+            auto &mapping = mappingList[idx];
 
             uint32_t newPageIdx = freeBlock->second.getNextWritePageIndex(idx);
 
             mapping.first = newBlockIdx;
             mapping.second = newPageIdx;
 
+            if (critical) {
+              placementStat.criticalPageWrites++;
+
+              if (getPageType(newBlockIdx, newPageIdx) ==
+                  PAL::PAGE_TYPE_LSB) {
+                placementStat.fastPageWrites++;
+              }
+            }
+
 			// mjo: Copy data
-            freeBlock->second.write(newPageIdx, lpns.at(idx), idx, beginAt);
+            freeBlock->second.write(newPageIdx, lpns.at(idx), idx, tick);
+            victims.increase(newBlockIdx);
 
             // Issue Write
             req.blockIndex = newBlockIdx;
             req.pageIndex = newPageIdx;
+            req.slc = false;
 
             if (bRandomTweak) {
               req.ioFlag.reset();
@@ -593,46 +997,88 @@ void PageMapping::doGarbageCollection(std::vector<uint32_t> &blocksToReclaim,
               req.ioFlag.set();
             }
 
-            writeRequests.push_back(req);
+            if (copyback) {
+              PAL::Request source(req);
+
+              source.blockIndex = block->first;
+              source.pageIndex = pageIndex;
+
+              copybackRequests.emplace_back(source, req);
+              copybackVictims.push_back(victim);
+            }
+            else {
+              writeRequests.emplace_back(req, readRequests.size() - 1);
+            }
+
+            gcStat.validPageCopies++;
+            streamWrites[STREAM_GC]++;
+          }
+        }
 
-            stat.validPageCopies++;
+        if (freeBlock->second.getNextWritePageIndex() == param.pagesInBlock) {
+          victims.insert(newBlockIdx, tick);
+
+          if (bStaticWL) {
+            coldBlocks.emplace(freeBlock->second.getEraseCount(), newBlockIdx);
           }
         }
 
-        stat.validSuperPageCopies++;
+        gcStat.validSuperPageCopies++;
+        copied++;
       }
     }
 
     // Erase block
-    req.blockIndex = block->first;
-    req.pageIndex = 0;
-    req.ioFlag.set();
+    if (victims.getValidCount(block->first) == 0) {
+      req.blockIndex = block->first;
+      req.pageIndex = 0;
+      req.ioFlag.set();
 
-    eraseRequests.push_back(req);
+      eraseRequests.emplace_back(req, victim);
+    }
   }
 
   // Do actual I/O here
   // This handles PAL2 limitation (SIGSEGV, infinite loop, or so-on)
-  for (auto &iter : readRequests) {
+  // All reads are issued first, so reads of later victims are not queued
+  // behind erases of earlier victims in the same die
+  readFinishedAt.reserve(readRequests.size());
+
+  for (uint64_t i = 0; i < readRequests.size(); i++) {
+    beginAt = tick;
+
+    pPAL->read(readRequests.at(i), beginAt);
+
+    readFinishedAt.push_back(beginAt);
+    drainedAt.at(readVictims.at(i)) =
+        MAX(drainedAt.at(readVictims.at(i)), beginAt);
+  }
+
+  for (uint64_t i = 0; i < copybackRequests.size(); i++) {
+    auto &iter = copybackRequests.at(i);
+
     beginAt = tick;
 
-    pPAL->read(iter, beginAt);
+    pPAL->copyback(iter.first, iter.second, beginAt);
 
-    readFinishedAt = MAX(readFinishedAt, beginAt);
+    drainedAt.at(copybackVictims.at(i)) =
+        MAX(drainedAt.at(copybackVictims.at(i)), beginAt);
   }
 
+  // Destination blocks are spread over all parallel units by frontier, so
+  // programs of different dies overlap with remaining reads
   for (auto &iter : writeRequests) {
-    beginAt = readFinishedAt;
+    beginAt = readFinishedAt.at(iter.second);
 
-    pPAL->write(iter, beginAt);
+    pPAL->write(iter.first, beginAt);
 
     writeFinishedAt = MAX(writeFinishedAt, beginAt);
   }
 
   for (auto &iter : eraseRequests) {
-    beginAt = readFinishedAt;
+    beginAt = drainedAt.at(iter.second);
 
-    eraseInternal(iter, beginAt);
+    eraseInternal(iter.first, beginAt);
 
     eraseFinishedAt = MAX(eraseFinishedAt, beginAt);
   }
@@ -646,25 +1092,30 @@ void PageMapping::readInternal(Request &req, uint64_t &tick) {
   uint64_t beginAt;
   uint64_t finishedAt = tick;
 
-  auto mappingList = table.find(req.lpn);
+  auto mappingList = getMappingList(req.lpn);
+
+  if (isMapped(req.lpn)) {
+    if (bPlacement) {
+      touchRead(req.lpn);
+    }
 
-  if (mappingList != table.end()) {
     if (bRandomTweak) {
-      pDRAM->read(&(*mappingList), 8 * req.ioFlag.count(), tick);
+      pDRAM->read(mappingList, 8 * req.ioFlag.count(), tick);
     }
     else {
-      pDRAM->read(&(*mappingList), 8, tick);
+      pDRAM->read(mappingList, 8, tick);
     }
 
     for (uint32_t idx = 0; idx < bitsetSize; idx++) {
       if (req.ioFlag.test(idx) || !bRandomTweak) {
         // mjo: block#, page#
-        auto &mapping = mappingList->second.at(idx);
+        auto &mapping = mappingList[idx];
 
         if (mapping.first < param.totalPhysicalBlocks &&
             mapping.second < param.pagesInBlock) {
           palRequest.blockIndex = mapping.first;
           palRequest.pageIndex = mapping.second;
+          palRequest.slc = isSLCBlock(mapping.first);
 
           // mjo: Random I/O tweak is used when superpage mode is enabled.
           // The authors said it helps random write performance, I'm not sure what it is though.
@@ -684,9 +1135,19 @@ void PageMapping::readInternal(Request &req, uint64_t &tick) {
 
           beginAt = tick;
 
-          block->second.read(palRequest.pageIndex, idx, beginAt);
+          if (block->second.read(palRequest.pageIndex, idx, beginAt)) {
+            victims.touch(block->first, beginAt);
+          }
           pPAL->read(palRequest, beginAt);
 
+          ReadLatency &latency =
+              readLatency[getPageType(mapping.first, mapping.second)];
+          uint64_t ns = (beginAt - tick) / 1000;
+
+          latency.sum += ns;
+          latency.max = MAX(latency.max, ns);
+          latency.dist.insert(ns / READ_LATENCY_BIN);
+
           finishedAt = MAX(finishedAt, beginAt);
         }
       }
@@ -701,26 +1162,30 @@ void PageMapping::writeInternal(Request &req, uint64_t &tick, bool sendToPAL) {
   PAL::Request palRequest(req);	// mjo: Copy ioFlag. IOFlag means pages in a superpage
   std::unordered_map<uint32_t, Block>::iterator block;
   // mjo: table holds LPN -> PPN mappings
-  auto mappingList = table.find(req.lpn);	// mjo: a vector of <block#, page# in a block>
+  auto mappingList = getMappingList(req.lpn);	// mjo: an array of <block#, page# in a block>
   uint64_t beginAt;
   uint64_t finishedAt = tick;
   bool readBeforeWrite = false;
+  WRITE_STREAM stream =
+      pClassifier ? pClassifier->classify(req) : STREAM_HOST_HOT;
 
   // mjo: Step 1: Invalidate previously written  page(s).
 
-  if (mappingList != table.end()) {
+  if (isMapped(req.lpn)) {
     for (uint32_t idx = 0; idx < bitsetSize; idx++) {
       // Do IO operation per page, not superpage!
       if (req.ioFlag.test(idx) || !bRandomTweak) {
-        auto &mapping = mappingList->second.at(idx);	// mjo: <block#, page# in block>
-		write_cycle[mapping.first][mapping.second]++;
+        auto &mapping = mappingList[idx];	// mjo: <block#, page# in block>
 
         if (mapping.first < param.totalPhysicalBlocks &&
             mapping.second < param.pagesInBlock) {
+          increaseWriteCount(mapping.first, mapping.second);
+
           block = blocks.find(mapping.first);
 
           // Invalidate current page
           block->second.invalidate(mapping.second, idx);
+          victims.decrease(mapping.first);
 
           // mjo: Since SSDs cannnot update data, 
           // we need to invalidate the previous data before overwrite them.
@@ -729,37 +1194,49 @@ void PageMapping::writeInternal(Request &req, uint64_t &tick, bool sendToPAL) {
     }
   }
   else {
-    // Create empty mapping
-    auto ret = table.emplace(
-        req.lpn,
-        std::vector<std::pair<uint32_t, uint32_t>>(
-            bitsetSize, {param.totalPhysicalBlocks, param.pagesInBlock}));
-
-    if (!ret.second) {
-      panic("Failed to insert new mapping");
-    }
-
-    mappingList = ret.first;
+    // Entries of unmapped LPN are already empty
+    setMapped(req.lpn, true);
   }
 
   // mjo: Step 2: Write data to new page(s)
 
   // Write data to free block
+  // Host writes go to pSLC region first, and to normal blocks when it is full
   // mjo: Get a free block from the free block list.
-  block = blocks.find(getLastFreeBlock(req.ioFlag)); // mjo: <ppn of the block, Block instance>
+  uint32_t blockIndex = param.totalPhysicalBlocks;
+  bool slc = false;
+  bool critical = false;
 
-  if (block == blocks.end()) {
-    panic("No such block");
+  if (nSLCBlocks > 0 && sendToPAL) {
+    blockIndex = getLastSLCBlock();
+    slc = blockIndex < param.totalPhysicalBlocks;
   }
 
-  if (sendToPAL) {
-    if (bRandomTweak) {
-      pDRAM->read(&(*mappingList), 8 * req.ioFlag.count(), tick);
-      pDRAM->write(&(*mappingList), 8 * req.ioFlag.count(), tick);
+  if (!slc) {
+    blockIndex = getLastFreeBlock(req.ioFlag, getFrontier(stream));
+
+    // Small host writes are latency-critical
+    if (bPlacement && sendToPAL) {
+      critical = (req.hostLength > 0 && req.hostLength < param.pageSize) ||
+                 isLatencyCritical(req.lpn);
+      blockIndex = placeByPageType(blockIndex, req.ioFlag, critical);
+    }
+  }
+
+  block = blocks.find(blockIndex); // mjo: <ppn of the block, Block instance>
+
+  if (block == blocks.end()) {
+    panic("No such block");
+  }
+
+  if (sendToPAL) {
+    if (bRandomTweak) {
+      pDRAM->read(mappingList, 8 * req.ioFlag.count(), tick);
+      pDRAM->write(mappingList, 8 * req.ioFlag.count(), tick);
     }
     else {
-      pDRAM->read(&(*mappingList), 8, tick);
-      pDRAM->write(&(*mappingList), 8, tick);
+      pDRAM->read(mappingList, 8, tick);
+      pDRAM->write(mappingList, 8, tick);
     }
   }
 
@@ -773,11 +1250,35 @@ void PageMapping::writeInternal(Request &req, uint64_t &tick, bool sendToPAL) {
     if (req.ioFlag.test(idx) || !bRandomTweak) {
       // mjo: Use empty page in the same block instead of get a page from another block.
       uint32_t pageIndex = block->second.getNextWritePageIndex(idx);
-      auto &mapping = mappingList->second.at(idx);
+      auto &mapping = mappingList[idx];
 
       beginAt = tick;
 
       block->second.write(pageIndex, req.lpn, idx, beginAt);
+      victims.increase(block->first);
+
+      // Metadata pages are written by FTL itself, not by host
+      if (req.lpn < status.totalLogicalPages) {
+        streamWrites[stream]++;
+      }
+      else {
+        metaWrites++;
+      }
+
+      if (slc) {
+        slcStat.pageWrites++;
+      }
+      else if (nSLCBlocks > 0 && sendToPAL) {
+        slcStat.directPageWrites++;
+      }
+
+      if (critical) {
+        placementStat.criticalPageWrites++;
+
+        if (getPageType(block->first, pageIndex) == PAL::PAGE_TYPE_LSB) {
+          placementStat.fastPageWrites++;
+        }
+      }
 
       // Read old data if needed (Only executed when bRandomTweak = false)
       // Maybe some other init procedures want to perform 'partial-write'
@@ -785,6 +1286,7 @@ void PageMapping::writeInternal(Request &req, uint64_t &tick, bool sendToPAL) {
       if (readBeforeWrite && sendToPAL) {
         palRequest.blockIndex = mapping.first;
         palRequest.pageIndex = mapping.second;
+        palRequest.slc = isSLCBlock(mapping.first);
 
         // We don't need to read old data
         palRequest.ioFlag = req.ioFlag;
@@ -800,6 +1302,7 @@ void PageMapping::writeInternal(Request &req, uint64_t &tick, bool sendToPAL) {
       if (sendToPAL) {
         palRequest.blockIndex = block->first;
         palRequest.pageIndex = pageIndex;
+        palRequest.slc = slc;
 
         if (bRandomTweak) {
           palRequest.ioFlag.reset();
@@ -816,6 +1319,22 @@ void PageMapping::writeInternal(Request &req, uint64_t &tick, bool sendToPAL) {
     }
   }
 
+  // Full pSLC block waits for folding instead of GC
+  if (slc) {
+    if (block->second.getNextWritePageIndex() == slcPagesInBlock) {
+      slcFullBlocks.push_back(block->first);
+      slcLastFreeBlock.at(convertBlockIdx(block->first)) =
+          param.totalPhysicalBlocks;
+    }
+  }
+  else if (block->second.getNextWritePageIndex() == param.pagesInBlock) {
+    victims.insert(block->first, block->second.getLastAccessedTime());
+
+    if (bStaticWL) {
+      coldBlocks.emplace(block->second.getEraseCount(), block->first);
+    }
+  }
+
   // Exclude CPU operation when initializing
   if (sendToPAL) {
     tick = finishedAt;
@@ -824,8 +1343,13 @@ void PageMapping::writeInternal(Request &req, uint64_t &tick, bool sendToPAL) {
 
   // GC if needed
   // I assumed that init procedure never invokes GC
+  static const GC_MODE gcMode = (GC_MODE)conf.readInt(CONFIG_FTL, FTL_GC_MODE);
   static float gcThreshold = conf.readFloat(CONFIG_FTL, FTL_GC_THRESHOLD_RATIO);
 
+  if (gcMode == GC_MODE_2 && sendToPAL) {
+    incrementalGC(tick);
+  }
+
   if (freeBlockRatio() < gcThreshold) {
     if (!sendToPAL) {
       panic("ftl: GC triggered while in initialization");
@@ -848,22 +1372,266 @@ void PageMapping::writeInternal(Request &req, uint64_t &tick, bool sendToPAL) {
     stat.gcCount++;
     stat.reclaimedBlocks += list.size();
   }
+
+  if (bStaticWL && sendToPAL) {
+    staticWearLeveling(tick, bRandomTweak ? req.ioFlag.count() : 1);
+  }
+}
+
+// Relocate a few valid pages of one victim block after host write
+// Number of pages grows linearly from one page at GCReclaimThreshold (high
+// watermark) to whole block at GCThreshold (low watermark). Below low
+// watermark, on-demand GC reclaims blocks as GC_MODE_0 does.
+void PageMapping::incrementalGC(uint64_t &tick) {
+  static float low = conf.readFloat(CONFIG_FTL, FTL_GC_THRESHOLD_RATIO);
+  static float high = conf.readFloat(CONFIG_FTL, FTL_GC_RECLAIM_THRESHOLD);
+  std::vector<uint32_t> list;
+  float ratio = freeBlockRatio();
+
+  // Translation page writes of DFTL come back here during GC
+  if (ratio >= high || bInIncrementalGC) {
+    return;
+  }
+
+  if (gcVictim == param.totalPhysicalBlocks) {
+    selectVictimBlock(list, tick, 1);
+
+    if (list.size() == 0) {
+      return;
+    }
+
+    gcVictim = list.front();
+  }
+  else {
+    list.push_back(gcVictim);
+  }
+
+  float pressure = MIN((high - ratio) / (high - low), 1.f);
+  uint32_t pages = 1 + (uint32_t)(pressure * (param.pagesInBlock - 1));
+  uint64_t beginAt = tick;
+
+  bInIncrementalGC = true;
+  doGarbageCollection(list, tick, pages);
+  bInIncrementalGC = false;
+
+  debugprint(LOG_FTL_PAGE_MAPPING,
+             "GC   | Incremental | %u pages | %" PRIu64 " - %" PRIu64
+             " (%" PRIu64 ")",
+             pages, beginAt, tick, tick - beginAt);
+
+  stat.gcCount++;
+
+  // Victim is erased when it has no valid page
+  if (gcVictim == param.totalPhysicalBlocks) {
+    stat.reclaimedBlocks++;
+  }
+}
+
+// Host writes earn budget to migrate cold block. Erase count spread is
+// checked when budget covers one full block, and the budget is dropped if
+// spread is below threshold.
+void PageMapping::staticWearLeveling(uint64_t &tick, uint32_t pages) {
+  static uint64_t threshold = conf.readUint(CONFIG_FTL, FTL_SWL_THRESHOLD);
+  static float budget = conf.readFloat(CONFIG_FTL, FTL_SWL_BUDGET);
+  std::vector<uint32_t> list;
+  uint32_t coldBlock;
+  uint32_t minEraseCount;
+  uint32_t maxEraseCount;
+
+  // Translation page writes of DFTL come back here during migration
+  if (bInWearLeveling) {
+    return;
+  }
+
+  wlCredit += budget * pages;
+
+  if (wlCredit < param.pagesInBlock * bitsetSize) {
+    return;
+  }
+
+  maxEraseCount = eraseCountDist.getMax();
+
+  // Cold data stays in fully written block which is rarely erased
+  if (coldBlocks.empty() ||
+      maxEraseCount - coldBlocks.begin()->first < threshold) {
+    wlCredit = 0.f;
+
+    return;
+  }
+
+  minEraseCount = coldBlocks.begin()->first;
+  coldBlock = coldBlocks.begin()->second;
+
+  uint64_t beginAt = tick;
+
+  wlCredit -= victims.getValidCount(coldBlock);
+  list.push_back(coldBlock);
+
+  bInWearLeveling = true;
+  doGarbageCollection(list, tick);
+  bInWearLeveling = false;
+
+  debugprint(LOG_FTL_PAGE_MAPPING,
+             "SWL  | Block %u (erased %u, max %u) | %" PRIu64 " - %" PRIu64
+             " (%" PRIu64 ")",
+             coldBlock, minEraseCount, maxEraseCount, beginAt, tick,
+             tick - beginAt);
+
+  wlStat.gcCount++;
+  wlStat.reclaimedBlocks++;
+}
+
+// Erase counts are not saved, as each block has its own
+void PageMapping::rebuildEraseCountIndex() {
+  eraseCountDist.clear();
+  coldBlocks.clear();
+
+  for (auto &iter : blocks) {
+    eraseCountDist.insert(iter.second.getEraseCount());
+
+    if (victims.isCandidate(iter.first)) {
+      coldBlocks.emplace(iter.second.getEraseCount(), iter.first);
+    }
+  }
+
+  for (auto &pool : freeBlocks) {
+    for (auto &bucket : pool) {
+      eraseCountDist.insert(bucket.first, bucket.second.size());
+    }
+  }
+
+  for (auto &pool : slcFreeBlocks) {
+    for (auto &block : pool) {
+      eraseCountDist.insert(block.getEraseCount());
+    }
+  }
+}
+
+// Host I/O cancels pending background GC step
+// Step already issued to PAL cannot be stopped, so host I/O arrived before it
+// finishes still waits for it.
+void PageMapping::preemptBackgroundGC(uint64_t tick) {
+  if (!bBackgroundGC && nSLCBlocks == 0) {
+    return;
+  }
+
+  if (scheduled(bgcEvent)) {
+    deschedule(bgcEvent);
+  }
+
+  if (bgcFinishedAt > tick) {
+    bgcPreemptions++;
+    bgcFinishedAt = 0;
+
+    debugprint(LOG_FTL_PAGE_MAPPING,
+               "BGC  | Preempted by host I/O at %" PRIu64, tick);
+  }
+}
+
+// Start background GC when device stays idle for idle time
+void PageMapping::scheduleBackgroundGC(uint64_t tick) {
+  static uint64_t idleTime = conf.readUint(CONFIG_FTL, FTL_BGC_IDLE_TIME);
+
+  if (!bBackgroundGC && nSLCBlocks == 0) {
+    return;
+  }
+
+  lastIOFinishedAt = MAX(lastIOFinishedAt, tick);
+
+  if (scheduled(bgcEvent)) {
+    deschedule(bgcEvent);
+  }
+
+  schedule(bgcEvent, lastIOFinishedAt + idleTime);
+}
+
+// Fold one pSLC block or reclaim one block, and schedule next one until all
+// full pSLC blocks are folded and free block ratio reaches threshold of
+// background GC
+void PageMapping::backgroundGC(uint64_t tick) {
+  static float threshold = conf.readFloat(CONFIG_FTL, FTL_BGC_THRESHOLD_RATIO);
+  static float gcThreshold = conf.readFloat(CONFIG_FTL, FTL_GC_THRESHOLD_RATIO);
+  std::vector<uint32_t> list;
+  uint64_t beginAt = MAX(tick, bgcFinishedAt);
+
+  // Folding consumes free blocks, so reclaim blocks first when they run low
+  if (slcFullBlocks.size() > 0 && freeBlockRatio() >= gcThreshold) {
+    foldSLCBlock(beginAt);
+
+    bgcFinishedAt = beginAt;
+
+    schedule(bgcEvent, beginAt);
+
+    return;
+  }
+
+  if (slcFullBlocks.empty() &&
+      (!bBackgroundGC || freeBlockRatio() >= threshold)) {
+    return;
+  }
+
+  selectVictimBlock(list, beginAt, 1);
+
+  if (list.size() == 0) {
+    return;
+  }
+
+  debugprint(LOG_FTL_PAGE_MAPPING,
+             "BGC  | Idle | %u blocks will be reclaimed", list.size());
+
+  bInBackgroundGC = true;
+  doGarbageCollection(list, beginAt);
+  bInBackgroundGC = false;
+
+  debugprint(LOG_FTL_PAGE_MAPPING,
+             "BGC  | Done | %" PRIu64 " - %" PRIu64 " (%" PRIu64 ")", tick,
+             beginAt, beginAt - tick);
+
+  bgcStat.gcCount++;
+  bgcStat.reclaimedBlocks += list.size();
+  bgcFinishedAt = beginAt;
+
+  schedule(bgcEvent, beginAt);
+}
+
+// Relocate valid pages of the oldest full pSLC block to normal blocks
+void PageMapping::foldSLCBlock(uint64_t &tick) {
+  std::vector<uint32_t> list(1, slcFullBlocks.front());
+  uint64_t beginAt = tick;
+
+  bInFolding = true;
+  doGarbageCollection(list, tick);
+  bInFolding = false;
+
+  debugprint(LOG_FTL_PAGE_MAPPING,
+             "FOLD | Block %u | %" PRIu64 " - %" PRIu64 " (%" PRIu64 ")",
+             list.front(), beginAt, tick, tick - beginAt);
+
+  foldStat.gcCount++;
+  foldStat.reclaimedBlocks++;
 }
 
 void PageMapping::trimInternal(Request &req, uint64_t &tick) {
-  auto mappingList = table.find(req.lpn);
+  auto mappingList = getMappingList(req.lpn);
 
-  if (mappingList != table.end()) {
+  if (isMapped(req.lpn)) {
     if (bRandomTweak) {
-      pDRAM->read(&(*mappingList), 8 * req.ioFlag.count(), tick);
+      pDRAM->read(mappingList, 8 * req.ioFlag.count(), tick);
     }
     else {
-      pDRAM->read(&(*mappingList), 8, tick);
+      pDRAM->read(mappingList, 8, tick);
     }
 
     // Do trim
     for (uint32_t idx = 0; idx < bitsetSize; idx++) {
-      auto &mapping = mappingList->second.at(idx);
+      auto &mapping = mappingList[idx];
+
+      // Partially written LPN may have empty entries
+      if (mapping.first >= param.totalPhysicalBlocks ||
+          mapping.second >= param.pagesInBlock) {
+        continue;
+      }
+
       auto block = blocks.find(mapping.first);
 
       if (block == blocks.end()) {
@@ -871,15 +1639,81 @@ void PageMapping::trimInternal(Request &req, uint64_t &tick) {
       }
 
       block->second.invalidate(mapping.second, idx);
+      victims.decrease(mapping.first);
+
+      mapping = {param.totalPhysicalBlocks, param.pagesInBlock};
     }
 
     // Remove mapping
-    table.erase(mappingList);
+    setMapped(req.lpn, false);
 
     tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::TRIM_INTERNAL);
   }
 }
 
+// Unmap LPNs in [lpnBegin, lpnEnd), and collect blocks which had their pages
+// Words of bitmap without mapped LPN are skipped, and valid page count is
+// updated once for each run of pages in the same block.
+void PageMapping::invalidateRange(uint64_t lpnBegin, uint64_t lpnEnd,
+                                  std::vector<uint32_t> &list) {
+  uint32_t runBlock = param.totalPhysicalBlocks;
+  uint32_t runCount = 0;
+  Block *block = nullptr;
+
+  for (uint64_t lpn = lpnBegin; lpn < lpnEnd; lpn++) {
+    if (mappedLPNs[lpn / 64] == 0) {
+      lpn = lpn / 64 * 64 + 63;
+
+      continue;
+    }
+
+    if (!isMapped(lpn)) {
+      continue;
+    }
+
+    auto mappingList = getMappingList(lpn);
+
+    for (uint32_t idx = 0; idx < bitsetSize; idx++) {
+      auto &mapping = mappingList[idx];
+
+      // Partially written LPN may have empty entries
+      if (mapping.first >= param.totalPhysicalBlocks ||
+          mapping.second >= param.pagesInBlock) {
+        continue;
+      }
+
+      if (mapping.first != runBlock) {
+        auto iter = blocks.find(mapping.first);
+
+        if (iter == blocks.end()) {
+          panic("Block is not in use");
+        }
+
+        if (runCount > 0) {
+          victims.decrease(runBlock, runCount);
+        }
+
+        runBlock = mapping.first;
+        runCount = 0;
+        block = &iter->second;
+
+        list.push_back(runBlock);
+      }
+
+      block->invalidate(mapping.second, idx);
+      runCount++;
+
+      mapping = {param.totalPhysicalBlocks, param.pagesInBlock};
+    }
+
+    setMapped(lpn, false);
+  }
+
+  if (runCount > 0) {
+    victims.decrease(runBlock, runCount);
+  }
+}
+
 void PageMapping::eraseInternal(PAL::Request &req, uint64_t &tick) {
   static uint64_t threshold =
       conf.readUint(CONFIG_FTL, FTL_BAD_BLOCK_THRESHOLD);
@@ -894,44 +1728,695 @@ void PageMapping::eraseInternal(PAL::Request &req, uint64_t &tick) {
     panic("There are valid pages in victim block");
   }
 
+  if (bStaticWL) {
+    coldBlocks.erase({block->second.getEraseCount(), req.blockIndex});
+  }
+
   // Erase block
   block->second.erase();
+  victims.erase(req.blockIndex);
+
+  req.slc = isSLCBlock(req.blockIndex);
 
   pPAL->erase(req, tick);
 
   // Check erase count
   uint32_t erasedCount = block->second.getEraseCount();
+  uint32_t unit = convertBlockIdx(req.blockIndex);
 
-  if (erasedCount < threshold) {
-    // Reverse search
-    auto iter = freeBlocks.end();
-
-    while (true) {
-      iter--;
+  // Retired block is not counted in erase count spread
+  if (bStaticWL) {
+    if (erasedCount < threshold) {
+      eraseCountDist.increase(erasedCount - 1);
+    }
+    else {
+      eraseCountDist.erase(erasedCount - 1);
+    }
+  }
 
-      if (iter->getEraseCount() <= erasedCount) {
-        // emplace: insert before pos
-        iter++;
+  if (req.slc) {
+    // pSLC block returns to pSLC region
+    if (erasedCount < threshold) {
+      slcFreeBlocks.at(unit).emplace_back(std::move(block->second));
+      nSLCFreeBlocks++;
+    }
 
-        break;
-      }
+    slcFullBlocks.remove(req.blockIndex);
 
-      if (iter == freeBlocks.begin()) {
-        break;
-      }
+    // Trimmed open block can be erased by format
+    if (slcLastFreeBlock.at(unit) == req.blockIndex) {
+      slcLastFreeBlock.at(unit) = param.totalPhysicalBlocks;
     }
-
+  }
+  else if (erasedCount < threshold) {
     // Insert block to free block list
-    freeBlocks.emplace(iter, std::move(block->second));
-    nFreeBlocks++;
+    freeBlocks.insert(unit, std::move(block->second));
   }
 
   // Remove block from block list
   blocks.erase(block);
 
+  if (req.blockIndex == gcVictim) {
+    gcVictim = param.totalPhysicalBlocks;
+  }
+
+  // Full block can be reclaimed before its write frontier moves on
+  for (auto &frontier : frontiers) {
+    replaceOpenBlock(frontier, req.blockIndex);
+  }
+
+  replaceOpenBlock(wlFrontier, req.blockIndex);
+  replaceOpenBlock(fastFrontier, req.blockIndex);
+
   tick += applyLatency(CPU::FTL__PAGE_MAPPING, CPU::ERASE_INTERNAL);
 }
 
+// Allocate new open block if erased block is open block of frontier
+void PageMapping::replaceOpenBlock(WriteFrontier &frontier,
+                                   uint32_t blockIndex) {
+  for (uint32_t i = 0; i < frontier.lastFreeBlock.size(); i++) {
+    if (frontier.lastFreeBlock.at(i) == blockIndex) {
+      frontier.lastFreeBlock.at(i) = getFreeBlock(i, frontier.worn);
+    }
+  }
+}
+
+// Returns parallel unit of next write, same as getLastFreeBlock() does
+// with fully set I/O map
+// Initial data is written once, so it goes to cold stream
+uint32_t PageMapping::getFillStartIndex() {
+  auto &frontier = getFrontier(STREAM_HOST_COLD);
+  uint32_t index = frontier.lastFreeBlockIndex;
+
+  if (!bRandomTweak || frontier.lastFreeBlockIOMap.any()) {
+    index++;
+
+    if (index == param.pageCountToMaxPerf) {
+      index = 0;
+    }
+  }
+
+  return index;
+}
+
+// Write whole superpage of LPN to free block of given parallel unit
+// This is writeInternal() without DRAM, PAL and CPU, used in initialization
+// cache holds free block of each parallel unit to skip lookup of blocks
+void PageMapping::fillPage(uint32_t index, uint64_t lpn,
+                           std::vector<Block *> &cache) {
+  static float gcThreshold = conf.readFloat(CONFIG_FTL, FTL_GC_THRESHOLD_RATIO);
+  auto &lastFreeBlock = getFrontier(STREAM_HOST_COLD).lastFreeBlock;
+  auto mappingList = getMappingList(lpn);
+
+  if (isMapped(lpn)) {
+    for (uint32_t idx = 0; idx < bitsetSize; idx++) {
+      auto &mapping = mappingList[idx];
+
+      if (mapping.first < param.totalPhysicalBlocks &&
+          mapping.second < param.pagesInBlock) {
+        increaseWriteCount(mapping.first, mapping.second);
+
+        blocks.at(mapping.first).invalidate(mapping.second, idx);
+        victims.decrease(mapping.first);
+      }
+    }
+  }
+  else {
+    setMapped(lpn, true);
+  }
+
+  Block *block = cache.at(index);
+
+  if (block == nullptr) {
+    block = &blocks.at(lastFreeBlock.at(index));
+  }
+
+  if (block->getNextWritePageIndex() == param.pagesInBlock) {
+    lastFreeBlock.at(index) = getFreeBlock(index);
+    bReclaimMore = true;
+
+    if (freeBlockRatio() < gcThreshold) {
+      panic("ftl: GC triggered while in initialization");
+    }
+
+    block = &blocks.at(lastFreeBlock.at(index));
+  }
+
+  cache.at(index) = block;
+
+  uint32_t blockIndex = block->getBlockIndex();
+
+  for (uint32_t idx = 0; idx < bitsetSize; idx++) {
+    uint32_t pageIndex = block->getNextWritePageIndex(idx);
+
+    block->write(pageIndex, lpn, idx, 0);
+    victims.increase(blockIndex);
+
+    mappingList[idx] = {blockIndex, pageIndex};
+  }
+
+  if (block->getNextWritePageIndex() == param.pagesInBlock) {
+    victims.insert(blockIndex, 0);
+
+    if (bStaticWL) {
+      coldBlocks.emplace(block->getEraseCount(), blockIndex);
+    }
+  }
+}
+
+// Write LPNs [lpnBegin, lpnBegin + count) in order
+// k-th LPN goes to (start + k)-th parallel unit, and parallel units never
+// share blocks, so we can fill blocks of each parallel unit at once.
+// Write metadata pages of filled drive. Page mapping has no metadata page.
+void PageMapping::fillMetadata() {}
+
+void PageMapping::fillSequential(uint64_t lpnBegin, uint64_t count) {
+  auto &frontier = getFrontier(STREAM_HOST_COLD);
+  uint32_t start = getFillStartIndex();
+  uint32_t nUnits = param.pageCountToMaxPerf;
+  std::vector<Block *> cache(nUnits, nullptr);
+
+  if (count == 0) {
+    return;
+  }
+
+  for (uint32_t i = 0; i < nUnits && i < count; i++) {
+    uint32_t index = (start + i) % nUnits;
+
+    for (uint64_t k = i; k < count; k += nUnits) {
+      fillPage(index, lpnBegin + k, cache);
+    }
+  }
+
+  frontier.lastFreeBlockIndex = (start + count - 1) % nUnits;
+  frontier.lastFreeBlockIOMap.set();
+}
+
+// Write count random LPNs in [0, lpnRange)
+// LPN can be written more than once, so keep the order of writes
+void PageMapping::fillRandom(uint64_t count, uint64_t lpnRange,
+                             std::mt19937_64 &gen) {
+  const uint64_t batchSize = 65536;
+  std::uniform_int_distribution<uint64_t> dist(0, lpnRange - 1);
+  std::vector<uint64_t> batch;
+  std::vector<Block *> cache(param.pageCountToMaxPerf, nullptr);
+  auto &frontier = getFrontier(STREAM_HOST_COLD);
+  uint32_t index = getFillStartIndex();
+
+  if (count == 0 || lpnRange == 0) {
+    return;
+  }
+
+  batch.reserve(MIN(count, batchSize));
+
+  for (uint64_t i = 0; i < count; i += batchSize) {
+    batch.clear();
+
+    for (uint64_t k = i; k < count && k < i + batchSize; k++) {
+      batch.push_back(dist(gen));
+    }
+
+    for (auto &lpn : batch) {
+      fillPage(index, lpn, cache);
+
+      index++;
+
+      if (index == param.pageCountToMaxPerf) {
+        index = 0;
+      }
+    }
+  }
+
+  frontier.lastFreeBlockIndex =
+      (index + param.pageCountToMaxPerf - 1) % param.pageCountToMaxPerf;
+  frontier.lastFreeBlockIOMap.set();
+}
+
+bool PageMapping::loadSnapshot(std::string path) {
+  FILE *file = fopen(path.c_str(), "rb");
+  SnapshotHeader header;
+  std::vector<uint8_t> data;
+  uint64_t length;
+  uint8_t state;
+
+  if (file == nullptr) {
+    return false;
+  }
+
+  readData(file, &header, sizeof(header));
+
+  if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+      header.version != SNAPSHOT_VERSION) {
+    panic("ftl: %s is not a snapshot of version %u", path.c_str(),
+          SNAPSHOT_VERSION);
+  }
+
+  if (header.bitsetSize != bitsetSize ||
+      header.totalPhysicalBlocks != param.totalPhysicalBlocks ||
+      header.totalLogicalBlocks != param.totalLogicalBlocks ||
+      header.pagesInBlock != param.pagesInBlock ||
+      header.ioUnitInPage != param.ioUnitInPage ||
+      header.pageCountToMaxPerf != param.pageCountToMaxPerf) {
+    panic("ftl: Snapshot %s does not match current configuration",
+          path.c_str());
+  }
+
+  seekSection(file, header, SNAPSHOT_TABLE, table.size() * sizeof(table[0]));
+  readData(file, table.data(), table.size() * sizeof(table[0]));
+
+  seekSection(file, header, SNAPSHOT_MAPPED_LPNS,
+              mappedLPNs.size() * sizeof(uint64_t));
+  readData(file, mappedLPNs.data(), mappedLPNs.size() * sizeof(uint64_t));
+
+  seekSection(file, header, SNAPSHOT_WRITE_COUNT,
+              writeCount.size() * sizeof(uint32_t));
+  readData(file, writeCount.data(), writeCount.size() * sizeof(uint32_t));
+
+  writeCountDist.clear();
+
+  for (auto &iter : writeCount) {
+    writeCountDist.insert(iter);
+  }
+
+  // Load all blocks to block list, loadState() moves free blocks to pools
+  seekSection(file, header, SNAPSHOT_BLOCKS,
+              std::numeric_limits<uint64_t>::max());
+
+  blocks.clear();
+
+  freeBlocks.clear();
+
+  for (auto &iter : slcFreeBlocks) {
+    iter.clear();
+  }
+
+  for (uint32_t i = 0; i < param.totalPhysicalBlocks; i++) {
+    readData(file, &state, sizeof(state));
+
+    if (state == BLOCK_RETIRED) {
+      continue;
+    }
+
+    readData(file, &length, sizeof(length));
+    data.resize(length);
+    readData(file, data.data(), length);
+
+    Block block(blockArena, i);
+
+    block.loadState(data);
+
+    if (data.size() != 0) {
+      panic("ftl: Snapshot has invalid block state");
+    }
+
+    blocks.emplace(i, std::move(block));
+  }
+
+  seekSection(file, header, SNAPSHOT_STATE,
+              std::numeric_limits<uint64_t>::max());
+
+  data.resize(header.length[SNAPSHOT_STATE]);
+  readData(file, data.data(), data.size());
+
+  loadState(data);
+
+  fclose(file);
+
+  return true;
+}
+
+void PageMapping::saveSnapshot(std::string path) {
+  FILE *file = fopen(path.c_str(), "wb");
+  SnapshotHeader header;
+  std::vector<uint8_t> data;
+  std::vector<Block *> freeBlockList(param.totalPhysicalBlocks, nullptr);
+  uint64_t length;
+  uint8_t state;
+
+  if (file == nullptr) {
+    panic("ftl: Failed to create snapshot %s", path.c_str());
+  }
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  header.version = SNAPSHOT_VERSION;
+  header.bitsetSize = bitsetSize;
+  header.totalPhysicalBlocks = param.totalPhysicalBlocks;
+  header.totalLogicalBlocks = param.totalLogicalBlocks;
+  header.pagesInBlock = param.pagesInBlock;
+  header.ioUnitInPage = param.ioUnitInPage;
+  header.pageCountToMaxPerf = param.pageCountToMaxPerf;
+
+  // Header will be rewritten after all sections are written
+  writeData(file, &header, sizeof(header));
+
+  beginSection(file, header, SNAPSHOT_TABLE);
+  writeData(file, table.data(), table.size() * sizeof(table[0]));
+  endSection(file, header, SNAPSHOT_TABLE);
+
+  beginSection(file, header, SNAPSHOT_MAPPED_LPNS);
+  writeData(file, mappedLPNs.data(), mappedLPNs.size() * sizeof(uint64_t));
+  endSection(file, header, SNAPSHOT_MAPPED_LPNS);
+
+  beginSection(file, header, SNAPSHOT_WRITE_COUNT);
+  writeData(file, writeCount.data(), writeCount.size() * sizeof(uint32_t));
+  endSection(file, header, SNAPSHOT_WRITE_COUNT);
+
+  for (auto &pool : freeBlocks) {
+    for (auto &bucket : pool) {
+      for (auto &block : bucket.second) {
+        freeBlockList.at(block.getBlockIndex()) = &block;
+      }
+    }
+  }
+
+  for (auto &pool : slcFreeBlocks) {
+    for (auto &block : pool) {
+      freeBlockList.at(block.getBlockIndex()) = &block;
+    }
+  }
+
+  beginSection(file, header, SNAPSHOT_BLOCKS);
+
+  for (uint32_t i = 0; i < param.totalPhysicalBlocks; i++) {
+    auto iter = blocks.find(i);
+    Block *block = nullptr;
+
+    if (iter != blocks.end()) {
+      state = BLOCK_IN_USE;
+      block = &iter->second;
+    }
+    else if (freeBlockList.at(i)) {
+      state = BLOCK_FREE;
+      block = freeBlockList.at(i);
+    }
+    else {
+      state = BLOCK_RETIRED;
+    }
+
+    writeData(file, &state, sizeof(state));
+
+    if (block) {
+      data.clear();
+      block->saveState(data);
+
+      length = data.size();
+
+      writeData(file, &length, sizeof(length));
+      writeData(file, data.data(), length);
+    }
+  }
+
+  endSection(file, header, SNAPSHOT_BLOCKS);
+
+  data.clear();
+  saveState(data);
+
+  beginSection(file, header, SNAPSHOT_STATE);
+  writeData(file, data.data(), data.size());
+  endSection(file, header, SNAPSHOT_STATE);
+
+  // Write header
+  if (fseek(file, 0, SEEK_SET) != 0) {
+    panic("ftl: Failed to write snapshot");
+  }
+
+  writeData(file, &header, sizeof(header));
+
+  fclose(file);
+}
+
+void PageMapping::saveState(std::vector<uint8_t> &data) {
+  bool bit;
+
+  // Free block pools, in allocation order
+  for (auto &pool : freeBlocks) {
+    for (auto &bucket : pool) {
+      for (auto &block : bucket.second) {
+        pushValue(data, block.getBlockIndex());
+      }
+
+      pushValue(data, (uint64_t)bucket.second.size());
+      pushValue(data, bucket.first);
+    }
+
+    pushValue(data, (uint64_t)pool.size());
+  }
+
+  pushValue(data, freeBlocks.getBlockCount());
+
+  // pSLC region
+  for (auto &pool : slcFreeBlocks) {
+    for (auto &block : pool) {
+      pushValue(data, block.getBlockIndex());
+    }
+
+    pushValue(data, (uint64_t)pool.size());
+  }
+
+  pushValue(data, nSLCFreeBlocks);
+  pushArray(data, slcLastFreeBlock.data(),
+            slcLastFreeBlock.size() * sizeof(uint32_t));
+  pushValue(data, slcLastFreeBlockIndex);
+
+  for (auto &iter : slcFullBlocks) {
+    pushValue(data, iter);
+  }
+
+  pushValue(data, (uint64_t)slcFullBlocks.size());
+  pushValue(data, slcStat);
+  pushValue(data, foldStat);
+  pushValue(data, nSLCBlocks);
+
+  // Static wear-leveling
+  if (bStaticWL) {
+    pushArray(data, wlFrontier.lastFreeBlock.data(),
+              wlFrontier.lastFreeBlock.size() * sizeof(uint32_t));
+
+    for (uint32_t i = 0; i < param.ioUnitInPage; i++) {
+      bit = wlFrontier.lastFreeBlockIOMap.test(i);
+      pushValue(data, bit);
+    }
+
+    pushValue(data, wlFrontier.lastFreeBlockIndex);
+  }
+
+  pushValue(data, wlCredit);
+  pushValue(data, wlStat);
+  pushValue(data, bStaticWL);
+
+  // Page type aware placement
+  if (bPlacement) {
+    pushArray(data, fastFrontier.lastFreeBlock.data(),
+              fastFrontier.lastFreeBlock.size() * sizeof(uint32_t));
+    pushArray(data, readCount.data(), readCount.size());
+    pushValue(data, reads);
+  }
+
+  pushValue(data, placementStat);
+  pushValue(data, bPlacement);
+
+  // Write frontiers
+  for (auto &frontier : frontiers) {
+    pushArray(data, frontier.lastFreeBlock.data(),
+              frontier.lastFreeBlock.size() * sizeof(uint32_t));
+
+    for (uint32_t i = 0; i < param.ioUnitInPage; i++) {
+      bit = frontier.lastFreeBlockIOMap.test(i);
+      pushValue(data, bit);
+    }
+
+    pushValue(data, frontier.lastFreeBlockIndex);
+  }
+
+  pushValue(data, bReclaimMore);
+
+  pushValue(data, nMappedLPNs);
+  pushValue(data, stat);
+  pushValue(data, bgcStat);
+  pushValue(data, bgcPreemptions);
+  pushArray(data, streamWrites, sizeof(streamWrites));
+  pushValue(data, metaWrites);
+
+  victims.saveState(data);
+
+  // Frontiers and classifier state depend on write stream mode
+  if (pClassifier) {
+    pClassifier->saveState(data);
+  }
+
+  pushValue(data, (uint32_t)conf.readInt(CONFIG_FTL, FTL_STREAM_MODE));
+}
+
+// All blocks should be in block list before calling this function
+void PageMapping::loadState(std::vector<uint8_t> &data) {
+  uint64_t poolSize;
+  uint64_t listSize;
+  uint32_t eraseCount;
+  uint32_t blockIndex;
+  uint32_t freeBlockCount;
+  uint32_t streamMode;
+  uint32_t slcBlocks;
+  bool staticWL;
+  bool placement;
+  bool bit;
+
+  popValue(data, streamMode);
+
+  if (streamMode != (uint32_t)conf.readInt(CONFIG_FTL, FTL_STREAM_MODE)) {
+    panic("ftl: Snapshot has different write stream mode");
+  }
+
+  if (pClassifier) {
+    pClassifier->loadState(data);
+  }
+
+  victims.loadState(data);
+
+  popValue(data, metaWrites);
+  popArray(data, streamWrites, sizeof(streamWrites));
+  popValue(data, bgcPreemptions);
+  popValue(data, bgcStat);
+  popValue(data, stat);
+  popValue(data, nMappedLPNs);
+
+  popValue(data, bReclaimMore);
+
+  for (auto frontier = frontiers.rbegin(); frontier != frontiers.rend();
+       frontier++) {
+    popValue(data, frontier->lastFreeBlockIndex);
+
+    for (uint32_t i = param.ioUnitInPage; i > 0; i--) {
+      popValue(data, bit);
+      frontier->lastFreeBlockIOMap.set(i - 1, bit);
+    }
+
+    popArray(data, frontier->lastFreeBlock.data(),
+             frontier->lastFreeBlock.size() * sizeof(uint32_t));
+  }
+
+  popValue(data, placement);
+
+  if (placement != bPlacement) {
+    panic("ftl: Snapshot has different page type aware placement setting");
+  }
+
+  popValue(data, placementStat);
+
+  if (bPlacement) {
+    popValue(data, reads);
+    popArray(data, readCount.data(), readCount.size());
+    popArray(data, fastFrontier.lastFreeBlock.data(),
+             fastFrontier.lastFreeBlock.size() * sizeof(uint32_t));
+  }
+
+  popValue(data, staticWL);
+
+  if (staticWL != bStaticWL) {
+    panic("ftl: Snapshot has different static wear-leveling setting");
+  }
+
+  popValue(data, wlStat);
+  popValue(data, wlCredit);
+
+  if (bStaticWL) {
+    popValue(data, wlFrontier.lastFreeBlockIndex);
+
+    for (uint32_t i = param.ioUnitInPage; i > 0; i--) {
+      popValue(data, bit);
+      wlFrontier.lastFreeBlockIOMap.set(i - 1, bit);
+    }
+
+    popArray(data, wlFrontier.lastFreeBlock.data(),
+             wlFrontier.lastFreeBlock.size() * sizeof(uint32_t));
+  }
+
+  popValue(data, slcBlocks);
+
+  if (slcBlocks != nSLCBlocks) {
+    panic("ftl: Snapshot has different SLC write cache size");
+  }
+
+  popValue(data, foldStat);
+  popValue(data, slcStat);
+  popValue(data, listSize);
+
+  slcFullBlocks.clear();
+
+  for (uint64_t i = 0; i < listSize; i++) {
+    popValue(data, blockIndex);
+    slcFullBlocks.push_front(blockIndex);
+  }
+
+  popValue(data, slcLastFreeBlockIndex);
+  popArray(data, slcLastFreeBlock.data(),
+           slcLastFreeBlock.size() * sizeof(uint32_t));
+  popValue(data, nSLCFreeBlocks);
+
+  for (uint32_t idx = param.pageCountToMaxPerf; idx > 0; idx--) {
+    auto &pool = slcFreeBlocks.at(idx - 1);
+
+    popValue(data, listSize);
+
+    for (uint64_t i = 0; i < listSize; i++) {
+      popValue(data, blockIndex);
+
+      auto block = blocks.find(blockIndex);
+
+      if (block == blocks.end()) {
+        panic("ftl: Snapshot has invalid free block list");
+      }
+
+      pool.emplace_front(std::move(block->second));
+      blocks.erase(block);
+    }
+  }
+
+  popValue(data, freeBlockCount);
+
+  for (uint32_t idx = param.pageCountToMaxPerf; idx > 0; idx--) {
+    popValue(data, poolSize);
+
+    for (uint64_t i = 0; i < poolSize; i++) {
+      popValue(data, eraseCount);
+      popValue(data, listSize);
+
+      for (uint64_t j = 0; j < listSize; j++) {
+        popValue(data, blockIndex);
+
+        auto block = blocks.find(blockIndex);
+
+        if (block == blocks.end() ||
+            block->second.getEraseCount() != eraseCount) {
+          panic("ftl: Snapshot has invalid free block list");
+        }
+
+        freeBlocks.insert(idx - 1, std::move(block->second), true);
+        blocks.erase(block);
+      }
+    }
+  }
+
+  if (freeBlocks.getBlockCount() != freeBlockCount) {
+    panic("ftl: Snapshot has invalid free block list");
+  }
+
+  if (bStaticWL) {
+    rebuildEraseCountIndex();
+  }
+
+  if (data.size() != 0) {
+    panic("ftl: Snapshot has invalid state");
+  }
+}
+
+void PageMapping::increaseWriteCount(uint32_t blockIndex, uint32_t pageIndex) {
+  auto &count =
+      writeCount[(uint64_t)blockIndex * param.pagesInBlock + pageIndex];
+
+  writeCountDist.increase(count++);
+}
+
 float PageMapping::calculateWearLeveling() {
   uint64_t totalEraseCnt = 0;
   uint64_t sumOfSquaredEraseCnt = 0;
@@ -944,17 +2429,21 @@ float PageMapping::calculateWearLeveling() {
     sumOfSquaredEraseCnt += eraseCnt * eraseCnt;
   }
 
-  // freeBlocks is sorted
-  // Calculate from backward, stop when eraseCnt is zero
-  for (auto riter = freeBlocks.rbegin(); riter != freeBlocks.rend(); riter++) {
-    eraseCnt = riter->getEraseCount();
-
-    if (eraseCnt == 0) {
-      break;
+  // Free blocks are bucketed by erase count
+  for (auto &pool : freeBlocks) {
+    for (auto &bucket : pool) {
+      eraseCnt = bucket.first;
+      totalEraseCnt += eraseCnt * bucket.second.size();
+      sumOfSquaredEraseCnt += eraseCnt * eraseCnt * bucket.second.size();
     }
+  }
 
-    totalEraseCnt += eraseCnt;
-    sumOfSquaredEraseCnt += eraseCnt * eraseCnt;
+  for (auto &pool : slcFreeBlocks) {
+    for (auto &block : pool) {
+      eraseCnt = block.getEraseCount();
+      totalEraseCnt += eraseCnt;
+      sumOfSquaredEraseCnt += eraseCnt * eraseCnt;
+    }
   }
 
   if (sumOfSquaredEraseCnt == 0) {
@@ -965,6 +2454,33 @@ float PageMapping::calculateWearLeveling() {
          (numOfBlocks * sumOfSquaredEraseCnt);
 }
 
+// Retired blocks are excluded
+uint32_t PageMapping::calculateEraseCountSpread() {
+  uint32_t minCount = std::numeric_limits<uint32_t>::max();
+  uint32_t maxCount = 0;
+
+  for (auto &iter : blocks) {
+    minCount = MIN(minCount, iter.second.getEraseCount());
+    maxCount = MAX(maxCount, iter.second.getEraseCount());
+  }
+
+  for (auto &pool : freeBlocks) {
+    if (pool.size() > 0) {
+      minCount = MIN(minCount, pool.begin()->first);
+      maxCount = MAX(maxCount, pool.rbegin()->first);
+    }
+  }
+
+  for (auto &pool : slcFreeBlocks) {
+    for (auto &block : pool) {
+      minCount = MIN(minCount, block.getEraseCount());
+      maxCount = MAX(maxCount, block.getEraseCount());
+    }
+  }
+
+  return maxCount >= minCount ? maxCount - minCount : 0;
+}
+
 void PageMapping::calculateTotalPages(uint64_t &valid, uint64_t &invalid) {
   valid = 0;
   invalid = 0;
@@ -975,9 +2491,11 @@ void PageMapping::calculateTotalPages(uint64_t &valid, uint64_t &invalid) {
   }
 }
 
-static int K_for_k_mean = 5;
+// # of clusters of page write count distribution
+const uint32_t WRITE_COUNT_CLUSTERS = 5;
 
 void PageMapping::getStatList(std::vector<Stats> &list, std::string prefix) {
+  static const char pageType[PAL::PAGE_TYPE_NUM][4] = {"lsb", "csb", "msb"};
   Stats temp;
 
   temp.name = prefix + "page_mapping.gc.count";
@@ -996,6 +2514,66 @@ void PageMapping::getStatList(std::vector<Stats> &list, std::string prefix) {
   temp.desc = "Total copied valid pages during GC";
   list.push_back(temp);
 
+  temp.name = prefix + "page_mapping.bgc.count";
+  temp.desc = "Total background GC count";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.bgc.reclaimed_blocks";
+  temp.desc = "Total reclaimed blocks in background GC";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.bgc.superpage_copies";
+  temp.desc = "Total copied valid superpages during background GC";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.bgc.page_copies";
+  temp.desc = "Total copied valid pages during background GC";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.bgc.preemptions";
+  temp.desc = "Total background GC preempted by host I/O";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.slc.occupancy";
+  temp.desc = "Ratio of pSLC blocks in use";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.slc.page_writes";
+  temp.desc = "Total pages written to pSLC blocks";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.slc.direct_page_writes";
+  temp.desc = "Total host pages written to normal blocks as pSLC was full";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.slc.fold.count";
+  temp.desc = "Total folded pSLC blocks";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.slc.fold.page_copies";
+  temp.desc = "Total copied valid pages during folding";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.stream.host_hot.page_writes";
+  temp.desc = "Total pages written to hot host write stream";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.stream.host_cold.page_writes";
+  temp.desc = "Total pages written to cold host write stream";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.stream.gc.page_writes";
+  temp.desc = "Total pages written to GC write stream";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.meta.page_writes";
+  temp.desc = "Total pages written to FTL metadata";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.waf";
+  temp.desc = "Write amplification factor";
+  list.push_back(temp);
+
   // For the exact definition, see following paper:
   // Li, Yongkun, Patrick PC Lee, and John Lui.
   // "Stochastic modeling of large-scale solid-state storage systems: analysis,
@@ -1004,27 +2582,76 @@ void PageMapping::getStatList(std::vector<Stats> &list, std::string prefix) {
   temp.desc = "Wear-leveling factor";
   list.push_back(temp);
 
-  //for(uint64_t i = 0; i < write_cycle.size(); ++i) {
-  //    for(uint64_t j = 0; j < write_cycle[i].size(); ++j) {
-  //  	  char buf[1024];
-  //  	  snprintf(buf, 1024, "page_mapping.P/Ecycle.block%03lu.page%03lu", i, j);
-  //  	  temp.name = prefix + buf;
-  //  	  snprintf(buf, 1024, "Current P/E cycle at block %lu, page %lu", i, j);
-  //  	  temp.desc = buf;
-  //  	  list.push_back(temp);
-  //    }
-  //}
+  temp.name = prefix + "page_mapping.erase_count_spread";
+  temp.desc = "Difference of the most and the least erase count of blocks";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.static_wl.count";
+  temp.desc = "Total cold blocks migrated by static wear-leveling";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.static_wl.page_copies";
+  temp.desc = "Total copied valid pages during static wear-leveling";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.placement.critical_page_writes";
+  temp.desc = "Total pages of latency-critical data written";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.placement.fast_page_writes";
+  temp.desc = "Total pages of latency-critical data written to LSB pages";
+  list.push_back(temp);
+
+  // Distribution of read latency of each page type
+  for (uint32_t i = 0; i < PAL::PAGE_TYPE_NUM; i++) {
+    std::string name = prefix + "page_mapping.read." + pageType[i];
+
+    temp.name = name + ".count";
+    temp.desc = std::string("Total page reads of ") + pageType[i] + " pages";
+    list.push_back(temp);
+
+    temp.name = name + ".latency.mean";
+    temp.desc = "Mean of read latency in ns";
+    list.push_back(temp);
+
+    temp.name = name + ".latency.p99";
+    temp.desc = "99th percentile of read latency in ns";
+    list.push_back(temp);
+
+    temp.name = name + ".latency.max";
+    temp.desc = "Maximum of read latency in ns";
+    list.push_back(temp);
+  }
+
+  // Distribution of write count of all physical pages
   temp.name = prefix + "page_mapping.write-mean";
   temp.desc = "Mean of all pages' write counts";
   list.push_back(temp);
+
   temp.name = prefix + "page_mapping.write-standard-deviation";
   temp.desc = "Standard deviation of all pages' write counts";
   list.push_back(temp);
-  // TODO: Clustering..?
-  for(int i = 0; i < K_for_k_mean; ++i) {
-	  temp.name = prefix + "page_mapping.cluster_" + to_string(i);
-	  temp.desc = "Clustered centroid at cluster " + to_string(i);
-	  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.write-median";
+  temp.desc = "Median of all pages' write counts";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.write-p90";
+  temp.desc = "90th percentile of all pages' write counts";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.write-p99";
+  temp.desc = "99th percentile of all pages' write counts";
+  list.push_back(temp);
+
+  temp.name = prefix + "page_mapping.write-max";
+  temp.desc = "Maximum of all pages' write counts";
+  list.push_back(temp);
+
+  for (uint32_t i = 0; i < WRITE_COUNT_CLUSTERS; i++) {
+    temp.name = prefix + "page_mapping.cluster_" + std::to_string(i);
+    temp.desc = "Clustered centroid at cluster " + std::to_string(i);
+    list.push_back(temp);
   }
 }
 
@@ -1033,28 +2660,78 @@ void PageMapping::getStatValues(std::vector<double> &values) {
   values.push_back(stat.reclaimedBlocks);
   values.push_back(stat.validSuperPageCopies);
   values.push_back(stat.validPageCopies);
+  values.push_back(bgcStat.gcCount);
+  values.push_back(bgcStat.reclaimedBlocks);
+  values.push_back(bgcStat.validSuperPageCopies);
+  values.push_back(bgcStat.validPageCopies);
+  values.push_back(bgcPreemptions);
+  values.push_back(nSLCBlocks > 0
+                       ? (double)(nSLCBlocks - nSLCFreeBlocks) / nSLCBlocks
+                       : 0.);
+  values.push_back(slcStat.pageWrites);
+  values.push_back(slcStat.directPageWrites);
+  values.push_back(foldStat.gcCount);
+  values.push_back(foldStat.validPageCopies);
+
+  uint64_t hostWrites =
+      streamWrites[STREAM_HOST_HOT] + streamWrites[STREAM_HOST_COLD];
+  double waf = 0.;
+
+  if (hostWrites > 0) {
+    waf = (double)(hostWrites + streamWrites[STREAM_GC] + metaWrites) /
+          hostWrites;
+  }
+
+  values.push_back(streamWrites[STREAM_HOST_HOT]);
+  values.push_back(streamWrites[STREAM_HOST_COLD]);
+  values.push_back(streamWrites[STREAM_GC]);
+  values.push_back(metaWrites);
+  values.push_back(waf);
   values.push_back(calculateWearLeveling());
+  values.push_back(calculateEraseCountSpread());
+  values.push_back(wlStat.gcCount);
+  values.push_back(wlStat.validPageCopies);
+  values.push_back(placementStat.criticalPageWrites);
+  values.push_back(placementStat.fastPageWrites);
+
+  for (auto &iter : readLatency) {
+    uint64_t count = iter.dist.getCount();
+
+    values.push_back(count);
+    values.push_back(count > 0 ? (double)iter.sum / count : 0.);
+    values.push_back(iter.dist.getQuantile(0.99) * READ_LATENCY_BIN);
+    values.push_back(iter.max);
+  }
 
-  //for(uint64_t i = 0; i < write_cycle.size(); ++i) {
-  //    for(uint64_t j = 0; j < write_cycle[i].size(); ++j) {
-  //  	  values.push_back(write_cycle[i][j]);
-  //    }
-  //}
-  values.push_back(mean(write_cycle));
-  values.push_back(standard_deviation(write_cycle));
+  std::vector<double> centroids;
 
-  vector<int> flat = flatten(write_cycle);
+  values.push_back(writeCountDist.getMean());
+  values.push_back(writeCountDist.getStandardDeviation());
+  values.push_back(writeCountDist.getQuantile(0.5));
+  values.push_back(writeCountDist.getQuantile(0.9));
+  values.push_back(writeCountDist.getQuantile(0.99));
+  values.push_back(writeCountDist.getMax());
 
-  auto[clusters, centroids] = cluster(flat, K_for_k_mean);
-  (void) clusters; // unused
-  for(auto i : centroids){
-	  values.push_back(i);
-  }
+  writeCountDist.getCentroids(WRITE_COUNT_CLUSTERS, centroids);
+  values.insert(values.end(), centroids.begin(), centroids.end());
 }
 
 void PageMapping::resetStatValues() {
   memset(&stat, 0, sizeof(stat));
-  write_cycle.resize(param.totalPhysicalBlocks, vector<int>(param.pagesInBlock, 0));
+  memset(&bgcStat, 0, sizeof(bgcStat));
+  bgcPreemptions = 0;
+  memset(&slcStat, 0, sizeof(slcStat));
+  memset(&foldStat, 0, sizeof(foldStat));
+  memset(&wlStat, 0, sizeof(wlStat));
+  memset(&placementStat, 0, sizeof(placementStat));
+  memset(streamWrites, 0, sizeof(streamWrites));
+  metaWrites = 0;
+
+  for (auto &iter : readLatency) {
+    iter.sum = 0;
+    iter.max = 0;
+    iter.dist.clear();
+  }
 }
 
 }  // namespace FTL
@@ -21,64 +21,204 @@
 #define __FTL_PAGE_MAPPING__
 
 #include <cinttypes>
+#include <list>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "ftl/abstract_ftl.hh"
 #include "ftl/common/block.hh"
+#include "ftl/common/free_block_pool.hh"
+#include "ftl/common/stream_classifier.hh"
+#include "ftl/common/victim_index.hh"
 #include "ftl/ftl.hh"
 #include "pal/pal.hh"
+#include "sim/state.hh"
+#include "util/histogram.hh"
 
 namespace SimpleSSD {
 
 namespace FTL {
 
-class PageMapping : public AbstractFTL {
- private:
+class PageMapping : public AbstractFTL, public StateObject {
+ protected:
   PAL::PAL *pPAL;
 
   ConfigReader &conf;
 
-  std::unordered_map<uint64_t, std::vector<std::pair<uint32_t, uint32_t>>>
-      table;
+  bool bRandomTweak;
+  uint32_t bitsetSize;
+  uint64_t nMetaPages;  // Logical pages for FTL metadata, after user pages
+
+  // Flat L2P table. Mapping of (LPN, idx) is stored at
+  // lpn * bitsetSize + idx, and unmapped entry holds
+  // {totalPhysicalBlocks, pagesInBlock}.
+  std::vector<std::pair<uint32_t, uint32_t>> table;
+  std::vector<uint64_t> mappedLPNs;  // One bit per LPN
+  uint64_t nMappedLPNs;
+  BlockArena blockArena;  // Metadata of all blocks
   std::unordered_map<uint32_t, Block> blocks;
-  std::list<Block> freeBlocks;
-  uint32_t nFreeBlocks;  // For some libraries which std::list::size() is O(n)
-  std::vector<uint32_t> lastFreeBlock;
-  Bitset lastFreeBlockIOMap;
-  uint32_t lastFreeBlockIndex;
+  FreeBlockPool freeBlocks;
+  VictimIndex victims;
+
+  // Open blocks of write stream, one for each parallel unit
+  typedef struct {
+    std::vector<uint32_t> lastFreeBlock;
+    Bitset lastFreeBlockIOMap;
+    uint32_t lastFreeBlockIndex;
+    bool worn;  // Allocate the most erased free blocks
+  } WriteFrontier;
+
+  // All streams share one frontier when classifier is not used
+  StreamClassifier *pClassifier;
+  std::vector<WriteFrontier> frontiers;
+  uint64_t streamWrites[STREAM_COUNT];  // Written pages of each stream
+  uint64_t metaWrites;                  // Written pages of metadata LPNs
 
   bool bReclaimMore;
-  bool bRandomTweak;
-  uint32_t bitsetSize;
+  bool bCopyback;  // GC copies pages in the same plane by copyback
 
-  struct {
+  // Incremental GC (GC_MODE_2) drains one victim over multiple host writes
+  uint32_t gcVictim;  // totalPhysicalBlocks if no victim is being drained
+  bool bInIncrementalGC;
+
+  // Background GC runs after device is idle for a while, one block at a time
+  bool bBackgroundGC;
+  bool bInBackgroundGC;       // True while background GC step is running
+  uint64_t lastIOFinishedAt;  // Completion of last host I/O
+  uint64_t bgcFinishedAt;     // Completion of last background GC step
+  Event bgcEvent;
+
+  typedef struct {
     uint64_t gcCount;
     uint64_t reclaimedBlocks;
     uint64_t validSuperPageCopies;
     uint64_t validPageCopies;
-  } stat;
-  vector<vector<int>> write_cycle;
+  } GCStat;
+
+  GCStat stat;     // On-demand GC
+  GCStat bgcStat;  // Background GC
+  uint64_t bgcPreemptions;
+
+  // pSLC write cache. Host writes go to blocks programmed in SLC mode while
+  // they last, and valid pages of full pSLC blocks are folded into normal
+  // blocks when device is idle.
+  uint32_t nSLCBlocks;       // Blocks [0, nSLCBlocks) are pSLC blocks
+  uint32_t slcPagesInBlock;  // Pages of block in SLC mode
+  std::vector<std::list<Block>> slcFreeBlocks;  // One pool per parallel unit
+  uint32_t nSLCFreeBlocks;
+  // Open pSLC block of each parallel unit, totalPhysicalBlocks if none
+  std::vector<uint32_t> slcLastFreeBlock;
+  uint32_t slcLastFreeBlockIndex;
+  std::list<uint32_t> slcFullBlocks;  // In written order
+  bool bInFolding;
+
+  typedef struct {
+    uint64_t pageWrites;        // Pages written to pSLC blocks
+    uint64_t directPageWrites;  // Host pages bypassed full pSLC region
+  } SLCStat;
+
+  SLCStat slcStat;
+  GCStat foldStat;
+
+  // Static wear-leveling moves cold data in the least erased block to the
+  // most erased free blocks when erase count spread exceeds threshold
+  bool bStaticWL;
+  bool bInWearLeveling;
+  WriteFrontier wlFrontier;  // Open blocks of migrated cold data
+  float wlCredit;            // Pages allowed to migrate
+  Histogram eraseCountDist;  // Erase counts of blocks not retired
+  // (Erase count, block index) of full blocks, least erased one first
+  std::set<std::pair<uint32_t, uint32_t>> coldBlocks;
+  GCStat wlStat;
+
+  // Page type aware placement steers latency-critical data to LSB pages.
+  // Fast frontier has one more open block in each parallel unit. Other data
+  // fills its slow pages, so its next page is LSB when critical data comes.
+  bool bPlacement;
+  WriteFrontier fastFrontier;
+  std::vector<uint8_t> readCount;  // Per-LPN saturating read counter
+  uint8_t readHotThreshold;
+  uint64_t reads;  // Reads since last aging of readCount
+
+  typedef struct {
+    uint64_t criticalPageWrites;  // Pages of latency-critical data
+    uint64_t fastPageWrites;      // Above, written to LSB pages
+  } PlacementStat;
+
+  PlacementStat placementStat;
+
+  // Read latency of each page type in ns
+  // Distribution is kept in coarser bins, as latency reaches tens of ms.
+  typedef struct {
+    uint64_t sum;
+    uint64_t max;
+    Histogram dist;
+  } ReadLatency;
+
+  ReadLatency readLatency[PAL::PAGE_TYPE_NUM];
+
+  // Write count of each physical page and its distribution
+  std::vector<uint32_t> writeCount;
+  Histogram writeCountDist;
+
+  std::pair<uint32_t, uint32_t> *getMappingList(uint64_t);
+  bool isMapped(uint64_t);
+  void setMapped(uint64_t, bool);
+  uint64_t countMappedLPNs(uint64_t, uint64_t);
 
   float freeBlockRatio();
   uint32_t convertBlockIdx(uint32_t);
-  uint32_t getFreeBlock(uint32_t);
-  uint32_t getLastFreeBlock(Bitset &);
-  void calculateVictimWeight(std::vector<std::pair<uint32_t, float>> &,
-                             const EVICT_POLICY, uint64_t);
-  void selectVictimBlock(std::vector<uint32_t> &, uint64_t &);
-  void doGarbageCollection(std::vector<uint32_t> &, uint64_t &);
-
+  uint32_t getFreeBlock(uint32_t, bool = false);
+  WriteFrontier &getFrontier(WRITE_STREAM);
+  uint32_t getLastFreeBlock(Bitset &, WriteFrontier &);
+  uint32_t getLastFreeBlockInUnit(uint32_t, WriteFrontier &);
+  void replaceOpenBlock(WriteFrontier &, uint32_t);
+  bool isSLCBlock(uint32_t);
+  PAL::PAGE_TYPE getPageType(uint32_t, uint32_t);
+  bool isNextPageFast(uint32_t, Bitset &);
+  void touchRead(uint64_t);
+  bool isLatencyCritical(uint64_t);
+  uint32_t placeByPageType(uint32_t, Bitset &, bool);
+  uint32_t getLastSLCBlock();
+  void selectVictimBlock(std::vector<uint32_t> &, uint64_t &, uint64_t = 0);
+  virtual void doGarbageCollection(std::vector<uint32_t> &, uint64_t &,
+                                   uint32_t = 0);
+  void incrementalGC(uint64_t &);
+  void foldSLCBlock(uint64_t &);
+  void staticWearLeveling(uint64_t &, uint32_t);
+  void rebuildEraseCountIndex();
+
+  void preemptBackgroundGC(uint64_t);
+  void scheduleBackgroundGC(uint64_t);
+  void backgroundGC(uint64_t);
+
+  uint32_t getFillStartIndex();
+  void fillPage(uint32_t, uint64_t, std::vector<Block *> &);
+  void fillSequential(uint64_t, uint64_t);
+  void fillRandom(uint64_t, uint64_t, std::mt19937_64 &);
+  virtual void fillMetadata();
+
+  bool loadSnapshot(std::string);
+  void saveSnapshot(std::string);
+
+  void increaseWriteCount(uint32_t, uint32_t);
   float calculateWearLeveling();
+  uint32_t calculateEraseCountSpread();
   void calculateTotalPages(uint64_t &, uint64_t &);
 
   void readInternal(Request &, uint64_t &);
   void writeInternal(Request &, uint64_t &, bool = true);
   void trimInternal(Request &, uint64_t &);
+  void invalidateRange(uint64_t, uint64_t, std::vector<uint32_t> &);
   void eraseInternal(PAL::Request &, uint64_t &);
 
  public:
-  PageMapping(ConfigReader &, Parameter &, PAL::PAL *, DRAM::AbstractDRAM *);
+  PageMapping(ConfigReader &, Parameter &, PAL::PAL *, DRAM::AbstractDRAM *,
+              uint64_t = 0);
   ~PageMapping();
 
   bool initialize() override;
@@ -86,6 +226,7 @@ class PageMapping : public AbstractFTL {
   void read(Request &, uint64_t &) override;
   void write(Request &, uint64_t &) override;
   void trim(Request &, uint64_t &) override;
+  void trim(LPNRange &, uint64_t &) override;
 
   void format(LPNRange &, uint64_t &) override;
 
@@ -94,6 +235,9 @@ class PageMapping : public AbstractFTL {
   void getStatList(std::vector<Stats> &, std::string) override;
   void getStatValues(std::vector<double> &) override;
   void resetStatValues() override;
+
+  void saveState(std::vector<uint8_t> &) override;
+  void loadState(std::vector<uint8_t> &) override;
 };
 
 }  // namespace FTL
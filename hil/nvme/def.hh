@@ -226,6 +226,11 @@ typedef enum {
   FEATURE_MEDIA_FEEDBACH = 0xCA
 } FEATURE;
 
+typedef enum {
+  DIRECTIVE_IDENTIFY = 0x00,
+  DIRECTIVE_STREAMS = 0x01,
+} DIRECTIVE_TYPE;
+
 typedef enum {
   TYPE_GENERIC_COMMAND_STATUS,   // -> NVME_STATUS_CODE
   TYPE_COMMAND_SPECIFIC_STATUS,  // -> NVME_ERROR_CODE
@@ -290,6 +290,9 @@ void Namespace::write(SQEntryWrapper &req, RequestFunction &func) {
   uint64_t slba = ((uint64_t)req.entry.dword11 << 32) | req.entry.dword10;
   // mjo: nlb means the Number of Logical Blocks
   uint16_t nlb = (req.entry.dword12 & 0xFFFF) + 1;
+  // Directive type and directive specific value (stream identifier)
+  uint8_t dtype = (req.entry.dword12 & 0xF00000) >> 20;
+  uint16_t dspec = req.entry.dword13 >> 16;
 
   if (!attached) {
     err = true;
@@ -300,6 +303,9 @@ void Namespace::write(SQEntryWrapper &req, RequestFunction &func) {
     err = true;
     warn("nvme_namespace: host tried to write 0 blocks");
   }
+  if (dtype != DIRECTIVE_STREAMS) {
+    dspec = 0;
+  }
 
   debugprint(LOG_HIL_NVME,
              "NVM     | WRITE | SQ %u:%u | CID %u | NSID %-5d | %" PRIX64
@@ -351,7 +357,8 @@ void Namespace::write(SQEntryWrapper &req, RequestFunction &func) {
                             context);
       }
 
-      pParent->write(this, pContext->slba, pContext->nlb, dmaDone, context);
+      pParent->write(this, pContext->slba, pContext->nlb, dmaDone, context,
+                     pContext->streamID);
     };
 
     IOContext *pContext = new IOContext(func, resp);
@@ -359,6 +366,7 @@ void Namespace::write(SQEntryWrapper &req, RequestFunction &func) {
     pContext->beginAt = getTick();
     pContext->slba = slba;		// mjo: Simply saying, slba == array pointer
     pContext->nlb = nlb;		// mjo: Simply saying, nlb == array length
+    pContext->streamID = dspec;
 
     CPUContext *pCPU =
         new CPUContext(doRead, pContext, CPU::NVME__NAMESPACE, CPU::WRITE);
@@ -66,8 +66,10 @@ class IOContext : public RequestContext {
   uint64_t slba;
   uint64_t nlb;
   uint64_t tick;
+  uint32_t streamID;
 
-  IOContext(RequestFunction &f, CQEntryWrapper &r) : RequestContext(f, r) {}
+  IOContext(RequestFunction &f, CQEntryWrapper &r)
+      : RequestContext(f, r), streamID(0) {}
 };
 
 class CompareContext : public IOContext {
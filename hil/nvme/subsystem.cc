@@ -454,10 +454,12 @@ void Subsystem::read(Namespace *ns, uint64_t slba, uint64_t nlblk,
 }
 
 void Subsystem::write(Namespace *ns, uint64_t slba, uint64_t nlblk,
-                      DMAFunction &func, void *context) {
+                      DMAFunction &func, void *context, uint32_t streamID) {
   // mjo: Here the controversial "req" object is initialized
   Request *req = new Request(func, context);
 
+  req->streamID = streamID;
+
   DMAFunction doWrite = [this](uint64_t, void *context) {
     auto req = (Request *)context;
 
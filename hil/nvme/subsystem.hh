@@ -75,7 +75,8 @@ class Subsystem : public AbstractSubsystem {
   uint32_t validNamespaceCount() override;
 
   void read(Namespace *, uint64_t, uint64_t, DMAFunction &, void *);
-  void write(Namespace *, uint64_t, uint64_t, DMAFunction &, void *);
+  void write(Namespace *, uint64_t, uint64_t, DMAFunction &, void *,
+             uint32_t = 0);
   void flush(Namespace *, DMAFunction &, void *);
   void trim(Namespace *, uint64_t, uint64_t, DMAFunction &, void *);
 
@@ -24,10 +24,22 @@ namespace SimpleSSD {
 namespace ICL {
 
 Line::_Line()
-    : tag(0), lastAccessed(0), insertedAt(0), dirty(false), valid(false) {}
+    : tag(0),
+      lastAccessed(0),
+      insertedAt(0),
+      streamID(0),
+      hostLength(0),
+      dirty(false),
+      valid(false) {}
 
 Line::_Line(uint64_t t, bool d)
-    : tag(t), lastAccessed(0), insertedAt(0), dirty(d), valid(true) {}
+    : tag(t),
+      lastAccessed(0),
+      insertedAt(0),
+      streamID(0),
+      hostLength(0),
+      dirty(d),
+      valid(true) {}
 
 AbstractCache::AbstractCache(ConfigReader &c, FTL::FTL *f,
                              DRAM::AbstractDRAM *d)
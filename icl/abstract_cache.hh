@@ -32,6 +32,8 @@ typedef struct _Line {
   uint64_t tag;
   uint64_t lastAccessed;
   uint64_t insertedAt;
+  uint32_t streamID;    // Stream ID of last host write to this line
+  uint64_t hostLength;  // Length of last host write to this line
   bool dirty;
   bool valid;
 
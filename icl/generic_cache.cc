@@ -322,6 +322,8 @@ void GenericCache::evictCache(uint64_t tick, bool flush) {
         reqInternal.lpn = evictData[row][col]->tag / lineCountInSuperPage;
         reqInternal.ioFlag.reset();
         reqInternal.ioFlag.set(row);
+        reqInternal.streamID = evictData[row][col]->streamID;
+        reqInternal.hostLength = evictData[row][col]->hostLength;
 
         pFTL->write(reqInternal, beginAt);
       }
@@ -600,6 +602,8 @@ bool GenericCache::write(Request &req, uint64_t &tick) {
 
       // Update last accessed time
       cacheData[setIdx][wayIdx].dirty = dirty;
+      cacheData[setIdx][wayIdx].streamID = req.streamID;
+      cacheData[setIdx][wayIdx].hostLength = req.hostLength;
 
       // DRAM access
       pDRAM->write(&cacheData[setIdx][wayIdx], req.length, tick);
@@ -639,6 +643,8 @@ bool GenericCache::write(Request &req, uint64_t &tick) {
         cacheData[setIdx][wayIdx].valid = true;
         cacheData[setIdx][wayIdx].dirty = dirty;
         cacheData[setIdx][wayIdx].tag = req.range.slpn;
+        cacheData[setIdx][wayIdx].streamID = req.streamID;
+        cacheData[setIdx][wayIdx].hostLength = req.hostLength;
 
         // DRAM access
         pDRAM->write(&cacheData[setIdx][wayIdx], req.length, tick);
@@ -724,6 +730,8 @@ bool GenericCache::write(Request &req, uint64_t &tick) {
         cacheData[setIdx][wayIdx].valid = true;
         cacheData[setIdx][wayIdx].dirty = true;
         cacheData[setIdx][wayIdx].tag = req.range.slpn;
+        cacheData[setIdx][wayIdx].streamID = req.streamID;
+        cacheData[setIdx][wayIdx].hostLength = req.hostLength;
       }
 
       debugprint(LOG_ICL_GENERIC_CACHE,
@@ -776,6 +784,8 @@ void GenericCache::flush(LPNRange &range, uint64_t &tick) {
           if (line.dirty) {
             reqInternal.lpn = line.tag / lineCountInSuperPage;
             reqInternal.ioFlag.set(line.tag % lineCountInSuperPage);
+            reqInternal.streamID = line.streamID;
+            reqInternal.hostLength = line.hostLength;
 
             ftlTick = tick;
             pFTL->write(reqInternal, ftlTick);
@@ -792,13 +802,10 @@ void GenericCache::flush(LPNRange &range, uint64_t &tick) {
   }
 }
 
-// True when hit
+// Cached lines in range are dropped, and FTL unmaps whole superpages only
+// as it cannot unmap part of superpage
 void GenericCache::trim(LPNRange &range, uint64_t &tick) {
   if (useReadCaching || useWriteCaching) {
-    uint64_t ftlTick = tick;
-    uint64_t finishedAt = tick;
-    FTL::Request reqInternal(lineCountInSuperPage);
-
     for (uint32_t setIdx = 0; setIdx < setSize; setIdx++) {
       for (uint32_t wayIdx = 0; wayIdx < waySize; wayIdx++) {
         Line &line = cacheData[setIdx][wayIdx];
@@ -806,21 +813,24 @@ void GenericCache::trim(LPNRange &range, uint64_t &tick) {
         tick += getCacheLatency() * 8;
 
         if (line.tag >= range.slpn && line.tag < range.slpn + range.nlp) {
-          reqInternal.lpn = line.tag / lineCountInSuperPage;
-          reqInternal.ioFlag.set(line.tag % lineCountInSuperPage);
-
-          ftlTick = tick;
-          pFTL->trim(reqInternal, ftlTick);
-          finishedAt = MAX(finishedAt, ftlTick);
-
           line.valid = false;
         }
       }
     }
+  }
 
-    tick = MAX(tick, finishedAt);
-    tick += applyLatency(CPU::ICL__GENERIC_CACHE, CPU::TRIM);
+  // Convert unit
+  uint64_t lpnBegin =
+      (range.slpn + lineCountInSuperPage - 1) / lineCountInSuperPage;
+  uint64_t lpnEnd = (range.slpn + range.nlp) / lineCountInSuperPage;
+
+  if (lpnBegin < lpnEnd) {
+    LPNRange ftlRange(lpnBegin, lpnEnd - lpnBegin);
+
+    pFTL->trim(ftlRange, tick);
   }
+
+  tick += applyLatency(CPU::ICL__GENERIC_CACHE, CPU::TRIM);
 }
 
 void GenericCache::format(LPNRange &range, uint64_t &tick) {
@@ -103,6 +103,8 @@ void ICL::write(Request &req, uint64_t &tick) {
 
   reqInternal.reqID = req.reqID;
   reqInternal.offset = req.offset;
+  reqInternal.streamID = req.streamID;
+  reqInternal.hostLength = req.length;
 
   //mjo: Page-level write request
   for (uint64_t i = 0; i < req.range.nlp; i++) {
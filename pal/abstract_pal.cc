@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pal/abstract_pal.hh"
+
+namespace SimpleSSD {
+
+namespace PAL {
+
+// Split request into NAND page addresses by superblock and page allocation
+void AbstractPAL::convertCPDPBP(Request &req, std::vector<::CPDPBP> &list) {
+  ::CPDPBP addr;
+  static uint32_t pageAllocation = conf.getPageAllocationConfig();
+  static uint8_t superblock = conf.getSuperblockConfig();
+  static bool useMultiplaneOP =
+      conf.readBoolean(CONFIG_PAL, NAND_USE_MULTI_PLANE_OP);
+  static uint32_t pageInSuperPage = param.pageInSuperPage;
+  static bool bRandomTweak =
+      conf.readBoolean(CONFIG_FTL, FTL::FTL_USE_RANDOM_IO_TWEAK);
+  uint32_t value[4];
+  uint32_t *ptr[4];
+  uint64_t tmp = req.blockIndex;
+  int count = 0;
+
+  if (bRandomTweak && req.ioFlag.size() != pageInSuperPage) {
+    panic("Invalid size of I/O flag");
+  }
+
+  if (!bRandomTweak && req.ioFlag.size() != pageInSuperPage) {
+    req.ioFlag = Bitset(pageInSuperPage);
+    req.ioFlag.set();
+  }
+
+  list.clear();
+
+  addr.Plane = 0;
+
+  for (int i = 0; i < 4; i++) {
+    uint8_t idx = (pageAllocation >> (i * 8)) & 0xFF;
+
+    switch (idx) {
+      case INDEX_CHANNEL:
+        if (superblock & INDEX_CHANNEL) {
+          value[count] = param.channel;
+          ptr[count++] = &addr.Channel;
+        }
+        else {
+          addr.Channel = tmp % param.channel;
+          tmp /= param.channel;
+        }
+
+        break;
+      case INDEX_PACKAGE:
+        if (superblock & INDEX_PACKAGE) {
+          value[count] = param.package;
+          ptr[count++] = &addr.Package;
+        }
+        else {
+          addr.Package = tmp % param.package;
+          tmp /= param.package;
+        }
+
+        break;
+      case INDEX_DIE:
+        if (superblock & INDEX_DIE) {
+          value[count] = param.die;
+          ptr[count++] = &addr.Die;
+        }
+        else {
+          addr.Die = tmp % param.die;
+          tmp /= param.die;
+        }
+
+        break;
+      case INDEX_PLANE:
+        if (!useMultiplaneOP) {
+          if (superblock & INDEX_PLANE) {
+            value[count] = param.plane;
+            ptr[count++] = &addr.Plane;
+          }
+          else {
+            addr.Plane = tmp % param.plane;
+            tmp /= param.plane;
+          }
+        }
+
+        break;
+      default:
+        break;
+    }
+  }
+
+  addr.Block = tmp;
+  addr.Page = req.pageIndex;
+
+  // Index of ioFlag
+  tmp = 0;
+
+  if (count == 4) {
+    list.reserve(value[0] * value[1] * value[2] * value[3]);
+
+    for (uint32_t i = 0; i < value[3]; i++) {
+      for (uint32_t j = 0; j < value[2]; j++) {
+        for (uint32_t k = 0; k < value[1]; k++) {
+          for (uint32_t l = 0; l < value[0]; l++) {
+            if (req.ioFlag.test(tmp++)) {
+              *ptr[0] = l;
+              *ptr[1] = k;
+              *ptr[2] = j;
+              *ptr[3] = i;
+
+              list.push_back(addr);
+            }
+          }
+        }
+      }
+    }
+  }
+  else if (count == 3) {
+    list.reserve(value[0] * value[1] * value[2]);
+
+    for (uint32_t j = 0; j < value[2]; j++) {
+      for (uint32_t k = 0; k < value[1]; k++) {
+        for (uint32_t l = 0; l < value[0]; l++) {
+          if (req.ioFlag.test(tmp++)) {
+            *ptr[0] = l;
+            *ptr[1] = k;
+            *ptr[2] = j;
+
+            list.push_back(addr);
+          }
+        }
+      }
+    }
+  }
+  else if (count == 2) {
+    list.reserve(value[0] * value[1]);
+
+    for (uint32_t k = 0; k < value[1]; k++) {
+      for (uint32_t l = 0; l < value[0]; l++) {
+        if (req.ioFlag.test(tmp++)) {
+          *ptr[0] = l;
+          *ptr[1] = k;
+
+          list.push_back(addr);
+        }
+      }
+    }
+  }
+  else if (count == 1) {
+    list.reserve(value[0]);
+
+    for (uint32_t l = 0; l < value[0]; l++) {
+      if (req.ioFlag.test(tmp++)) {
+        *ptr[0] = l;
+
+        list.push_back(addr);
+      }
+    }
+  }
+  else {
+    if (req.ioFlag.test(tmp++)) {
+      list.push_back(addr);
+    }
+  }
+
+  if (tmp != pageInSuperPage) {
+    panic("I/O flag size != # pages in super page");
+  }
+
+  // One I/O flag covers all planes of die in multi-plane mode
+  if (useMultiplaneOP && param.plane > 1) {
+    std::vector<::CPDPBP> die;
+
+    die.swap(list);
+    list.reserve(die.size() * param.plane);
+
+    for (auto &iter : die) {
+      for (uint32_t i = 0; i < param.plane; i++) {
+        iter.Plane = i;
+
+        list.push_back(iter);
+      }
+    }
+  }
+}
+
+// Number of addresses from list[begin] issued as one multi-plane operation
+// Planes of a multi-plane operation should be in the same die, in ascending
+// order, and access the same block and page offset. Addresses which break
+// this are issued as single-plane operations.
+uint32_t AbstractPAL::getMultiPlaneCount(std::vector<::CPDPBP> &list,
+                                         uint64_t begin) {
+  static bool useMultiplaneOP =
+      conf.readBoolean(CONFIG_PAL, NAND_USE_MULTI_PLANE_OP);
+  ::CPDPBP &first = list.at(begin);
+  uint32_t count = 1;
+
+  if (!useMultiplaneOP) {
+    return 1;
+  }
+
+  for (uint64_t i = begin + 1; i < list.size(); i++) {
+    ::CPDPBP &addr = list.at(i);
+
+    if (addr.Channel != first.Channel || addr.Package != first.Package ||
+        addr.Die != first.Die || addr.Block != first.Block ||
+        addr.Page != first.Page || addr.Plane != first.Plane + count) {
+      break;
+    }
+
+    count++;
+  }
+
+  return count;
+}
+
+}  // namespace PAL
+
+}  // namespace SimpleSSD
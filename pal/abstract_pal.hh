@@ -21,8 +21,10 @@
 #define __PAL_ABSTRACT_PAL__
 
 #include <cinttypes>
+#include <vector>
 
 #include "pal/pal.hh"
+#include "util/old/SimpleSSD_types.h"
 
 namespace SimpleSSD {
 
@@ -33,6 +35,9 @@ class AbstractPAL : public StatObject {
   Parameter &param;
   ConfigReader &conf;
 
+  void convertCPDPBP(Request &, std::vector<::CPDPBP> &);
+  uint32_t getMultiPlaneCount(std::vector<::CPDPBP> &, uint64_t);
+
  public:
   AbstractPAL(Parameter &p, ConfigReader &c) : param(p), conf(c) {}
   virtual ~AbstractPAL() {}
@@ -40,6 +45,12 @@ class AbstractPAL : public StatObject {
   virtual void read(Request &, uint64_t &) = 0;
   virtual void write(Request &, uint64_t &) = 0;
   virtual void erase(Request &, uint64_t &) = 0;
+
+  // Copy pages without channel transfer
+  // Each page of source and destination should be in the same plane
+  virtual void copyback(Request &, Request &, uint64_t &) = 0;
+
+  virtual PAGE_TYPE getPageType(uint32_t) = 0;
 };
 
 }  // namespace PAL
@@ -27,6 +27,10 @@ namespace PAL {
 
 const char NAME_CHANNEL[] = "Channel";
 const char NAME_PACKAGE[] = "Package";
+const char NAME_ENGINE[] = "Engine";
+const char NAME_SCHEDULING_POLICY[] = "SchedulingPolicy";
+const char NAME_USE_SUSPEND[] = "EnableSuspend";
+const char NAME_MAX_SUSPEND[] = "MaxSuspend";
 const char NAME_PAGE_ALLOCATION[] = "PageAllocation";
 const char NAME_SUPER_BLOCK[] = "SuperblockSize";
 
@@ -37,6 +41,8 @@ const char NAME_BLOCK[] = "Block";
 const char NAME_PAGE[] = "Page";
 const char NAME_PAGE_SIZE[] = "PageSize";
 const char NAME_USE_MULTI_PLANE_OP[] = "EnableMultiPlaneOperation";
+const char NAME_USE_CACHE_READ[] = "EnableCacheRead";
+const char NAME_USE_CACHE_PROGRAM[] = "EnableCacheProgram";
 const char NAME_DMA_SPEED[] = "DMASpeed";
 const char NAME_DMA_WIDTH[] = "DMAWidth";
 const char NAME_FLASH_TYPE[] = "NANDType";
@@ -49,6 +55,7 @@ const char NAME_NAND_CSB_WRITE[] = "CSBWrite";
 const char NAME_NAND_MSB_READ[] = "MSBRead";
 const char NAME_NAND_MSB_WRITE[] = "MSBWrite";
 const char NAME_NAND_ERASE[] = "Erase";
+const char NAME_NAND_SUSPEND[] = "Suspend";
 
 /* NAND power TODO: seperate this */
 const char NAME_NAND_VOLTAGE[] = "Voltage";
@@ -69,12 +76,18 @@ const uint8_t eraseCycle = 5;
 Config::Config() {
   channel = 8;
   package = 4;
+  engine = PAL_ENGINE_OLD;
+  policy = POLICY_FIFO;
+  useSuspend = false;
+  maxSuspend = 3;
   die = 2;
   plane = 1;
   block = 512;
   page = 512;
   pageSize = 16384;
   useMultiPlaneOperation = true;
+  useCacheRead = false;
+  useCacheProgram = false;
   dmaSpeed = 400;
   dmaWidth = 8;
   nandType = NAND_MLC;
@@ -87,6 +100,7 @@ Config::Config() {
   nandTiming.msb.read = 65000000;     // 65us
   nandTiming.msb.write = 1300000000;  // 1300us
   nandTiming.erase = 3500000000;      // 3.5ms
+  nandTiming.suspend = 20000000;      // 20us
 
   // Set NAND power (From: Micron's MT29F64*)
   nandPower.voltage = 3300;           // 3.3V
@@ -109,6 +123,18 @@ bool Config::setConfig(const char *name, const char *value) {
   else if (MATCH_NAME(NAME_PACKAGE)) {
     package = strtoul(value, nullptr, 10);
   }
+  else if (MATCH_NAME(NAME_ENGINE)) {
+    engine = (PAL_ENGINE_TYPE)strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_SCHEDULING_POLICY)) {
+    policy = (SCHEDULING_POLICY)strtoul(value, nullptr, 10);
+  }
+  else if (MATCH_NAME(NAME_USE_SUSPEND)) {
+    useSuspend = convertBool(value);
+  }
+  else if (MATCH_NAME(NAME_MAX_SUSPEND)) {
+    maxSuspend = strtoul(value, nullptr, 10);
+  }
   else if (MATCH_NAME(NAME_DIE)) {
     die = strtoul(value, nullptr, 10);
   }
@@ -127,6 +153,12 @@ bool Config::setConfig(const char *name, const char *value) {
   else if (MATCH_NAME(NAME_USE_MULTI_PLANE_OP)) {
     useMultiPlaneOperation = convertBool(value);
   }
+  else if (MATCH_NAME(NAME_USE_CACHE_READ)) {
+    useCacheRead = convertBool(value);
+  }
+  else if (MATCH_NAME(NAME_USE_CACHE_PROGRAM)) {
+    useCacheProgram = convertBool(value);
+  }
   else if (MATCH_NAME(NAME_DMA_SPEED)) {
     dmaSpeed = strtoul(value, nullptr, 10);
   }
@@ -163,6 +195,9 @@ bool Config::setConfig(const char *name, const char *value) {
   else if (MATCH_NAME(NAME_NAND_ERASE)) {
     nandTiming.erase = strtoul(value, nullptr, 10);
   }
+  else if (MATCH_NAME(NAME_NAND_SUSPEND)) {
+    nandTiming.suspend = strtoul(value, nullptr, 10);
+  }
   else if (MATCH_NAME(NAME_NAND_VOLTAGE)) {
     nandPower.voltage = strtoul(value, nullptr, 10);
   }
@@ -193,6 +228,14 @@ void Config::update() {
     panic("dmaWidth should be multiple of 8.");
   }
 
+  if (engine > PAL_ENGINE_LITE) {
+    panic("Invalid PAL engine");
+  }
+
+  if (policy > POLICY_GC_LAST) {
+    panic("Invalid scheduling policy");
+  }
+
   // DMA time calculation
   //                 MT/s       MT -> T    ms     us     ns     ps
   float tCK = 1.f / (dmaSpeed * 1048576) * 1000 * 1000 * 1000 * 1000;
@@ -318,6 +361,15 @@ uint64_t Config::readUint(uint32_t idx) {
     case PAL_PACKAGE:
       ret = package;
       break;
+    case PAL_ENGINE:
+      ret = engine;
+      break;
+    case PAL_SCHEDULING_POLICY:
+      ret = policy;
+      break;
+    case PAL_MAX_SUSPEND:
+      ret = maxSuspend;
+      break;
     case NAND_DIE:
       ret = die;
       break;
@@ -348,9 +400,18 @@ bool Config::readBoolean(uint32_t idx) {
   bool ret = false;
 
   switch (idx) {
+    case PAL_USE_SUSPEND:
+      ret = useSuspend;
+      break;
     case NAND_USE_MULTI_PLANE_OP:
       ret = useMultiPlaneOperation;
       break;
+    case NAND_USE_CACHE_READ:
+      ret = useCacheRead;
+      break;
+    case NAND_USE_CACHE_PROGRAM:
+      ret = useCacheProgram;
+      break;
   }
 
   return ret;
@@ -30,6 +30,10 @@ typedef enum {
   /* PAL config */
   PAL_CHANNEL,
   PAL_PACKAGE,
+  PAL_ENGINE,
+  PAL_SCHEDULING_POLICY,
+  PAL_USE_SUSPEND,
+  PAL_MAX_SUSPEND,
 
   /* NAND config TODO: seperate this */
   NAND_DIE,
@@ -38,11 +42,25 @@ typedef enum {
   NAND_PAGE,
   NAND_PAGE_SIZE,
   NAND_USE_MULTI_PLANE_OP,
+  NAND_USE_CACHE_READ,
+  NAND_USE_CACHE_PROGRAM,
   NAND_DMA_SPEED,
   NAND_DMA_WIDTH,
   NAND_FLASH_TYPE,
 } PAL_CONFIG;
 
+typedef enum {
+  PAL_ENGINE_OLD,       // Timeline reservation (PAL2)
+  PAL_ENGINE_QUEUE,     // Per-die command queues
+  PAL_ENGINE_LITE,      // Timeline with bounded idle gaps
+} PAL_ENGINE_TYPE;
+
+typedef enum {
+  POLICY_FIFO,
+  POLICY_READ_FIRST,
+  POLICY_GC_LAST,
+} SCHEDULING_POLICY;
+
 typedef enum {
   NAND_SLC,
   NAND_MLC,
@@ -76,6 +94,7 @@ class Config : public BaseConfig {
     DMATiming dma0;
     DMATiming dma1;
     uint64_t erase;
+    uint64_t suspend;  // Program/erase suspend
   } NANDTiming;
 
   typedef struct {
@@ -90,8 +109,12 @@ class Config : public BaseConfig {
   } NANDPower;
 
  private:
-  uint32_t channel;  //!< Default: 8
-  uint32_t package;  //!< Default: 4
+  uint32_t channel;          //!< Default: 8
+  uint32_t package;          //!< Default: 4
+  PAL_ENGINE_TYPE engine;    //!< Default: PAL_ENGINE_OLD
+  SCHEDULING_POLICY policy;  //!< Default: POLICY_FIFO
+  bool useSuspend;           //!< Default: false
+  uint32_t maxSuspend;       //!< Default: 3
 
   uint32_t die;                 //!< Default: 2
   uint32_t plane;               //!< Default: 1
@@ -99,6 +122,8 @@ class Config : public BaseConfig {
   uint32_t page;                //!< Default: 512
   uint32_t pageSize;            //!< Default: 16384
   bool useMultiPlaneOperation;  //!< Default: true
+  bool useCacheRead;            //!< Default: false
+  bool useCacheProgram;         //!< Default: false
   uint32_t dmaSpeed;            //!< Default: 400
   uint32_t dmaWidth;            //!< Default: 8
   NAND_TYPE nandType;           //!< Default: NAND_MLC
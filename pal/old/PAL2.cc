@@ -21,6 +21,8 @@
 
 #include "util/algorithm.hh"
 
+#define PRUNE_RANGE 10000000000ull  // 0.01sec
+
 PAL2::PAL2(PALStatistics *statistics, SimpleSSD::PAL::Parameter *p,
            SimpleSSD::ConfigReader *c, Latency *l)
     : pParam(p), lat(l), stats(statistics) {
@@ -72,139 +74,43 @@ PAL2::PAL2(PALStatistics *statistics, SimpleSSD::PAL::Parameter *p,
 
   totalDie = pParam->channel * pParam->package * pParam->die;
 
-  ChFreeSlots =
-      new std::map<uint64_t, std::map<uint64_t, uint64_t> *>[pParam->channel];
-  ChStartPoint = new uint64_t[pParam->channel];
-  for (unsigned i = 0; i < pParam->channel; i++)
-    ChStartPoint[i] = 0;
-
-  DieFreeSlots =
-      new std::map<uint64_t, std::map<uint64_t, uint64_t> *>[totalDie];
-  DieStartPoint = new uint64_t[totalDie];
-  for (unsigned i = 0; i < totalDie; i++)
-    DieStartPoint[i] = 0;
-
-  // currently, hard code pre-dma, mem-op and post-dma values
-  for (unsigned i = 0; i < pParam->channel; i++) {
-    std::map<uint64_t, uint64_t> *tmp;
-    switch (
-        c->readUint(SimpleSSD::CONFIG_PAL, SimpleSSD::PAL::NAND_FLASH_TYPE)) {
-      case SimpleSSD::PAL::NAND_SLC:
-        tmp = new std::map<uint64_t, uint64_t>;
-        ChFreeSlots[i][100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        ChFreeSlots[i][100000 / SPDIV + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        ChFreeSlots[i][185000000 / (PGDIV * SPDIV)] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        ChFreeSlots[i][185000000 / (PGDIV * SPDIV) + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        ChFreeSlots[i][1500000 / SPDIV] = tmp;
-        break;
-      case SimpleSSD::PAL::NAND_MLC:
-        tmp = new std::map<uint64_t, uint64_t>;
-        ChFreeSlots[i][100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        ChFreeSlots[i][100000 / SPDIV + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        ChFreeSlots[i][185000000 / (PGDIV * SPDIV)] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        ChFreeSlots[i][185000000 / (PGDIV * SPDIV) + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        ChFreeSlots[i][1500000 / SPDIV] = tmp;
-        break;
-      case SimpleSSD::PAL::NAND_TLC:
-        tmp = new std::map<uint64_t, uint64_t>;
-        ChFreeSlots[i][100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        ChFreeSlots[i][100000 / SPDIV + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        ChFreeSlots[i][185000000 / (PGDIV * SPDIV)] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        ChFreeSlots[i][185000000 / (PGDIV * SPDIV) + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        ChFreeSlots[i][1500000 / SPDIV] = tmp;
-        break;
-      default:
-        printf("unsupported NAND types!\n");
-        std::terminate();
-        break;
-    }
-  }
+  // Free slots shorter than the shortest operation are not tracked
+  uint64_t minDieSlot = 0;
 
-  for (unsigned i = 0; i < totalDie; i++) {
-    std::map<uint64_t, uint64_t> *tmp;
-    switch (
-        c->readUint(SimpleSSD::CONFIG_PAL, SimpleSSD::PAL::NAND_FLASH_TYPE)) {
-      case SimpleSSD::PAL::NAND_SLC:
-        tmp = new std::map<uint64_t, uint64_t>;
-        DieFreeSlots[i][25000000 + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        DieFreeSlots[i][300000000 + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        DieFreeSlots[i][2000000000 + 100000 / SPDIV] = tmp;
-        break;
-      case SimpleSSD::PAL::NAND_MLC:
-        tmp = new std::map<uint64_t, uint64_t>;
-        DieFreeSlots[i][40000000 + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        DieFreeSlots[i][90000000 + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        DieFreeSlots[i][500000000 + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        DieFreeSlots[i][1300000000 + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        DieFreeSlots[i][3500000000 + 100000 / SPDIV] = tmp;
-        break;
-      case SimpleSSD::PAL::NAND_TLC:
-        tmp = new std::map<uint64_t, uint64_t>;
-        DieFreeSlots[i][58000000 + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        DieFreeSlots[i][78000000 + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        DieFreeSlots[i][107000000 + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        DieFreeSlots[i][558000000 + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        DieFreeSlots[i][2201000000 + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        DieFreeSlots[i][5001000000 + 100000 / SPDIV] = tmp;
-        tmp = new std::map<uint64_t, uint64_t>;
-        DieFreeSlots[i][2274000000 + 100000 / SPDIV] = tmp;
-        break;
-      default:
-        printf("unsupported NAND types!\n");
-        std::terminate();
-        break;
-    }
+  switch (
+      c->readUint(SimpleSSD::CONFIG_PAL, SimpleSSD::PAL::NAND_FLASH_TYPE)) {
+    case SimpleSSD::PAL::NAND_SLC:
+      minDieSlot = 25000000 + 100000 / SPDIV;
+      break;
+    case SimpleSSD::PAL::NAND_MLC:
+      minDieSlot = 40000000 + 100000 / SPDIV;
+      break;
+    case SimpleSSD::PAL::NAND_TLC:
+      minDieSlot = 58000000 + 100000 / SPDIV;
+      break;
+    default:
+      printf("unsupported NAND types!\n");
+      std::terminate();
+      break;
   }
-}
 
-PAL2::~PAL2() {
-  FlushTimeSlots(MAX64);
+  ChFreeSlots.resize(pParam->channel, FreeSlotList(100000 / SPDIV));
+  DieFreeSlots.resize(totalDie, FreeSlotList(minDieSlot));
 
-  for (uint i = 0; i < pParam->channel; i++) {
-    for (auto &iter : ChFreeSlots[i]) {
-      {
-        delete iter.second;
-        iter.second = NULL;
-      }
-    }
-  }
-  delete[] ChFreeSlots;
+  UseCacheRead =
+      c->readBoolean(SimpleSSD::CONFIG_PAL, SimpleSSD::PAL::NAND_USE_CACHE_READ);
+  UseCacheProgram = c->readBoolean(SimpleSSD::CONFIG_PAL,
+                                   SimpleSSD::PAL::NAND_USE_CACHE_PROGRAM);
 
-  for (uint i = 0; i < totalDie; i++) {
-    for (auto &iter : DieFreeSlots[i]) {
-      {
-        delete iter.second;
-        iter.second = NULL;
-      }
-    }
-  }
-  delete[] DieFreeSlots;
+  DieCommand none;
 
-  delete[] ChStartPoint;
-  delete[] DieStartPoint;
+  memset(&none, 0, sizeof(DieCommand));
+  none.operation = OPER_NUM;
+  LastCommand.resize(totalDie, none);
+}
+
+PAL2::~PAL2() {
+  FlushTimeSlots(MAX64);
 }
 
 void PAL2::TimelineScheduling(Command &req, CPDPBP &reqCPD) {
@@ -218,6 +124,8 @@ void PAL2::TimelineScheduling(Command &req, CPDPBP &reqCPD) {
     req.ppn = req.ppn - (req.ppn & (erase_block - 1)) + cur_command;
     uint32_t reqCh = reqCPD.Channel;
     uint32_t reqDieIdx = CPDPBPtoDieIdx(&reqCPD);
+    FreeSlotList &chSlots = ChFreeSlots[reqCh];
+    FreeSlotList &dieSlots = DieFreeSlots[reqDieIdx];
     TimeSlot tsDMA0, tsMEM, tsDMA1;
     uint64_t tickDMA0 = 0, tickMEM = 0,
              tickDMA1 = 0;  // start tick of the free slot
@@ -225,26 +133,40 @@ void PAL2::TimelineScheduling(Command &req, CPDPBP &reqCPD) {
     uint64_t DMA0tickFrom, MEMtickFrom, DMA1tickFrom;  // starting point
     uint64_t latANTI;                                  // anticipate time slot
     bool conflicts;  // check conflict when scheduling
-    latDMA0 = lat->GetLatency(reqCPD.Page, req.operation, BUSY_DMA0);
-    latMEM = lat->GetLatency(reqCPD.Page, req.operation, BUSY_MEM);
-    latDMA1 = lat->GetLatency(reqCPD.Page, req.operation, BUSY_DMA1);
+    req.hidden = 0;
+    latDMA0 = req.getBusyLatency(lat, reqCPD.Page, BUSY_DMA0);
+    latMEM = req.getBusyLatency(lat, reqCPD.Page, BUSY_MEM);
+    latDMA1 = req.getBusyLatency(lat, reqCPD.Page, BUSY_DMA1);
     latANTI = lat->GetLatency(reqCPD.Page, OPER_READ, BUSY_DMA0);
+    req.hidden = GetHiddenLatency(req, reqCPD, reqDieIdx, latDMA0, latMEM);
+    latMEM -= req.hidden;
+    // Free slots far behind current tick are not used anymore
+    if (SimpleSSD::getTick() > PRUNE_RANGE) {
+      chSlots.prune(SimpleSSD::getTick() - PRUNE_RANGE);
+      dieSlots.prune(SimpleSSD::getTick() - PRUNE_RANGE);
+    }
+
     // Start Finding available Slot
     DMA0tickFrom = req.arrived;  // get Current System Time
+
+    // Pipelined command starts right after previous one
+    if (req.hidden > 0) {
+      DMA0tickFrom = MAX(DMA0tickFrom, LastCommand[reqDieIdx].endTick + 1);
+    }
+
     while (1)                    // LOOP0
     {
       while (1)  // LOOP1
       {
         // 1a) LOOP1 - Find DMA0 available slot in ChTimeSlots
-        if (!FindFreeTime(ChFreeSlots[reqCh], latDMA0, DMA0tickFrom, tickDMA0,
-                          conflicts)) {
-          if (DMA0tickFrom < ChStartPoint[reqCh]) {
-            DMA0tickFrom = ChStartPoint[reqCh];
+        if (!chSlots.find(latDMA0, DMA0tickFrom, tickDMA0, conflicts)) {
+          if (DMA0tickFrom < chSlots.getStartPoint()) {
+            DMA0tickFrom = chSlots.getStartPoint();
             conflicts = true;
           }
           else
             conflicts = false;
-          tickDMA0 = ChStartPoint[reqCh];
+          tickDMA0 = chSlots.getStartPoint();
         }
         else {
           if (conflicts)
@@ -259,16 +181,15 @@ void PAL2::TimelineScheduling(Command &req, CPDPBP &reqCPD) {
 
         // 2b) LOOP1 - Find MEM avaiable slot in DieTimeSlots
         MEMtickFrom = DMA0tickFrom;
-        if (!FindFreeTime(DieFreeSlots[reqDieIdx], (latDMA0 + latMEM),
-                          MEMtickFrom, tickMEM, conflicts)) {
-          if (MEMtickFrom < DieStartPoint[reqDieIdx]) {
-            MEMtickFrom = DieStartPoint[reqDieIdx];
+        if (!dieSlots.find(latDMA0 + latMEM, MEMtickFrom, tickMEM, conflicts)) {
+          if (MEMtickFrom < dieSlots.getStartPoint()) {
+            MEMtickFrom = dieSlots.getStartPoint();
             conflicts = true;
           }
           else {
             conflicts = false;
           }
-          tickMEM = DieStartPoint[reqDieIdx];
+          tickMEM = dieSlots.getStartPoint();
         }
         else {
           if (conflicts)
@@ -279,9 +200,8 @@ void PAL2::TimelineScheduling(Command &req, CPDPBP &reqCPD) {
         DMA0tickFrom = MEMtickFrom;
 
         uint64_t tickDMA0_vrfy;
-        if (!FindFreeTime(ChFreeSlots[reqCh], latDMA0, DMA0tickFrom,
-                          tickDMA0_vrfy, conflicts)) {
-          tickDMA0_vrfy = ChStartPoint[reqCh];
+        if (!chSlots.find(latDMA0, DMA0tickFrom, tickDMA0_vrfy, conflicts)) {
+          tickDMA0_vrfy = chSlots.getStartPoint();
         }
         if (tickDMA0_vrfy == tickDMA0)
           break;
@@ -296,15 +216,14 @@ void PAL2::TimelineScheduling(Command &req, CPDPBP &reqCPD) {
 
       // 3) Find DMA1 available slot
       DMA1tickFrom = DMA0tickFrom + (latDMA0 + latMEM);
-      if (!FindFreeTime(ChFreeSlots[reqCh], latDMA1 + latANTI, DMA1tickFrom,
-                        tickDMA1, conflicts)) {
-        if (DMA1tickFrom < ChStartPoint[reqCh]) {
-          DMA1tickFrom = ChStartPoint[reqCh];
+      if (!chSlots.find(latDMA1 + latANTI, DMA1tickFrom, tickDMA1, conflicts)) {
+        if (DMA1tickFrom < chSlots.getStartPoint()) {
+          DMA1tickFrom = chSlots.getStartPoint();
           conflicts = true;
         }
         else
           conflicts = false;
-        tickDMA1 = ChStartPoint[reqCh];
+        tickDMA1 = chSlots.getStartPoint();
       }
       else {
         if (conflicts)
@@ -315,9 +234,8 @@ void PAL2::TimelineScheduling(Command &req, CPDPBP &reqCPD) {
       // The target die should be free during (DMA0_start ~ DMA1_end)
       totalLat = (DMA1tickFrom + latDMA1 + latANTI) - DMA0tickFrom;
       uint64_t tickMEM_vrfy;
-      if (!FindFreeTime(DieFreeSlots[reqDieIdx], totalLat, DMA0tickFrom,
-                        tickMEM_vrfy, conflicts)) {
-        tickMEM_vrfy = DieStartPoint[reqDieIdx];
+      if (!dieSlots.find(totalLat, DMA0tickFrom, tickMEM_vrfy, conflicts)) {
+        tickMEM_vrfy = dieSlots.getStartPoint();
       }
       if (tickMEM_vrfy == tickMEM)
         break;
@@ -331,33 +249,28 @@ void PAL2::TimelineScheduling(Command &req, CPDPBP &reqCPD) {
 
     // 5) Assign dma0, dma1, mem
     {
-      InsertFreeSlot(ChFreeSlots[reqCh], latDMA0, DMA0tickFrom, tickDMA0,
-                     ChStartPoint[reqCh], 0);
+      chSlots.insert(latDMA0, DMA0tickFrom, tickDMA0, false);
 
-      if (!FindFreeTime(ChFreeSlots[reqCh], latDMA1 + latANTI, DMA1tickFrom,
-                        tickDMA1, conflicts)) {
-        if (DMA1tickFrom < ChStartPoint[reqCh]) {
-          DMA1tickFrom = ChStartPoint[reqCh];
+      if (!chSlots.find(latDMA1 + latANTI, DMA1tickFrom, tickDMA1, conflicts)) {
+        if (DMA1tickFrom < chSlots.getStartPoint()) {
+          DMA1tickFrom = chSlots.getStartPoint();
           conflicts = true;
         }
         else
           conflicts = false;
-        tickDMA1 = ChStartPoint[reqCh];
+        tickDMA1 = chSlots.getStartPoint();
       }
       else {
         if (conflicts)
           DMA1tickFrom = tickDMA1;
       }
       if (DMA1tickFrom > tickDMA1)
-        InsertFreeSlot(ChFreeSlots[reqCh], latDMA1, DMA1tickFrom + latANTI,
-                       tickDMA1, ChStartPoint[reqCh], 0);
+        chSlots.insert(latDMA1, DMA1tickFrom + latANTI, tickDMA1, false);
       else
-        InsertFreeSlot(ChFreeSlots[reqCh], latDMA1, tickDMA1 + latANTI,
-                       tickDMA1, ChStartPoint[reqCh], 0);
+        chSlots.insert(latDMA1, tickDMA1 + latANTI, tickDMA1, false);
 
       // temporarily use previous MergedTimeSlots design
-      InsertFreeSlot(DieFreeSlots[reqDieIdx], totalLat, DMA0tickFrom, tickMEM,
-                     DieStartPoint[reqDieIdx], 0);
+      dieSlots.insert(totalLat, DMA0tickFrom, tickMEM, false);
 
       if (DMA0tickFrom < tickDMA0)
         tsDMA0 = TimeSlot(tickDMA0, latDMA0);
@@ -380,23 +293,21 @@ void PAL2::TimelineScheduling(Command &req, CPDPBP &reqCPD) {
       else
         DMA0tickFrom = tickDMA0 + latDMA0;
       uint64_t tmpTick = DMA0tickFrom;
-      if (!FindFreeTime(ChFreeSlots[reqCh], latANTI * 2, DMA0tickFrom, tickDMA0,
-                        conflicts)) {
-        if (DMA0tickFrom < ChStartPoint[reqCh]) {
-          DMA0tickFrom = ChStartPoint[reqCh];
+      if (!chSlots.find(latANTI * 2, DMA0tickFrom, tickDMA0, conflicts)) {
+        if (DMA0tickFrom < chSlots.getStartPoint()) {
+          DMA0tickFrom = chSlots.getStartPoint();
           conflicts = true;
         }
         else
           conflicts = false;
-        tickDMA0 = ChStartPoint[reqCh];
+        tickDMA0 = chSlots.getStartPoint();
       }
       else {
         if (conflicts)
           DMA0tickFrom = tickDMA0;
       }
       if (DMA0tickFrom == tmpTick)
-        InsertFreeSlot(ChFreeSlots[reqCh], latANTI * 2, DMA0tickFrom, tickDMA0,
-                       ChStartPoint[reqCh], 1);
+        chSlots.insert(latANTI * 2, DMA0tickFrom, tickDMA0, true);
         //******************************************************************//
 #if 1
       // Manage MergedTimeSlots
@@ -562,6 +473,19 @@ void PAL2::TimelineScheduling(Command &req, CPDPBP &reqCPD) {
     // 6) Write-back latency on RequestLL
     req.finished = tsDMA1.EndTick;
 
+    // Commands scheduled into earlier free slot cannot be pipelined
+    DieCommand &last = LastCommand[reqDieIdx];
+
+    if (last.operation == OPER_NUM || last.endTick < tsDMA1.EndTick) {
+      last.operation = req.operation;
+      last.copyback = req.copyback;
+      last.plane = reqCPD.Plane;
+      last.block = reqCPD.Block;
+      last.page = reqCPD.Page;
+      last.dma1Start = tsDMA1.StartTick;
+      last.endTick = tsDMA1.EndTick;
+    }
+
     // categorize the time spent for read/write operation
     std::map<uint64_t, uint64_t>::iterator e;
     e = OpTimeStamp[req.operation].find(tsDMA0.StartTick);
@@ -583,11 +507,33 @@ void PAL2::TimelineScheduling(Command &req, CPDPBP &reqCPD) {
     stats->AddLatency(req, &reqCPD, reqDieIdx, tsDMA0, tsMEM, tsDMA1);
 #endif
 #endif
+  }
+}
 
-    if (req.operation == OPER_ERASE || req.mergeSnapshot) {
-      stats->MergeSnapshot();
-    }
+// Cache read: Cell array read of next page starts when data of current page
+// is moved to cache register, so it overlaps DMA1 of current page.
+// Cache program: Data-in of next page goes to cache register while current
+// page is programmed, so DMA0 of next page overlaps program.
+uint64_t PAL2::GetHiddenLatency(Command &req, CPDPBP &reqCPD, uint32_t dieIdx,
+                                uint64_t latDMA0, uint64_t latMEM) {
+  DieCommand &prev = LastCommand[dieIdx];
+
+  if (req.copyback || prev.copyback || prev.operation != req.operation ||
+      prev.plane != reqCPD.Plane || prev.block != reqCPD.Block ||
+      prev.page + 1 != reqCPD.Page) {
+    return 0;
+  }
+
+  if (req.operation == OPER_READ && UseCacheRead &&
+      req.arrived < prev.endTick) {
+    return MIN(latMEM, prev.endTick - MAX(req.arrived, prev.dma1Start));
+  }
+  else if (req.operation == OPER_WRITE && UseCacheProgram &&
+           req.arrived < prev.dma1Start) {
+    return MIN(latMEM, MIN(latDMA0, prev.dma1Start - req.arrived));
   }
+
+  return 0;
 }
 
 void PAL2::submit(Command &cmd, CPDPBP &addr) {
@@ -646,39 +592,6 @@ void PAL2::FlushTimeSlots(uint64_t currentTick) {
   stats->Ticks_Total.update();
 }
 
-void PAL2::FlushFreeSlots(uint64_t currentTick) {
-  for (uint32_t i = 0; i < pParam->channel; i++) {
-    FlushAFreeSlot(ChFreeSlots[i], currentTick);
-  }
-  for (uint32_t i = 0; i < totalDie; i++) {
-    FlushAFreeSlot(DieFreeSlots[i], currentTick);
-  }
-
-  FlushATimeSlotBusyTime(MergedTimeSlots, currentTick, &(stats->ExactBusyTime));
-
-  stats->Access_Capacity.update();
-  stats->Ticks_Total.update();
-}
-
-void PAL2::FlushAFreeSlot(
-    std::map<uint64_t, std::map<uint64_t, uint64_t> *> &tgtFreeSlot,
-    uint64_t currentTick) {
-  for (std::map<uint64_t, std::map<uint64_t, uint64_t> *>::iterator e =
-           tgtFreeSlot.begin();
-       e != tgtFreeSlot.end(); e++) {
-    std::map<uint64_t, uint64_t>::iterator f = (e->second)->begin();
-    std::map<uint64_t, uint64_t>::iterator g = (e->second)->end();
-
-    for (; f != g;) {
-      // count++;
-      if (f->second < currentTick)
-        (e->second)->erase(f++);
-      else
-        break;
-    }
-  }
-}
-
 std::list<TimeSlot>::iterator PAL2::FindFreeTime(
     std::list<TimeSlot> &tgtTimeSlot, uint64_t tickLen, uint64_t fromTick) {
   auto cur = tgtTimeSlot.begin();
@@ -721,148 +634,6 @@ std::list<TimeSlot>::iterator PAL2::FindFreeTime(
   return cur;
 }
 
-bool PAL2::FindFreeTime(
-    std::map<uint64_t, std::map<uint64_t, uint64_t> *> &tgtFreeSlot,
-    uint64_t tickLen, uint64_t tickFrom, uint64_t &startTick, bool &conflicts) {
-  auto e = tgtFreeSlot.upper_bound(tickLen);
-  if (e == tgtFreeSlot.end()) {
-    e--;  // Jie: tgtFreeSlot is not empty
-    auto f = (e->second)->upper_bound(tickFrom);
-    if (f != (e->second)->begin()) {
-      f--;
-      if (f->second >= tickLen + tickFrom - (uint64_t)1) {
-        startTick = f->first;
-        conflicts = false;
-        return true;
-      }
-      f++;
-    }
-    while (f != (e->second)->end()) {
-      if (f->second >= tickLen + f->first - 1) {
-        startTick = f->first;
-        conflicts = true;
-        return true;
-      }
-      f++;
-    }
-    // reach this means no FreeSlot satisfy the requirement; allocate unused
-    // slots  startTick will be updated in upper function
-    conflicts = false;
-    return false;
-  }
-  if (e != tgtFreeSlot.begin())
-    e--;
-  uint64_t minTick = (uint64_t)-1;
-  while (e != tgtFreeSlot.end()) {
-    std::map<uint64_t, uint64_t>::iterator f =
-        (e->second)->upper_bound(tickFrom);
-    if (f != (e->second)->begin()) {
-      f--;
-      if (f->second >=
-          tickLen + tickFrom - (uint64_t)1) {  // this free slot is
-                                               // best fit one, skip
-                                               // checking others
-        startTick = f->first;
-        conflicts = false;
-        return true;
-      }
-      f++;
-    }
-    while (f != (e->second)->end()) {
-      if (f->second >= tickLen + f->first - (uint64_t)1) {
-        if (minTick == (uint64_t)-1 || minTick > f->first) {
-          conflicts = true;
-          minTick = f->first;
-        }
-        break;
-      }
-      f++;
-    }
-    e++;
-  }
-  if (minTick == (uint64_t)-1) {
-    // startTick will be updated in upper function
-    conflicts = false;
-    return false;
-  }
-  else {
-    startTick = minTick;
-    return true;
-  }
-}
-
-void PAL2::InsertFreeSlot(
-    std::map<uint64_t, std::map<uint64_t, uint64_t> *> &tgtFreeSlot,
-    uint64_t tickLen, uint64_t tickFrom, uint64_t startTick,
-    uint64_t &startPoint, bool split) {
-  if (startTick == startPoint) {
-    if (tickFrom == startTick) {
-      if (split)
-        AddFreeSlot(tgtFreeSlot, tickLen, startPoint);
-      startPoint = startPoint + tickLen;  // Jie: just need to shift startPoint
-    }
-    else {
-      assert(tickFrom > startTick);
-      if (split)
-        AddFreeSlot(tgtFreeSlot, tickLen, tickFrom);
-      startPoint = tickFrom + tickLen;
-      AddFreeSlot(tgtFreeSlot, tickFrom - startTick, startTick);
-    }
-  }
-  else {
-    std::pair<std::map<uint64_t, std::map<uint64_t, uint64_t> *>::iterator,
-              std::map<uint64_t, std::map<uint64_t, uint64_t> *>::iterator>
-        ePair;
-    ePair = tgtFreeSlot.equal_range(tickLen);
-    std::map<uint64_t, uint64_t>::iterator f;
-    std::map<uint64_t, std::map<uint64_t, uint64_t> *>::iterator e =
-        tgtFreeSlot.upper_bound(tickLen);
-    if (e != tgtFreeSlot.begin())
-      e--;
-    while (e != tgtFreeSlot.end()) {
-      f = e->second->find(startTick);
-      if (f != e->second->end()) {
-        uint64_t tmpStartTick = f->first;
-        uint64_t tmpEndTick = f->second;
-        e->second->erase(f);
-        if (tmpStartTick < tickFrom) {
-          AddFreeSlot(tgtFreeSlot, tickFrom - tmpStartTick, tmpStartTick);
-          if (split)
-            AddFreeSlot(tgtFreeSlot, tickLen, tickFrom);
-          assert(tmpEndTick - tickFrom + 1 >= tickLen);
-          if (tmpEndTick > tickLen + tickFrom - (uint64_t)1) {
-            AddFreeSlot(tgtFreeSlot, tmpEndTick - (tickFrom + tickLen - 1),
-                        tickFrom + tickLen);
-          }
-        }
-        else {
-          assert(tmpStartTick == tickFrom);
-          assert(tmpEndTick - tickFrom + 1 >= tickLen);
-          if (split)
-            AddFreeSlot(tgtFreeSlot, tickLen, tmpStartTick);
-          if (tmpEndTick > tickLen + tickFrom - (uint64_t)1) {
-            AddFreeSlot(tgtFreeSlot, tmpEndTick - (tickFrom + tickLen - 1),
-                        tmpStartTick + tickLen);
-          }
-        }
-        break;
-      }
-      e++;
-    }
-  }
-}
-
-void PAL2::AddFreeSlot(
-    std::map<uint64_t, std::map<uint64_t, uint64_t> *> &tgtFreeSlot,
-    uint64_t tickLen, uint64_t tickFrom) {
-  std::map<uint64_t, std::map<uint64_t, uint64_t> *>::iterator e;
-  e = tgtFreeSlot.upper_bound(tickLen);
-  if (e != tgtFreeSlot.begin()) {
-    e--;
-    (e->second)->insert(std::pair<uint64_t, uint64_t>(
-        tickFrom, tickFrom + tickLen - (uint64_t)1));
-  }
-}
 // PPN number conversion
 uint32_t PAL2::CPDPBPtoDieIdx(CPDPBP *pCPDPBP) {
   //[Channel][Package][Die];
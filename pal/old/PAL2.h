@@ -56,13 +56,30 @@ class PAL2  // let's not inherit PAL1
 
   std::map<uint64_t, uint64_t> OpTimeStamp[3];
 
-  std::map<uint64_t, std::map<uint64_t, uint64_t> *> *ChFreeSlots;
-  uint64_t *ChStartPoint;  // record the start point of rightmost free slot
-  std::map<uint64_t, std::map<uint64_t, uint64_t> *> *DieFreeSlots;
-  uint64_t *DieStartPoint;
+  std::vector<FreeSlotList> ChFreeSlots;
+  std::vector<FreeSlotList> DieFreeSlots;
+
+  // Cache read/program pipelines next page of a block with the command
+  // running on the die
+  bool UseCacheRead;
+  bool UseCacheProgram;
+
+  typedef struct {
+    PAL_OPERATION operation;  // OPER_NUM if no command is scheduled
+    bool copyback;
+    uint32_t plane;
+    uint32_t block;
+    uint32_t page;
+    uint64_t dma1Start;
+    uint64_t endTick;
+  } DieCommand;
+
+  std::vector<DieCommand> LastCommand;  // Latest scheduled command of die
 
   void submit(Command &cmd, CPDPBP &addr);
   void TimelineScheduling(Command &req, CPDPBP &reqCPD);
+  uint64_t GetHiddenLatency(Command &req, CPDPBP &reqCPD, uint32_t dieIdx,
+                            uint64_t latDMA0, uint64_t latMEM);
   void FlushTimeSlots(uint64_t currentTick);
   void FlushOpTimeStamp();
   void FlushATimeSlotBusyTime(std::list<TimeSlot> &tgtTimeSlot,
@@ -75,23 +92,6 @@ class PAL2  // let's not inherit PAL1
                                              uint64_t tickLen,
                                              uint64_t tickFrom);
 
-  // Jie: return: FreeSlot is found?
-  bool FindFreeTime(
-      std::map<uint64_t, std::map<uint64_t, uint64_t> *> &tgtFreeSlot,
-      uint64_t tickLen, uint64_t tickFrom, uint64_t &startTick,
-      bool &conflicts);
-  void InsertFreeSlot(
-      std::map<uint64_t, std::map<uint64_t, uint64_t> *> &tgtFreeSlot,
-      uint64_t tickLen, uint64_t tickFrom, uint64_t startTick,
-      uint64_t &startPoint, bool split);
-  void AddFreeSlot(
-      std::map<uint64_t, std::map<uint64_t, uint64_t> *> &tgtFreeSlot,
-      uint64_t tickLen, uint64_t tickFrom);
-  void FlushFreeSlots(uint64_t currentTick);
-  void FlushAFreeSlot(
-      std::map<uint64_t, std::map<uint64_t, uint64_t> *> &tgtFreeSlot,
-      uint64_t currentTick);
-
   // PPN Conversion related //ToDo: Shifted-Mode is also required for better
   // performance.
   uint32_t RearrangedSizes[7];
@@ -19,7 +19,230 @@
 
 #include "PAL2_TimeSlot.h"
 
+#include <algorithm>
+#include <cassert>
+
+#include "util/algorithm.hh"
+
 TimeSlot::TimeSlot(uint64_t startTick, uint64_t duration) {
   StartTick = startTick;
   EndTick = startTick + duration - 1;
 }
+
+static bool isBefore(uint64_t tick, const TimeSlot &slot) {
+  return tick < slot.StartTick;
+}
+
+static bool isAfter(const TimeSlot &slot, uint64_t tick) {
+  return slot.StartTick < tick;
+}
+
+FreeSlotList::FreeSlotList(uint64_t len)
+    : minLength(len), startPoint(0), head(0), capacity(0) {}
+
+uint64_t FreeSlotList::getStartPoint() {
+  return startPoint;
+}
+
+uint64_t FreeSlotList::getSlotCount() {
+  return slots.size() - head;
+}
+
+// Recalculate leaves of [from, to) and their ancestors
+void FreeSlotList::updateTree(uint64_t from, uint64_t to) {
+  if (from >= to) {
+    return;
+  }
+
+  for (uint64_t i = from; i < to; i++) {
+    if (i >= head && i < slots.size()) {
+      tree[capacity + i] = slots[i].EndTick - slots[i].StartTick + 1;
+    }
+    else {
+      tree[capacity + i] = 0;
+    }
+  }
+
+  uint64_t l = capacity + from;
+  uint64_t r = capacity + to - 1;
+
+  while (l > 1) {
+    l /= 2;
+    r /= 2;
+
+    for (uint64_t n = l; n <= r; n++) {
+      tree[n] = MAX(tree[2 * n], tree[2 * n + 1]);
+    }
+  }
+}
+
+// Drop pruned slots and resize tree
+void FreeSlotList::rebuildTree() {
+  slots.erase(slots.begin(), slots.begin() + head);
+  head = 0;
+
+  capacity = 16;
+
+  while (capacity < slots.size() * 2) {
+    capacity *= 2;
+  }
+
+  tree.assign(capacity * 2, 0);
+
+  updateTree(0, slots.size());
+}
+
+// Find first slot in [from, slots.size()) which is longer than tickLen
+uint64_t FreeSlotList::findFit(uint64_t node, uint64_t begin, uint64_t end,
+                               uint64_t from, uint64_t tickLen) {
+  if (end <= from || tree[node] < tickLen) {
+    return slots.size();
+  }
+
+  if (end - begin == 1) {
+    return begin;
+  }
+
+  uint64_t mid = (begin + end) / 2;
+  uint64_t ret = findFit(node * 2, begin, mid, from, tickLen);
+
+  if (ret == slots.size()) {
+    ret = findFit(node * 2 + 1, mid, end, from, tickLen);
+  }
+
+  return ret;
+}
+
+void FreeSlotList::addSlot(uint64_t tickLen, uint64_t tickFrom) {
+  if (tickLen < minLength) {
+    return;
+  }
+
+  auto iter = std::upper_bound(slots.begin() + head, slots.end(), tickFrom,
+                               isBefore);
+  uint64_t idx = iter - slots.begin();
+
+  slots.insert(iter, TimeSlot(tickFrom, tickLen));
+
+  if (slots.size() > capacity) {
+    rebuildTree();
+  }
+  else {
+    updateTree(idx, slots.size());
+  }
+}
+
+void FreeSlotList::eraseSlot(uint64_t idx) {
+  slots.erase(slots.begin() + idx);
+
+  updateTree(idx, slots.size() + 1);
+}
+
+bool FreeSlotList::find(uint64_t tickLen, uint64_t tickFrom,
+                        uint64_t &startTick, bool &conflicts) {
+  auto iter = std::upper_bound(slots.begin() + head, slots.end(), tickFrom,
+                               isBefore);
+  uint64_t idx = iter - slots.begin();
+
+  // Only the slot starts before tickFrom can contain tickFrom
+  if (idx > head) {
+    TimeSlot &slot = slots[idx - 1];
+
+    if (slot.EndTick >= tickLen + tickFrom - 1) {
+      startTick = slot.StartTick;
+      conflicts = false;
+
+      return true;
+    }
+  }
+
+  // Earliest slot after tickFrom which is long enough
+  if (capacity > 0) {
+    idx = findFit(1, 0, capacity, idx, tickLen);
+
+    if (idx < slots.size()) {
+      startTick = slots[idx].StartTick;
+      conflicts = true;
+
+      return true;
+    }
+  }
+
+  // startTick will be updated in upper function
+  conflicts = false;
+
+  return false;
+}
+
+void FreeSlotList::insert(uint64_t tickLen, uint64_t tickFrom,
+                          uint64_t startTick, bool split) {
+  if (startTick == startPoint) {
+    if (tickFrom == startTick) {
+      if (split) {
+        addSlot(tickLen, startPoint);
+      }
+
+      startPoint += tickLen;
+    }
+    else {
+      assert(tickFrom > startTick);
+
+      if (split) {
+        addSlot(tickLen, tickFrom);
+      }
+
+      startPoint = tickFrom + tickLen;
+      addSlot(tickFrom - startTick, startTick);
+    }
+  }
+  else {
+    auto iter = std::lower_bound(slots.begin() + head, slots.end(), startTick,
+                                 isAfter);
+
+    if (iter == slots.end() || iter->StartTick != startTick) {
+      return;
+    }
+
+    uint64_t tmpStartTick = iter->StartTick;
+    uint64_t tmpEndTick = iter->EndTick;
+
+    eraseSlot(iter - slots.begin());
+
+    if (tmpStartTick < tickFrom) {
+      addSlot(tickFrom - tmpStartTick, tmpStartTick);
+    }
+    else {
+      assert(tmpStartTick == tickFrom);
+    }
+
+    assert(tmpEndTick - tickFrom + 1 >= tickLen);
+
+    if (split) {
+      addSlot(tickLen, tickFrom);
+    }
+
+    if (tmpEndTick > tickLen + tickFrom - 1) {
+      addSlot(tmpEndTick - (tickFrom + tickLen - 1), tickFrom + tickLen);
+    }
+  }
+}
+
+// Drop slots which end before currentTick
+void FreeSlotList::prune(uint64_t currentTick) {
+  uint64_t begin = head;
+
+  while (head < slots.size() && slots[head].EndTick < currentTick) {
+    head++;
+  }
+
+  if (head == begin) {
+    return;
+  }
+
+  if (head * 2 > slots.size()) {
+    rebuildTree();
+  }
+  else {
+    updateTree(begin, head);
+  }
+}
@@ -30,6 +30,7 @@
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 using namespace std;
 
 struct TimeSlot {
@@ -40,4 +41,44 @@ struct TimeSlot {
   TimeSlot() : StartTick(0ull), EndTick(0ull){};
 };
 
+// Free time slots of one resource (channel or die)
+// Slots are kept in flat array sorted by StartTick, and a max-tree of slot
+// lengths over the array finds the earliest slot that fits in O(log n).
+// Slots which end before pruned tick are dropped from the front, so memory
+// is bounded by the number of slots in the scheduling window.
+class FreeSlotList {
+ private:
+  uint64_t minLength;  // Shorter slots are never used, so not stored
+  uint64_t startPoint;  // Start point of rightmost (unbounded) free slot
+
+  std::vector<TimeSlot> slots;  // Valid slots are [head, slots.size())
+  uint64_t head;
+  std::vector<uint64_t> tree;  // Max length of subtree, leaves at capacity
+  uint64_t capacity;
+
+  void addSlot(uint64_t tickLen, uint64_t tickFrom);
+  void eraseSlot(uint64_t idx);
+  void updateTree(uint64_t from, uint64_t to);
+  void rebuildTree();
+  uint64_t findFit(uint64_t node, uint64_t begin, uint64_t end, uint64_t from,
+                   uint64_t tickLen);
+
+ public:
+  FreeSlotList(uint64_t minLength = 0);
+
+  uint64_t getStartPoint();
+  uint64_t getSlotCount();
+
+  // Return true if free slot is found. startTick is start of the slot, and
+  // conflicts is true when the slot starts after tickFrom.
+  bool find(uint64_t tickLen, uint64_t tickFrom, uint64_t &startTick,
+            bool &conflicts);
+
+  // Occupy [tickFrom, tickFrom + tickLen) from free slot starts at startTick
+  void insert(uint64_t tickLen, uint64_t tickFrom, uint64_t startTick,
+              bool split);
+
+  void prune(uint64_t currentTick);
+};
+
 #endif
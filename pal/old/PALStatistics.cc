@@ -175,6 +175,63 @@ void PALStatistics::ValueOper::printstat(const char *) {}
 //   }
 // }
 
+PALStatistics::EpochRing::EpochRing() {
+  init();
+}
+
+void PALStatistics::EpochRing::init() {
+  memset(epochs, 0, sizeof(epochs));
+  last = 0;
+}
+
+void PALStatistics::EpochRing::add(uint64_t tick, uint32_t oper,
+                                   uint64_t bytes, uint64_t latency) {
+  uint64_t id = tick / EPOCH_INTERVAL;
+
+  // Too old, already overwritten
+  if (id + EPOCH_RING_SIZE <= last) {
+    return;
+  }
+
+  // Clear slots of new epochs
+  if (id > last) {
+    for (uint64_t i = MAX(last + 1, id - MIN(id, EPOCH_RING_SIZE - 1));
+         i <= id; i++) {
+      Epoch &epoch = epochs[i % EPOCH_RING_SIZE];
+
+      memset(&epoch, 0, sizeof(Epoch));
+      epoch.id = i;
+    }
+
+    last = id;
+  }
+
+  Epoch &epoch = epochs[id % EPOCH_RING_SIZE];
+
+  epoch.count[oper]++;
+  epoch.bytes[oper] += bytes;
+  epoch.ticks[oper] += latency;
+}
+
+void PALStatistics::EpochRing::sum(uint64_t begin, uint64_t end,
+                                   Epoch &total) {
+  memset(&total, 0, sizeof(Epoch));
+
+  for (uint64_t i = begin; i < end; i++) {
+    Epoch &epoch = epochs[i % EPOCH_RING_SIZE];
+
+    if (epoch.id != i) {
+      continue;
+    }
+
+    for (int j = 0; j < OPER_NUM; j++) {
+      total.count[j] += epoch.count[j];
+      total.bytes[j] += epoch.bytes[j];
+      total.ticks[j] += epoch.ticks[j];
+    }
+  }
+}
+
 void PALStatistics::getTickStat(OperStats &stat) {
   stat.read = Ticks_Total.vals[OPER_READ].avg();
   stat.write = Ticks_Total.vals[OPER_WRITE].avg();
@@ -301,6 +358,51 @@ void PALStatistics::getDieActiveTimeAll(ActiveTime &stat) {
   stat.average /= totalDie;
 }
 
+// Bandwidth (B/s), IOPS and average latency (ps) of commands finished in
+// last EPOCH_WINDOW epochs before tick
+void PALStatistics::getWindowStat(uint64_t tick, OperStats &bandwidth,
+                                  OperStats &iops, OperStats &latency) {
+  uint64_t end = tick / EPOCH_INTERVAL;
+  uint64_t begin = end - MIN(end, EPOCH_WINDOW);
+  double sec = (double)(end - begin) * EPOCH_INTERVAL / 1e+12;
+  double count = 0.;
+  double ticks = 0.;
+  EpochRing::Epoch total;
+
+  bandwidth = OperStats();
+  iops = OperStats();
+  latency = OperStats();
+
+  if (begin == end) {
+    return;
+  }
+
+  Access_Epochs.sum(begin, end, total);
+
+  for (int i = 0; i < OPER_NUM; i++) {
+    count += total.count[i];
+    ticks += total.ticks[i];
+  }
+
+  bandwidth.read = total.bytes[OPER_READ] / sec;
+  bandwidth.write = total.bytes[OPER_WRITE] / sec;
+  bandwidth.erase = total.bytes[OPER_ERASE] / sec;
+  bandwidth.total = bandwidth.read + bandwidth.write;
+
+  iops.read = total.count[OPER_READ] / sec;
+  iops.write = total.count[OPER_WRITE] / sec;
+  iops.erase = total.count[OPER_ERASE] / sec;
+  iops.total = count / sec;
+
+  latency.read = SAFEDIV((double)total.ticks[OPER_READ],
+                         total.count[OPER_READ]);
+  latency.write = SAFEDIV((double)total.ticks[OPER_WRITE],
+                          total.count[OPER_WRITE]);
+  latency.erase = SAFEDIV((double)total.ticks[OPER_ERASE],
+                          total.count[OPER_ERASE]);
+  latency.total = SAFEDIV(ticks, count);
+}
+
 void PALStatistics::PrintDieIdleTicks(uint32_t, uint64_t, uint64_t) {}
 // void PALStatistics::PrintDieIdleTicks(uint32_t die_num, uint64_t sim_time_ps,
 //                                       uint64_t idle_power_nw) {
@@ -588,6 +690,7 @@ void PALStatistics::InitStats() {
   Access_Iops.init();
   Access_Iops_widle.init();
   Access_Oper_Iops.init();
+  Access_Epochs.init();
 }
 
 void PALStatistics::ClearStats() {
@@ -595,14 +698,6 @@ void PALStatistics::ClearStats() {
   delete[] PPN_requested_die;
   delete[] Ticks_Active_ch;
   delete[] Ticks_Active_die;
-
-  for (auto &iter : Ticks_Total_snapshot) {
-    delete iter.second;
-  }
-
-  for (auto &iter : Access_Capacity_snapshot) {
-    delete iter.second;
-  }
 }
 
 void PALStatistics::UpdateLastTick(uint64_t tick) {
@@ -614,30 +709,6 @@ uint64_t PALStatistics::GetLastTick() {
   return LastTick;
 }
 
-void PALStatistics::MergeSnapshot() {
-  if (Ticks_Total_snapshot.size() != 0) {
-    std::map<uint64_t, ValueOper *>::iterator e = Ticks_Total_snapshot.end();
-    e--;
-    for (std::map<uint64_t, ValueOper *>::iterator f =
-             Ticks_Total_snapshot.begin();
-         f != e;) {
-      delete f->second;
-      Ticks_Total_snapshot.erase(f++);
-    }
-  }
-  if (Access_Capacity_snapshot.size() != 0) {
-    std::map<uint64_t, ValueOper *>::iterator e =
-        Access_Capacity_snapshot.end();
-    e--;
-    for (std::map<uint64_t, ValueOper *>::iterator f =
-             Access_Capacity_snapshot.begin();
-         f != e;) {
-      delete f->second;
-      Access_Capacity_snapshot.erase(f++);
-    }
-  }
-}
-
 #if GATHER_RESOURCE_CONFLICT
 void PALStatistics::AddLatency(Command &CMD, CPDPBP *CPD, uint32_t dieIdx,
                                TimeSlot &DMA0, TimeSlot &MEM, TimeSlot &DMA1,
@@ -650,7 +721,8 @@ void PALStatistics::AddLatency(Command &CMD, CPDPBP *CPD, uint32_t dieIdx,
   uint32_t oper = CMD.operation;
   uint32_t chIdx = CPD->Channel;
   uint64_t time_all[TICK_STAT_NUM];
-  uint8_t pageType = lat->GetPageType(CPD->Page);
+  uint8_t pageType =
+      CMD.slc ? (uint8_t)PAGE_LSB : lat->GetPageType(CPD->Page);
   memset(time_all, 0, sizeof(time_all));
 
   /*
@@ -666,16 +738,14 @@ void PALStatistics::AddLatency(Command &CMD, CPDPBP *CPD, uint32_t dieIdx,
   time_all[TICK_DMA0WAIT] =
       DMA0.StartTick -
       CMD.arrived;  // FETCH_WAIT --> when DMA0 couldn't start immediatly
-  time_all[TICK_DMA0] = lat->GetLatency(CPD->Page, CMD.operation, BUSY_DMA0);
+  time_all[TICK_DMA0] = CMD.getBusyLatency(lat, CPD->Page, BUSY_DMA0);
   time_all[TICK_DMA0_SUSPEND] = 0;  // no suspend in new design
-  time_all[TICK_MEM] = lat->GetLatency(CPD->Page, CMD.operation, BUSY_MEM);
+  time_all[TICK_MEM] = CMD.getBusyLatency(lat, CPD->Page, BUSY_MEM);
+  time_all[TICK_DMA1] = CMD.getBusyLatency(lat, CPD->Page, BUSY_DMA1);
   time_all[TICK_DMA1WAIT] =
       (MEM.EndTick - MEM.StartTick + 1) -
-      (lat->GetLatency(CPD->Page, CMD.operation, BUSY_DMA0) +
-       lat->GetLatency(CPD->Page, CMD.operation, BUSY_MEM) +
-       lat->GetLatency(CPD->Page, CMD.operation,
-                       BUSY_DMA1));  // --> when DMA1 didn't start immediatly.
-  time_all[TICK_DMA1] = lat->GetLatency(CPD->Page, CMD.operation, BUSY_DMA1);
+      (time_all[TICK_DMA0] + time_all[TICK_MEM] +
+       time_all[TICK_DMA1]);  // --> when DMA1 didn't start immediatly.
   time_all[TICK_DMA1_SUSPEND] = 0;  // no suspend in new design
   time_all[TICK_FULL] =
       DMA1.EndTick - CMD.arrived + 1;  // D0W+D0+M+D1W+D1 full latency
@@ -707,10 +777,11 @@ void PALStatistics::AddLatency(Command &CMD, CPDPBP *CPD, uint32_t dieIdx,
   Ticks_Total.add(oper, time_all[TICK_FULL]);
   //***********************************************
   // energy = [nW] * [ps] / [10^9] = [pJ]
+  // Cell array is still busy during hidden part of memory operation
   uint64_t energy_dma0 = lat->GetPower(CMD.operation, BUSY_DMA0) *
                          time_all[TICK_DMA0] / 1000000000;
-  uint64_t energy_mem =
-      lat->GetPower(CMD.operation, BUSY_MEM) * time_all[TICK_MEM] / 1000000000;
+  uint64_t energy_mem = lat->GetPower(CMD.operation, BUSY_MEM) *
+                        (time_all[TICK_MEM] + CMD.hidden) / 1000000000;
   uint64_t energy_dma1 = lat->GetPower(CMD.operation, BUSY_DMA1) *
                          time_all[TICK_DMA1] / 1000000000;
   Energy_DMA0.add(oper, energy_dma0);
@@ -719,118 +790,21 @@ void PALStatistics::AddLatency(Command &CMD, CPDPBP *CPD, uint32_t dieIdx,
   Energy_Total.add(oper, energy_dma0 + energy_mem + energy_dma1);
   // printf("[Energy(fJ) of Oper(%d)] DMA0(%llu) MEM(%llu) DMA1(%llu)\n", oper,
   // energy_dma0, energy_mem, energy_dma1);
-  uint64_t finished_time = CMD.finished;
-  uint64_t update_point = finished_time / EPOCH_INTERVAL;
-  std::map<uint64_t, ValueOper *>::iterator e =
-      Ticks_Total_snapshot.find(update_point);
-  if (e != Ticks_Total_snapshot.end())
-    e->second->add(oper, time_all[TICK_FULL]);
-  else {
-    e = Ticks_Total_snapshot.upper_bound(update_point);
-    if (e != Ticks_Total_snapshot.end()) {
-      if (e != Ticks_Total_snapshot.begin()) {
-        e--;
-        Ticks_Total_snapshot[update_point] = new ValueOper(e->second);
-      }
-      else {
-        Ticks_Total_snapshot[update_point] = new ValueOper();
-      }
-    }
-    else {
-      if (Ticks_Total_snapshot.size() == 0)
-        Ticks_Total_snapshot[update_point] = new ValueOper();
-      else {
-        e--;
-        Ticks_Total_snapshot[update_point] = new ValueOper(e->second);
-      }
-    }
-    Ticks_Total_snapshot[update_point]->add(oper, time_all[TICK_FULL]);
-  }
-
-  e = Ticks_Total_snapshot.upper_bound(update_point);
-  while (e != Ticks_Total_snapshot.end()) {
-    e->second->add(oper, time_all[TICK_FULL]);
-
-    e = Ticks_Total_snapshot.upper_bound(e->first);
-  }
   //***********************************************
   Ticks_TotalOpti.add(oper, time_all[TICK_PROC]);
   Ticks_Active_ch[chIdx].add(oper, time_all[TICK_DMA0] + time_all[TICK_DMA1]);
   Ticks_Active_die[dieIdx].add(oper,
                                (time_all[TICK_DMA0] + time_all[TICK_MEM] +
                                 time_all[TICK_DMA1WAIT] + time_all[TICK_DMA1]));
+  uint64_t capacity =
+      gconf->readUint(SimpleSSD::CONFIG_PAL, SimpleSSD::PAL::NAND_PAGE_SIZE);
   if (oper == OPER_ERASE)
-    Access_Capacity.add(
-        oper,
-        gconf->readUint(SimpleSSD::CONFIG_PAL, SimpleSSD::PAL::NAND_PAGE_SIZE) *
-            gconf->readUint(SimpleSSD::CONFIG_PAL,
-                            SimpleSSD::PAL::NAND_PAGE));  // ERASE
-  else
-    Access_Capacity.add(
-        oper, gconf->readUint(SimpleSSD::CONFIG_PAL,
-                              SimpleSSD::PAL::NAND_PAGE_SIZE));  // READ,WRITE
-  //************************************************
-  update_point = finished_time / EPOCH_INTERVAL;
-  std::map<uint64_t, ValueOper *>::iterator f =
-      Access_Capacity_snapshot.find(update_point);
-  if (f != Access_Capacity_snapshot.end()) {
-    if (oper == OPER_ERASE)
-      f->second->add(oper,
-                     gconf->readUint(SimpleSSD::CONFIG_PAL,
-                                     SimpleSSD::PAL::NAND_PAGE_SIZE) *
-                         gconf->readUint(SimpleSSD::CONFIG_PAL,
-                                         SimpleSSD::PAL::NAND_PAGE));  // ERASE
-    else
-      f->second->add(
-          oper, gconf->readUint(SimpleSSD::CONFIG_PAL,
-                                SimpleSSD::PAL::NAND_PAGE_SIZE));  // READ,WRITE
-  }
-  else {
-    f = Access_Capacity_snapshot.upper_bound(update_point);
-    if (f != Access_Capacity_snapshot.end()) {
-      if (f != Access_Capacity_snapshot.begin()) {
-        f--;
-        Access_Capacity_snapshot[update_point] = new ValueOper(f->second);
-      }
-      else {
-        Access_Capacity_snapshot[update_point] = new ValueOper();
-      }
-    }
-    else {
-      if (Access_Capacity_snapshot.size() == 0)
-        Access_Capacity_snapshot[update_point] = new ValueOper();
-      else {
-        f--;
-        Access_Capacity_snapshot[update_point] = new ValueOper(f->second);
-      }
-    }
-
-    if (oper == OPER_ERASE)
-      Access_Capacity_snapshot[update_point]->add(
-          oper, gconf->readUint(SimpleSSD::CONFIG_PAL,
-                                SimpleSSD::PAL::NAND_PAGE_SIZE) *
-                    gconf->readUint(SimpleSSD::CONFIG_PAL,
-                                    SimpleSSD::PAL::NAND_PAGE));  // ERASE
-    else
-      Access_Capacity_snapshot[update_point]->add(
-          oper, gconf->readUint(SimpleSSD::CONFIG_PAL,
-                                SimpleSSD::PAL::NAND_PAGE_SIZE));  // READ,WRITE
-  }
-  f = Access_Capacity_snapshot.upper_bound(update_point);
-  while (f != Access_Capacity_snapshot.end()) {
-    if (oper == OPER_ERASE)
-      f->second->add(oper,
-                     gconf->readUint(SimpleSSD::CONFIG_PAL,
-                                     SimpleSSD::PAL::NAND_PAGE_SIZE) *
-                         gconf->readUint(SimpleSSD::CONFIG_PAL,
-                                         SimpleSSD::PAL::NAND_PAGE));  // ERASE
-    else
-      f->second->add(
-          oper, gconf->readUint(SimpleSSD::CONFIG_PAL,
-                                SimpleSSD::PAL::NAND_PAGE_SIZE));  // READ,WRITE
-    f = Access_Capacity_snapshot.upper_bound(f->first);
-  }
+    capacity *= gconf->readUint(SimpleSSD::CONFIG_PAL,
+                                SimpleSSD::PAL::NAND_PAGE);  // ERASE
+  capacity *= CMD.planes;
+  Access_Capacity.add(oper, capacity);
   //************************************************
+  Access_Epochs.add(CMD.finished, oper, capacity, time_all[TICK_FULL]);
 }
 
 /*
@@ -848,28 +822,21 @@ void PALStatistics::PrintFinalStats(uint64_t sim_time_ps) {
   // DPRINTF(PAL, "%.2f\t\t\t, %.2f\n", sim_time_ps * 1.0 / 1000000000,
   //         SampledExactBusyTime * 1.0 / 1000000000);
 
-  assert(Access_Capacity_snapshot.size() > 0);
-  std::map<uint64_t, ValueOper *>::iterator e = Access_Capacity_snapshot.end();
-  e--;
+  ValueOper *e = &Access_Capacity;
 
-  e->second->printstat("Info of Access Capacity");
-  Access_Bandwidth.printstat_bandwidth(e->second, SampledExactBusyTime,
+  e->printstat("Info of Access Capacity");
+  Access_Bandwidth.printstat_bandwidth(e, SampledExactBusyTime,
                                        LastExactBusyTime);
-  Access_Bandwidth_widle.printstat_bandwidth_widle(e->second, sim_time_ps,
+  Access_Bandwidth_widle.printstat_bandwidth_widle(e, sim_time_ps,
                                                    LastExecutionTime);
-  Access_Oper_Bandwidth.printstat_oper_bandwidth(e->second, OpBusyTime,
-                                                 LastOpBusyTime);
-
-  assert(Ticks_Total_snapshot.size() > 0);
-  std::map<uint64_t, ValueOper *>::iterator f = Ticks_Total_snapshot.end();
-  f--;
-
-  f->second->printstat_latency("Info of Latency");
-  Access_Iops.printstat_iops(e->second, SampledExactBusyTime,
-                             LastExactBusyTime);
-  Access_Iops_widle.printstat_iops_widle(e->second, sim_time_ps,
-                                         LastExecutionTime);
-  Access_Oper_Iops.printstat_oper_iops(e->second, OpBusyTime, LastOpBusyTime);
+  Access_Oper_Bandwidth.printstat_oper_bandwidth(e, OpBusyTime, LastOpBusyTime);
+
+  ValueOper *f = &Ticks_Total;
+
+  f->printstat_latency("Info of Latency");
+  Access_Iops.printstat_iops(e, SampledExactBusyTime, LastExactBusyTime);
+  Access_Iops_widle.printstat_iops_widle(e, sim_time_ps, LastExecutionTime);
+  Access_Oper_Iops.printstat_oper_iops(e, OpBusyTime, LastOpBusyTime);
   // DPRINTF(PAL, "===================\n");
   PPN_requested_rwe.printstat("Num of PPN IO request");
   // DPRINTF(PAL, "===================\n");
@@ -972,9 +939,10 @@ void PALStatistics::PrintStats(uint64_t sim_time_ps) {
   // fDPRINTF(PAL, "Busy Performance: %Lf MB/Sec\n",
   //          (long double)TRANSFER_TOTAL_MB / BUSY_TIME_SEC);
 
-  std::map<uint64_t, ValueOper *>::iterator e =
-      Access_Capacity_snapshot.find(sim_time_ps / EPOCH_INTERVAL - 1);
-  if (sim_time_ps > 0 && e != Access_Capacity_snapshot.end()) {
+  ValueOper *e = &Access_Capacity;
+  ValueOper *f = &Ticks_Total;
+
+  if (sim_time_ps > 0) {
     PPN_requested_rwe.printstat("Num of PPN IO request");
     // DPRINTF(PAL, "===================\n");
 
@@ -1035,77 +1003,28 @@ void PALStatistics::PrintStats(uint64_t sim_time_ps) {
     }
     // DPRINTF(PAL, "===================\n")
 
-    e->second->printstat("Info of Access Capacity");
+    e->printstat("Info of Access Capacity");
     // DPRINTF(PAL, "Total execution time (ms)\n");
     // DPRINTF(PAL, "%.2f\n", SampledExactBusyTime * 1.0 / 1000000000);
-    Access_Bandwidth.printstat_bandwidth(e->second, SampledExactBusyTime,
+    Access_Bandwidth.printstat_bandwidth(e, SampledExactBusyTime,
                                          LastExactBusyTime);
-    Access_Bandwidth_widle.printstat_bandwidth_widle(e->second, sim_time_ps,
+    Access_Bandwidth_widle.printstat_bandwidth_widle(e, sim_time_ps,
                                                      LastExecutionTime);
-    Access_Oper_Bandwidth.printstat_oper_bandwidth(e->second, OpBusyTime,
+    Access_Oper_Bandwidth.printstat_oper_bandwidth(e, OpBusyTime,
                                                    LastOpBusyTime);
-    std::map<uint64_t, ValueOper *>::iterator f =
-        Ticks_Total_snapshot.find(sim_time_ps / EPOCH_INTERVAL - 1);
-    f->second->printstat_latency("Info of Latency");
-    Access_Iops.printstat_iops(e->second, SampledExactBusyTime,
-                               LastExactBusyTime);
-    Access_Iops_widle.printstat_iops_widle(e->second, sim_time_ps,
-                                           LastExecutionTime);
-    Access_Oper_Iops.printstat_oper_iops(e->second, OpBusyTime, LastOpBusyTime);
+    f->printstat_latency("Info of Latency");
+    Access_Iops.printstat_iops(e, SampledExactBusyTime, LastExactBusyTime);
+    Access_Iops_widle.printstat_iops_widle(e, sim_time_ps, LastExecutionTime);
+    Access_Oper_Iops.printstat_oper_iops(e, OpBusyTime, LastOpBusyTime);
     LastExactBusyTime = SampledExactBusyTime;
     LastExecutionTime = sim_time_ps;
     LastOpBusyTime[0] = OpBusyTime[0];
     LastOpBusyTime[1] = OpBusyTime[1];
     LastOpBusyTime[2] = OpBusyTime[2];
-    std::map<uint64_t, ValueOper *>::iterator g =
-        Access_Capacity_snapshot.upper_bound(sim_time_ps / EPOCH_INTERVAL - 1);
-    if (g != Access_Capacity_snapshot.end()) {
-      for (int i = 0; i < OPER_ALL; i++) {
-        g->second->vals[i].sampled_sum = e->second->vals[i].sum;
-        g->second->vals[i].sampled_cnt = e->second->vals[i].cnt;
-        e->second->vals[i].sampled_sum = e->second->vals[i].sum;
-        e->second->vals[i].sampled_cnt = e->second->vals[i].cnt;
-      }
-    }
-    else {
-      Access_Capacity_snapshot[sim_time_ps / EPOCH_INTERVAL] = new ValueOper(
-          Access_Capacity_snapshot[sim_time_ps / EPOCH_INTERVAL - 1]);
-      for (int i = 0; i < OPER_ALL; i++) {
-        Access_Capacity_snapshot[sim_time_ps / EPOCH_INTERVAL]
-            ->vals[i]
-            .sampled_sum = e->second->vals[i].sum;
-        Access_Capacity_snapshot[sim_time_ps / EPOCH_INTERVAL]
-            ->vals[i]
-            .sampled_cnt = e->second->vals[i].cnt;
-      }
-    }
-    std::map<uint64_t, ValueOper *>::iterator h =
-        Ticks_Total_snapshot.upper_bound(sim_time_ps / EPOCH_INTERVAL - 1);
-    if (h != Ticks_Total_snapshot.end()) {
-      for (int i = 0; i < OPER_ALL; i++) {
-        h->second->vals[i].sampled_sum = f->second->vals[i].sum;
-        h->second->vals[i].sampled_cnt = f->second->vals[i].cnt;
-        f->second->vals[i].sampled_sum = f->second->vals[i].sum;
-        f->second->vals[i].sampled_cnt = f->second->vals[i].cnt;
-      }
-    }
-    else {
-      Ticks_Total_snapshot[sim_time_ps / EPOCH_INTERVAL] =
-          new ValueOper(Ticks_Total_snapshot[sim_time_ps / EPOCH_INTERVAL - 1]);
-      for (int i = 0; i < OPER_ALL; i++) {
-        Ticks_Total_snapshot[sim_time_ps / EPOCH_INTERVAL]
-            ->vals[i]
-            .sampled_sum = f->second->vals[i].sum;
-        Ticks_Total_snapshot[sim_time_ps / EPOCH_INTERVAL]
-            ->vals[i]
-            .sampled_cnt = f->second->vals[i].cnt;
-      }
-    }
-    Access_Capacity_snapshot.erase(sim_time_ps / EPOCH_INTERVAL - 1);
-    Ticks_Total_snapshot.erase(sim_time_ps / EPOCH_INTERVAL - 1);
   }
 
   for (int i = 0; i < OPER_ALL; i++) {
     Access_Capacity.vals[i].backup();
+    Ticks_Total.vals[i].backup();
   }
 }
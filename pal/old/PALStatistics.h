@@ -49,23 +49,46 @@ typedef struct _Command {
   Tick finished;
   Addr ppn;
   PAL_OPERATION operation;
-  bool mergeSnapshot;
   uint64_t size;
 
+  // Copyback is program whose data comes from page register, not channel.
+  // sourcePage is page index of data read into page register.
+  bool copyback;
+  uint32_t sourcePage;
+
+  // Page of pSLC block stores one bit per cell, so it has LSB page timing
+  bool slc;
+
+  // Part of memory operation overlapped with previous command on the die by
+  // cache read/program. Set by scheduler.
+  uint64_t hidden;
+
+  // Planes accessed together by multi-plane operation. Command, address and
+  // data cycles are repeated for each plane, but cell array operates once.
+  uint32_t planes;
+
   _Command()
       : arrived(0),
         finished(0),
         ppn(0),
         operation(OPER_NUM),
-        mergeSnapshot(false),
-        size(0) {}
+        size(0),
+        copyback(false),
+        sourcePage(0),
+        slc(false),
+        hidden(0),
+        planes(1) {}
   _Command(Tick t, Addr a, PAL_OPERATION op, uint64_t s)
       : arrived(t),
         finished(0),
         ppn(a),
         operation(op),
-        mergeSnapshot(false),
-        size(s) {}
+        size(s),
+        copyback(false),
+        sourcePage(0),
+        slc(false),
+        hidden(0),
+        planes(1) {}
 
   Tick getLatency() {
     if (finished > 0) {
@@ -75,10 +98,41 @@ typedef struct _Command {
       return 0;
     }
   }
+
+  // Latency of each busy state when this command accesses page
+  uint64_t getBusyLatency(Latency *lat, uint32_t page, uint8_t busy) {
+    if (slc) {
+      page = 0;  // LSB page in both MLC and TLC
+    }
+
+    if (copyback) {
+      switch (busy) {
+        case BUSY_DMA0:  // Command cycles only
+          return lat->GetLatency(page, OPER_READ, BUSY_DMA0) * planes;
+        case BUSY_MEM:
+          return lat->GetLatency(sourcePage, OPER_READ, BUSY_MEM) +
+                 lat->GetLatency(page, OPER_WRITE, BUSY_MEM);
+        default:
+          return lat->GetLatency(page, OPER_WRITE, busy);
+      }
+    }
+
+    if (busy == BUSY_MEM) {
+      return lat->GetLatency(page, operation, busy) - hidden;
+    }
+    else if (busy == BUSY_DMA0 ||
+             (busy == BUSY_DMA1 && operation == OPER_READ)) {
+      return lat->GetLatency(page, operation, busy) * planes;
+    }
+
+    return lat->GetLatency(page, operation, busy);
+  }
 } Command;
 
 // From ftl_defs.hh
 #define EPOCH_INTERVAL 100000000000
+#define EPOCH_RING_SIZE 64  // Epochs kept for rolling window
+#define EPOCH_WINDOW 10     // Epochs in rolling window (1sec)
 
 class PALStatistics {
  public:
@@ -179,7 +233,6 @@ class PALStatistics {
   void AddLatency(Command &CMD, CPDPBP *CPD, uint32_t dieIdx, TimeSlot &DMA0,
                   TimeSlot &MEM, TimeSlot &DMA1);
 #endif
-  void MergeSnapshot();
   uint64_t ExactBusyTime, SampledExactBusyTime;
   uint64_t OpBusyTime[3], LastOpBusyTime[3];  // 0: Read, 1: Write, 2: Erase;
   uint64_t LastExactBusyTime;
@@ -225,6 +278,7 @@ class PALStatistics {
   void getDieActiveTime(uint32_t, ActiveTime &);
   void getChannelActiveTimeAll(ActiveTime &);
   void getDieActiveTimeAll(ActiveTime &);
+  void getWindowStat(uint64_t, OperStats &, OperStats &, OperStats &);
 
   class Counter {
    public:
@@ -291,6 +345,26 @@ class PALStatistics {
     void printstat_energy(const char *namestr);
   };
 
+  // Counters of recent epochs, indexed by epoch % EPOCH_RING_SIZE
+  class EpochRing {
+   public:
+    struct Epoch {
+      uint64_t id;  // Finished tick / EPOCH_INTERVAL
+      uint64_t count[OPER_NUM];
+      uint64_t bytes[OPER_NUM];
+      uint64_t ticks[OPER_NUM];  // Sum of latency
+    };
+
+    EpochRing();
+    void init();
+    void add(uint64_t tick, uint32_t oper, uint64_t bytes, uint64_t latency);
+    void sum(uint64_t begin, uint64_t end, Epoch &total);  // [begin, end)
+
+   private:
+    Epoch epochs[EPOCH_RING_SIZE];
+    uint64_t last;  // Latest epoch in ring
+  };
+
   ValueOper Ticks_DMA0WAIT;
   ValueOper Ticks_DMA0;
   ValueOper Ticks_MEM;
@@ -303,12 +377,11 @@ class PALStatistics {
   ValueOper Energy_DMA1;
   ValueOper Energy_Total;
 
-  std::map<uint64_t, ValueOper *> Ticks_Total_snapshot;
   ValueOper Ticks_TotalOpti;    // TotalOpti = D0+M+D1 --- exclude WAIT
   ValueOper *Ticks_Active_ch;   // channels
   ValueOper *Ticks_Active_die;  // dies
   ValueOper Access_Capacity;
-  std::map<uint64_t, ValueOper *> Access_Capacity_snapshot;
+  EpochRing Access_Epochs;
   ValueOper Access_Bandwidth;
   ValueOper Access_Bandwidth_widle;
   ValueOper Access_Oper_Bandwidth;
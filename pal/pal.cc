@@ -19,13 +19,16 @@
 
 #include "pal/pal.hh"
 
+#include "pal/pal_lite.hh"
 #include "pal/pal_old.hh"
+#include "pal/pal_queue.hh"
 
 namespace SimpleSSD {
 
 namespace PAL {
 
-PAL::PAL(ConfigReader &c) : conf(c) {
+PAL::PAL(ConfigReader &c)
+    : nandType((NAND_TYPE)c.readInt(CONFIG_PAL, NAND_FLASH_TYPE)), conf(c) {
   static const char name[4][16] = {"Channel", "Way", "Die", "Plane"};
   uint32_t value[4];
   uint8_t superblock = conf.getSuperblockConfig();
@@ -110,7 +113,17 @@ PAL::PAL(ConfigReader &c) : conf(c) {
       param.channel * param.package * param.die * param.plane * param.block,
       param.superBlock);
 
-  pPAL = new PALOLD(param, c);
+  switch (conf.readUint(CONFIG_PAL, PAL_ENGINE)) {
+    case PAL_ENGINE_QUEUE:
+      pPAL = new PALQueue(param, c);
+      break;
+    case PAL_ENGINE_LITE:
+      pPAL = new PALLite(param, c);
+      break;
+    default:
+      pPAL = new PALOLD(param, c);
+      break;
+  }
 }
 
 PAL::~PAL() {
@@ -129,14 +142,26 @@ void PAL::erase(Request &req, uint64_t &tick) {
   pPAL->erase(req, tick);
 }
 
-void PAL::copyback(uint32_t, uint32_t, uint32_t, uint64_t &) {
-  panic("Copyback not implemented");
+void PAL::copyback(Request &from, Request &to, uint64_t &tick) {
+  pPAL->copyback(from, to, tick);
 }
 
 Parameter *PAL::getInfo() {
   return &param;
 }
 
+// Type of page index in block, when block is programmed in normal mode
+PAGE_TYPE PAL::getPageType(uint32_t pageIndex) {
+  PAGE_TYPE type = pPAL->getPageType(pageIndex);
+
+  // MLC has no CSB, and its upper page is reported as CSB
+  if (nandType == NAND_MLC && type == PAGE_TYPE_CSB) {
+    type = PAGE_TYPE_MSB;
+  }
+
+  return type;
+}
+
 void PAL::getStatList(std::vector<Stats> &list, std::string prefix) {
   pPAL->getStatList(list, prefix + "pal.");
 }
@@ -42,10 +42,19 @@ typedef struct {
   uint32_t pageInSuperPage;  //!< # pages in one superpage
 } Parameter;
 
+// Type of page in multi-level cell, in order of read latency
+typedef enum {
+  PAGE_TYPE_LSB,
+  PAGE_TYPE_CSB,
+  PAGE_TYPE_MSB,
+  PAGE_TYPE_NUM,
+} PAGE_TYPE;
+
 class PAL : public StatObject {
  private:
   Parameter param;
   AbstractPAL *pPAL;
+  NAND_TYPE nandType;
 
   ConfigReader &conf;
 
@@ -56,9 +65,10 @@ class PAL : public StatObject {
   void read(Request &, uint64_t &);
   void write(Request &, uint64_t &);
   void erase(Request &, uint64_t &);
-  void copyback(uint32_t, uint32_t, uint32_t, uint64_t &);
+  void copyback(Request &, Request &, uint64_t &);
 
   Parameter *getInfo();
+  PAGE_TYPE getPageType(uint32_t);
 
   void getStatList(std::vector<Stats> &, std::string) override;
   void getStatValues(std::vector<double> &) override;
@@ -0,0 +1,457 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pal/pal_lite.hh"
+
+#include <cstring>
+
+#include "pal/old/Latency.h"
+#include "pal/old/LatencyMLC.h"
+#include "pal/old/LatencySLC.h"
+#include "pal/old/LatencyTLC.h"
+#include "pal/old/PALStatistics.h"
+#include "util/algorithm.hh"
+
+namespace SimpleSSD {
+
+namespace PAL {
+
+PALLite::PALLite(Parameter &p, ConfigReader &c)
+    : AbstractPAL(p, c), lastResetTick(0) {
+  Config::NANDTiming *pTiming = c.getNANDTiming();
+  Config::NANDPower *pPower = c.getNANDPower();
+
+  memset(&stat, 0, sizeof(stat));
+
+  switch (conf.readInt(CONFIG_PAL, NAND_FLASH_TYPE)) {
+    case NAND_SLC:
+      lat = new LatencySLC(*pTiming, *pPower);
+      break;
+    case NAND_MLC:
+      lat = new LatencyMLC(*pTiming, *pPower);
+      break;
+    case NAND_TLC:
+      lat = new LatencyTLC(*pTiming, *pPower);
+      break;
+  }
+
+  Resource empty;
+
+  memset(&empty, 0, sizeof(empty));
+
+  dies.resize(param.channel * param.package * param.die, empty);
+  channels.resize(param.channel, empty);
+
+  debugprint(LOG_PAL_LITE, "%u dies in %u channels",
+             (uint32_t)dies.size(), param.channel);
+}
+
+PALLite::~PALLite() {
+  delete lat;
+}
+
+uint32_t PALLite::getDieIndex(::CPDPBP &addr) {
+  return addr.Die + addr.Package * param.die +
+         addr.Channel * param.die * param.package;
+}
+
+// Insert idle gap at idx, dropping the oldest one when full
+void PALLite::addGap(Resource &res, uint32_t idx, uint64_t begin,
+                     uint64_t end) {
+  if (begin >= end) {
+    return;
+  }
+
+  if (res.gapCount == MAX_IDLE_GAPS) {
+    if (idx == 0) {
+      return;
+    }
+
+    memmove(res.gaps, res.gaps + 1, sizeof(Gap) * (MAX_IDLE_GAPS - 1));
+    res.gapCount--;
+    idx--;
+  }
+
+  memmove(res.gaps + idx + 1, res.gaps + idx,
+          sizeof(Gap) * (res.gapCount - idx));
+  res.gaps[idx] = {begin, end};
+  res.gapCount++;
+}
+
+// Drop idle gaps which end before tick, as no command can use them
+void PALLite::pruneGap(Resource &res, uint64_t tick) {
+  uint32_t count = 0;
+
+  while (count < res.gapCount && res.gaps[count].end <= tick) {
+    count++;
+  }
+
+  if (count > 0) {
+    memmove(res.gaps, res.gaps + count, sizeof(Gap) * (res.gapCount - count));
+    res.gapCount -= count;
+  }
+}
+
+// Return earliest time at or after tick which is free for len
+uint64_t PALLite::findSlot(Resource &res, uint64_t tick, uint64_t len) {
+  if (tick >= res.freeAt) {
+    return tick;
+  }
+
+  // Arrived out of order, use earliest idle gap which fits
+  for (uint32_t i = 0; i < res.gapCount; i++) {
+    uint64_t beginAt = MAX(tick, res.gaps[i].begin);
+
+    if (beginAt + len <= res.gaps[i].end) {
+      return beginAt;
+    }
+  }
+
+  return res.freeAt;
+}
+
+// Occupy resource from tick for len, where tick is returned by findSlot()
+void PALLite::reserve(Resource &res, uint64_t tick, uint64_t len) {
+  res.busy += len;
+
+  if (tick >= res.freeAt) {
+    addGap(res, res.gapCount, res.freeAt, tick);
+    res.freeAt = tick + len;
+
+    return;
+  }
+
+  for (uint32_t i = 0; i < res.gapCount; i++) {
+    Gap gap = res.gaps[i];
+
+    if (gap.begin <= tick && tick + len <= gap.end) {
+      // Split gap
+      memmove(res.gaps + i, res.gaps + i + 1,
+              sizeof(Gap) * (res.gapCount - i - 1));
+      res.gapCount--;
+
+      addGap(res, i, tick + len, gap.end);
+      addGap(res, i, gap.begin, tick);
+
+      return;
+    }
+  }
+
+  panic("Reserved time is not free");
+}
+
+// Die must be free from DMA0 to the end of DMA1, which moves back when
+// channel is not free at DMA0 or DMA1. If die time does not fit in the idle
+// gap of die, command is placed once more after the last command of die,
+// where die is always free. Unlike PAL2, search is not repeated.
+void PALLite::submit(::Command &req, ::CPDPBP &addr) {
+  Resource &die = dies[getDieIndex(addr)];
+  Resource &channel = channels[addr.Channel];
+  OperStat &operStat = stat.oper[req.operation];
+  uint64_t dma0 = req.getBusyLatency(lat, addr.Page, BUSY_DMA0);
+  uint64_t mem = req.getBusyLatency(lat, addr.Page, BUSY_MEM);
+  uint64_t dma1 = req.getBusyLatency(lat, addr.Page, BUSY_DMA1);
+  uint64_t work = dma0 + mem + dma1;
+  uint64_t beginAt;
+  uint64_t dma0At;
+  uint64_t dma1At;
+
+  pruneGap(die, getTick());
+  pruneGap(channel, getTick());
+
+  beginAt = findSlot(die, req.arrived, work);
+
+  for (int pass = 0; pass < 2; pass++) {
+    dma0At = findSlot(channel, beginAt, dma0);
+    dma1At = dma0At + dma0 + mem;
+
+    if (req.operation == OPER_READ) {
+      dma1At = findSlot(channel, dma1At, dma1);
+    }
+
+    if (findSlot(die, beginAt, dma1At + dma1 - beginAt) == beginAt) {
+      break;
+    }
+
+    beginAt = die.freeAt;
+  }
+
+  // DMA0 ends before DMA1, so reserving DMA0 does not move DMA1
+  reserve(channel, dma0At, dma0);
+
+  if (req.operation == OPER_READ) {
+    reserve(channel, dma1At, dma1);
+  }
+
+  reserve(die, beginAt, dma1At + dma1 - beginAt);
+
+  req.finished = dma1At + dma1;
+
+  operStat.count += req.planes;
+  operStat.commands++;
+  operStat.waitTime += req.finished - req.arrived - work;
+  operStat.totalTime += req.finished - req.arrived;
+
+  if (req.copyback) {
+    stat.copybackCount += req.planes;
+  }
+
+  stat.lastFinishedAt = MAX(stat.lastFinishedAt, req.finished);
+}
+
+void PALLite::read(Request &req, uint64_t &tick) {
+  uint64_t finishedAt = tick;
+  ::Command cmd(tick, 0, OPER_READ, param.superPageSize);
+  std::vector<::CPDPBP> list;
+
+  cmd.slc = req.slc;
+
+  printPPN(req, "READ");
+
+  convertCPDPBP(req, list);
+
+  for (uint64_t i = 0; i < list.size(); i += cmd.planes) {
+    auto &iter = list.at(i);
+
+    printCPDPBP(iter, "READ");
+
+    cmd.planes = getMultiPlaneCount(list, i);
+
+    submit(cmd, iter);
+
+    finishedAt = MAX(finishedAt, cmd.finished);
+  }
+
+  tick = finishedAt;
+}
+
+void PALLite::write(Request &req, uint64_t &tick) {
+  uint64_t finishedAt = tick;
+  ::Command cmd(tick, 0, OPER_WRITE, param.superPageSize);
+  std::vector<::CPDPBP> list;
+
+  cmd.slc = req.slc;
+
+  printPPN(req, "WRITE");
+
+  convertCPDPBP(req, list);
+
+  for (uint64_t i = 0; i < list.size(); i += cmd.planes) {
+    auto &iter = list.at(i);
+
+    printCPDPBP(iter, "WRITE");
+
+    cmd.planes = getMultiPlaneCount(list, i);
+
+    submit(cmd, iter);
+
+    finishedAt = MAX(finishedAt, cmd.finished);
+  }
+
+  tick = finishedAt;
+}
+
+void PALLite::erase(Request &req, uint64_t &tick) {
+  uint64_t finishedAt = tick;
+  ::Command cmd(tick, 0, OPER_ERASE, param.superPageSize * param.page);
+  std::vector<::CPDPBP> list;
+
+  cmd.slc = req.slc;
+
+  printPPN(req, "ERASE");
+
+  convertCPDPBP(req, list);
+
+  for (uint64_t i = 0; i < list.size(); i += cmd.planes) {
+    auto &iter = list.at(i);
+
+    printCPDPBP(iter, "ERASE");
+
+    cmd.planes = getMultiPlaneCount(list, i);
+
+    submit(cmd, iter);
+
+    finishedAt = MAX(finishedAt, cmd.finished);
+  }
+
+  tick = finishedAt;
+}
+
+void PALLite::copyback(Request &from, Request &to, uint64_t &tick) {
+  uint64_t finishedAt = tick;
+  ::Command cmd(tick, 0, OPER_WRITE, param.superPageSize);
+  std::vector<::CPDPBP> source;
+  std::vector<::CPDPBP> list;
+
+  printPPN(from, "CBSRC");
+  printPPN(to, "CBDST");
+
+  convertCPDPBP(from, source);
+  convertCPDPBP(to, list);
+
+  if (source.size() != list.size()) {
+    panic("I/O flag of copyback source and destination does not match");
+  }
+
+  cmd.copyback = true;
+
+  for (uint64_t i = 0; i < list.size(); i += cmd.planes) {
+    auto &src = source.at(i);
+    auto &dst = list.at(i);
+
+    if (src.Channel != dst.Channel || src.Package != dst.Package ||
+        src.Die != dst.Die || src.Plane != dst.Plane) {
+      panic("Copyback across planes is not supported");
+    }
+
+    printCPDPBP(dst, "CPBK");
+
+    cmd.sourcePage = src.Page;
+    cmd.planes =
+        MIN(getMultiPlaneCount(source, i), getMultiPlaneCount(list, i));
+
+    submit(cmd, dst);
+
+    finishedAt = MAX(finishedAt, cmd.finished);
+  }
+
+  tick = finishedAt;
+}
+
+PAGE_TYPE PALLite::getPageType(uint32_t pageIndex) {
+  return (PAGE_TYPE)lat->GetPageType(pageIndex);
+}
+
+void PALLite::printCPDPBP(::CPDPBP &addr, const char *prefix) {
+  debugprint(LOG_PAL_LITE,
+             "%-5s | C %5u | W %5u | D %5u | P %5u | B %5u | P %5u", prefix,
+             addr.Channel, addr.Package, addr.Die, addr.Plane, addr.Block,
+             addr.Page);
+}
+
+void PALLite::printPPN(Request &req, const char *prefix) {
+  debugprint(LOG_PAL_LITE, "%-5s | Block %u | Page %u", prefix,
+             req.blockIndex, req.pageIndex);
+}
+
+void PALLite::getStatList(std::vector<Stats> &list, std::string prefix) {
+  static const char name[OPER_NUM][8] = {"read", "program", "erase"};
+  Stats temp;
+
+  for (int i = 0; i < OPER_NUM; i++) {
+    temp.name = prefix + name[i] + ".count";
+    temp.desc = std::string("Total ") + name[i] + " operation count";
+    list.push_back(temp);
+  }
+
+  temp.name = prefix + "copyback.count";
+  temp.desc = "Total copyback operation count";
+  list.push_back(temp);
+
+  for (int i = 0; i < OPER_NUM; i++) {
+    temp.name = prefix + name[i] + ".bytes";
+    temp.desc = std::string("Total ") + name[i] + " operation bytes";
+    list.push_back(temp);
+  }
+
+  for (int i = 0; i < OPER_NUM; i++) {
+    temp.name = prefix + name[i] + ".time.wait";
+    temp.desc = std::string("Average queueing delay of ") + name[i];
+    list.push_back(temp);
+
+    temp.name = prefix + name[i] + ".time.total";
+    temp.desc = std::string("Average time of ") + name[i];
+    list.push_back(temp);
+  }
+
+  temp.name = prefix + "utilization.die";
+  temp.desc = "Average utilization of dies";
+  list.push_back(temp);
+
+  temp.name = prefix + "utilization.channel";
+  temp.desc = "Average utilization of channels";
+  list.push_back(temp);
+}
+
+void PALLite::getStatValues(std::vector<double> &values) {
+  uint64_t elapsed = 0;
+  uint64_t dieBusy = 0;
+  uint64_t channelBusy = 0;
+
+  for (int i = 0; i < OPER_NUM; i++) {
+    values.push_back(stat.oper[i].count);
+  }
+
+  values.push_back(stat.copybackCount);
+
+  values.push_back(stat.oper[OPER_READ].count * param.pageSize);
+  values.push_back(stat.oper[OPER_WRITE].count * param.pageSize);
+  values.push_back(stat.oper[OPER_ERASE].count * param.pageSize * param.page);
+
+  for (int i = 0; i < OPER_NUM; i++) {
+    OperStat &operStat = stat.oper[i];
+
+    if (operStat.commands > 0) {
+      values.push_back((double)operStat.waitTime / operStat.commands);
+      values.push_back((double)operStat.totalTime / operStat.commands);
+    }
+    else {
+      values.push_back(0.);
+      values.push_back(0.);
+    }
+  }
+
+  if (stat.lastFinishedAt > lastResetTick) {
+    elapsed = stat.lastFinishedAt - lastResetTick;
+  }
+
+  for (auto &iter : dies) {
+    dieBusy += iter.busy;
+  }
+
+  for (auto &iter : channels) {
+    channelBusy += iter.busy;
+  }
+
+  if (elapsed > 0) {
+    values.push_back((double)dieBusy / dies.size() / elapsed);
+    values.push_back((double)channelBusy / channels.size() / elapsed);
+  }
+  else {
+    values.push_back(0.);
+    values.push_back(0.);
+  }
+}
+
+void PALLite::resetStatValues() {
+  memset(&stat, 0, sizeof(stat));
+  lastResetTick = getTick();
+
+  for (auto &iter : dies) {
+    iter.busy = 0;
+  }
+
+  for (auto &iter : channels) {
+    iter.busy = 0;
+  }
+}
+
+}  // namespace PAL
+
+}  // namespace SimpleSSD
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PAL_PAL_LITE__
+#define __PAL_PAL_LITE__
+
+#include <cinttypes>
+#include <vector>
+
+#include "pal/abstract_pal.hh"
+#include "util/old/SimpleSSD_types.h"
+
+struct _Command;
+class Latency;
+
+#define MAX_IDLE_GAPS 64  // Idle gaps kept for each die and channel
+
+namespace SimpleSSD {
+
+namespace PAL {
+
+// Simplified timeline NAND model for design space exploration
+// Like PAL2, each die and channel reserves busy time on its timeline, but
+// only the time it becomes free and the latest MAX_IDLE_GAPS idle gaps are
+// kept. Gaps in the past are pruned, and the oldest gap is dropped when full,
+// so a command costs at most O(MAX_IDLE_GAPS) regardless of queue length.
+// No per-plane timing or NAND power statistics are recorded.
+// Die is held from DMA0 to the end of DMA1, including the time waiting for
+// other dies of its channel to transfer data. Command (and data-in) cycles
+// take channel at DMA0, and data-out of read takes it again after cell
+// array operation. DMA1 of program and erase is one status cycle, so
+// channel is not reserved.
+class PALLite : public AbstractPAL {
+ private:
+  typedef struct {
+    uint64_t begin;
+    uint64_t end;
+  } Gap;
+
+  typedef struct {
+    uint64_t freeAt;          // End of last reserved time
+    Gap gaps[MAX_IDLE_GAPS];  // Idle gaps before freeAt, in time order
+    uint32_t gapCount;
+    uint64_t busy;  // Sum of reserved time since stat reset
+  } Resource;
+
+  typedef struct {
+    uint64_t count;     // Pages
+    uint64_t commands;  // Multi-plane operation is one command
+    uint64_t waitTime;  // Sum of die and channel queueing delay
+    uint64_t totalTime;
+  } OperStat;
+
+  ::Latency *lat;
+
+  std::vector<Resource> dies;
+  std::vector<Resource> channels;
+
+  uint64_t lastResetTick;
+
+  struct {
+    uint64_t copybackCount;
+    OperStat oper[OPER_NUM];
+    uint64_t lastFinishedAt;
+  } stat;
+
+  uint32_t getDieIndex(::CPDPBP &);
+
+  void addGap(Resource &, uint32_t, uint64_t, uint64_t);
+  void pruneGap(Resource &, uint64_t);
+  uint64_t findSlot(Resource &, uint64_t, uint64_t);
+  void reserve(Resource &, uint64_t, uint64_t);
+  void submit(::_Command &, ::CPDPBP &);
+
+  void printCPDPBP(::CPDPBP &, const char *);
+  void printPPN(Request &, const char *);
+
+ public:
+  PALLite(Parameter &, ConfigReader &);
+  ~PALLite();
+
+  void read(Request &, uint64_t &) override;
+  void write(Request &, uint64_t &) override;
+  void erase(Request &, uint64_t &) override;
+  void copyback(Request &, Request &, uint64_t &) override;
+
+  PAGE_TYPE getPageType(uint32_t) override;
+
+  void getStatList(std::vector<Stats> &, std::string) override;
+  void getStatValues(std::vector<double> &) override;
+  void resetStatValues() override;
+};
+
+}  // namespace PAL
+
+}  // namespace SimpleSSD
+
+#endif
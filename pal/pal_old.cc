@@ -76,9 +76,9 @@ PALOLD::PALOLD(Parameter &p, ConfigReader &c)
   stats = new PALStatistics(&conf, lat);
   pal = new PAL2(stats, &param, &conf, lat);
 
-  // We will periodically flush timeslot for saving memory
+  // We will periodically flush busy timeslot for saving memory
+  // Free slots are pruned by PAL2 itself while scheduling
   flushFunction = [this](uint64_t tick) {
-    pal->FlushFreeSlots(tick - FLUSH_RANGE);
     pal->FlushTimeSlots(tick - FLUSH_RANGE);
 
     schedule(flushEvent, tick + FLUSH_PERIOD);
@@ -98,15 +98,29 @@ void PALOLD::read(Request &req, uint64_t &tick) {
   ::Command cmd(tick, 0, OPER_READ, param.superPageSize);
   std::vector<::CPDPBP> list;
 
+  cmd.slc = req.slc;
+
   printPPN(req, "READ");
 
   convertCPDPBP(req, list);
 
-  for (auto &iter : list) {
+  for (uint64_t i = 0; i < list.size(); i += cmd.planes) {
+    auto &iter = list.at(i);
+
     printCPDPBP(iter, "READ");
 
+    cmd.planes = getMultiPlaneCount(list, i);
+
     pal->submit(cmd, iter);
-    stat.readCount++;
+    stat.readCount += cmd.planes;
+
+    if (cmd.planes > 1) {
+      stat.multiPlaneCount++;
+    }
+
+    if (cmd.hidden > 0) {
+      stat.cacheReadCount++;
+    }
 
     finishedAt = MAX(finishedAt, cmd.finished);
   }
@@ -119,15 +133,29 @@ void PALOLD::write(Request &req, uint64_t &tick) {
   ::Command cmd(tick, 0, OPER_WRITE, param.superPageSize);
   std::vector<::CPDPBP> list;
 
+  cmd.slc = req.slc;
+
   printPPN(req, "WRITE");
 
   convertCPDPBP(req, list);
 
-  for (auto &iter : list) {
+  for (uint64_t i = 0; i < list.size(); i += cmd.planes) {
+    auto &iter = list.at(i);
+
     printCPDPBP(iter, "WRITE");
 
+    cmd.planes = getMultiPlaneCount(list, i);
+
     pal->submit(cmd, iter);
-    stat.writeCount++;
+    stat.writeCount += cmd.planes;
+
+    if (cmd.planes > 1) {
+      stat.multiPlaneCount++;
+    }
+
+    if (cmd.hidden > 0) {
+      stat.cacheProgramCount++;
+    }
 
     finishedAt = MAX(finishedAt, cmd.finished);
   }
@@ -140,15 +168,25 @@ void PALOLD::erase(Request &req, uint64_t &tick) {
   ::Command cmd(tick, 0, OPER_ERASE, param.superPageSize * param.page);
   std::vector<::CPDPBP> list;
 
+  cmd.slc = req.slc;
+
   printPPN(req, "ERASE");
 
   convertCPDPBP(req, list);
 
-  for (auto &iter : list) {
+  for (uint64_t i = 0; i < list.size(); i += cmd.planes) {
+    auto &iter = list.at(i);
+
     printCPDPBP(iter, "ERASE");
 
+    cmd.planes = getMultiPlaneCount(list, i);
+
     pal->submit(cmd, iter);
-    stat.eraseCount++;
+    stat.eraseCount += cmd.planes;
+
+    if (cmd.planes > 1) {
+      stat.multiPlaneCount++;
+    }
 
     finishedAt = MAX(finishedAt, cmd.finished);
   }
@@ -156,165 +194,54 @@ void PALOLD::erase(Request &req, uint64_t &tick) {
   tick = finishedAt;
 }
 
-void PALOLD::convertCPDPBP(Request &req, std::vector<::CPDPBP> &list) {
-  ::CPDPBP addr;
-  static uint32_t pageAllocation = conf.getPageAllocationConfig();
-  static uint8_t superblock = conf.getSuperblockConfig();
-  static bool useMultiplaneOP =
-      conf.readBoolean(CONFIG_PAL, NAND_USE_MULTI_PLANE_OP);
-  static uint32_t pageInSuperPage = param.pageInSuperPage;
-  static bool bRandomTweak =
-      conf.readBoolean(CONFIG_FTL, FTL::FTL_USE_RANDOM_IO_TWEAK);
-  uint32_t value[4];
-  uint32_t *ptr[4];
-  uint64_t tmp = req.blockIndex;
-  int count = 0;
-
-  if (bRandomTweak && req.ioFlag.size() != pageInSuperPage) {
-    panic("Invalid size of I/O flag");
-  }
+void PALOLD::copyback(Request &from, Request &to, uint64_t &tick) {
+  uint64_t finishedAt = tick;
+  ::Command cmd(tick, 0, OPER_WRITE, param.superPageSize);
+  std::vector<::CPDPBP> source;
+  std::vector<::CPDPBP> list;
 
-  if (!bRandomTweak && req.ioFlag.size() != pageInSuperPage) {
-    req.ioFlag = Bitset(pageInSuperPage);
-    req.ioFlag.set();
-  }
+  printPPN(from, "CBSRC");
+  printPPN(to, "CBDST");
 
-  list.clear();
-
-  addr.Plane = 0;
-
-  for (int i = 0; i < 4; i++) {
-    uint8_t idx = (pageAllocation >> (i * 8)) & 0xFF;
-
-    switch (idx) {
-      case INDEX_CHANNEL:
-        if (superblock & INDEX_CHANNEL) {
-          value[count] = param.channel;
-          ptr[count++] = &addr.Channel;
-        }
-        else {
-          addr.Channel = tmp % param.channel;
-          tmp /= param.channel;
-        }
-
-        break;
-      case INDEX_PACKAGE:
-        if (superblock & INDEX_PACKAGE) {
-          value[count] = param.package;
-          ptr[count++] = &addr.Package;
-        }
-        else {
-          addr.Package = tmp % param.package;
-          tmp /= param.package;
-        }
-
-        break;
-      case INDEX_DIE:
-        if (superblock & INDEX_DIE) {
-          value[count] = param.die;
-          ptr[count++] = &addr.Die;
-        }
-        else {
-          addr.Die = tmp % param.die;
-          tmp /= param.die;
-        }
-
-        break;
-      case INDEX_PLANE:
-        if (!useMultiplaneOP) {
-          if (superblock & INDEX_PLANE) {
-            value[count] = param.plane;
-            ptr[count++] = &addr.Plane;
-          }
-          else {
-            addr.Plane = tmp % param.plane;
-            tmp /= param.plane;
-          }
-        }
-
-        break;
-      default:
-        break;
-    }
-  }
+  convertCPDPBP(from, source);
+  convertCPDPBP(to, list);
 
-  addr.Block = tmp;
-  addr.Page = req.pageIndex;
-
-  // Index of ioFlag
-  tmp = 0;
-
-  if (count == 4) {
-    list.reserve(value[0] * value[1] * value[2] * value[3]);
-
-    for (uint32_t i = 0; i < value[3]; i++) {
-      for (uint32_t j = 0; j < value[2]; j++) {
-        for (uint32_t k = 0; k < value[1]; k++) {
-          for (uint32_t l = 0; l < value[0]; l++) {
-            if (req.ioFlag.test(tmp++)) {
-              *ptr[0] = l;
-              *ptr[1] = k;
-              *ptr[2] = j;
-              *ptr[3] = i;
-
-              list.push_back(addr);
-            }
-          }
-        }
-      }
-    }
-  }
-  else if (count == 3) {
-    list.reserve(value[0] * value[1] * value[2]);
-
-    for (uint32_t j = 0; j < value[2]; j++) {
-      for (uint32_t k = 0; k < value[1]; k++) {
-        for (uint32_t l = 0; l < value[0]; l++) {
-          if (req.ioFlag.test(tmp++)) {
-            *ptr[0] = l;
-            *ptr[1] = k;
-            *ptr[2] = j;
-
-            list.push_back(addr);
-          }
-        }
-      }
-    }
+  if (source.size() != list.size()) {
+    panic("I/O flag of copyback source and destination does not match");
   }
-  else if (count == 2) {
-    list.reserve(value[0] * value[1]);
-
-    for (uint32_t k = 0; k < value[1]; k++) {
-      for (uint32_t l = 0; l < value[0]; l++) {
-        if (req.ioFlag.test(tmp++)) {
-          *ptr[0] = l;
-          *ptr[1] = k;
-
-          list.push_back(addr);
-        }
-      }
-    }
-  }
-  else if (count == 1) {
-    list.reserve(value[0]);
 
-    for (uint32_t l = 0; l < value[0]; l++) {
-      if (req.ioFlag.test(tmp++)) {
-        *ptr[0] = l;
+  cmd.copyback = true;
+
+  for (uint64_t i = 0; i < list.size(); i += cmd.planes) {
+    auto &src = source.at(i);
+    auto &dst = list.at(i);
 
-        list.push_back(addr);
-      }
+    if (src.Channel != dst.Channel || src.Package != dst.Package ||
+        src.Die != dst.Die || src.Plane != dst.Plane) {
+      panic("Copyback across planes is not supported");
     }
-  }
-  else {
-    if (req.ioFlag.test(tmp++)) {
-      list.push_back(addr);
+
+    printCPDPBP(dst, "CPBK");
+
+    cmd.sourcePage = src.Page;
+    cmd.planes =
+        MIN(getMultiPlaneCount(source, i), getMultiPlaneCount(list, i));
+
+    pal->submit(cmd, dst);
+    stat.copybackCount += cmd.planes;
+
+    if (cmd.planes > 1) {
+      stat.multiPlaneCount++;
     }
-  }
 
-  if (tmp != pageInSuperPage) {
-    panic("I/O flag size != # pages in super page");
+    finishedAt = MAX(finishedAt, cmd.finished);
   }
+
+  tick = finishedAt;
+}
+
+PAGE_TYPE PALOLD::getPageType(uint32_t pageIndex) {
+  return (PAGE_TYPE)lat->GetPageType(pageIndex);
 }
 
 void PALOLD::printCPDPBP(::CPDPBP &addr, const char *prefix) {
@@ -364,6 +291,22 @@ void PALOLD::getStatList(std::vector<Stats> &list, std::string prefix) {
   temp.desc = "Total erase operation count";
   list.push_back(temp);
 
+  temp.name = prefix + "copyback.count";
+  temp.desc = "Total copyback operation count";
+  list.push_back(temp);
+
+  temp.name = prefix + "multiplane.count";
+  temp.desc = "Total multi-plane operation count";
+  list.push_back(temp);
+
+  temp.name = prefix + "read.cache.count";
+  temp.desc = "Read operations pipelined by cache read";
+  list.push_back(temp);
+
+  temp.name = prefix + "program.cache.count";
+  temp.desc = "Program operations pipelined by cache program";
+  list.push_back(temp);
+
   temp.name = prefix + "read.bytes";
   temp.desc = "Total read operation bytes";
   list.push_back(temp);
@@ -455,6 +398,38 @@ void PALOLD::getStatList(std::vector<Stats> &list, std::string prefix) {
   temp.name = prefix + "die.time.active";
   temp.desc = "Average active time of all dies";
   list.push_back(temp);
+
+  temp.name = prefix + "window.bandwidth.read";
+  temp.desc = "Read bandwidth of last one second (B/s)";
+  list.push_back(temp);
+
+  temp.name = prefix + "window.bandwidth.program";
+  temp.desc = "Program bandwidth of last one second (B/s)";
+  list.push_back(temp);
+
+  temp.name = prefix + "window.iops.read";
+  temp.desc = "Read IOPS of last one second";
+  list.push_back(temp);
+
+  temp.name = prefix + "window.iops.program";
+  temp.desc = "Program IOPS of last one second";
+  list.push_back(temp);
+
+  temp.name = prefix + "window.iops.erase";
+  temp.desc = "Erase IOPS of last one second";
+  list.push_back(temp);
+
+  temp.name = prefix + "window.time.read";
+  temp.desc = "Average time of read in last one second";
+  list.push_back(temp);
+
+  temp.name = prefix + "window.time.program";
+  temp.desc = "Average time of program in last one second";
+  list.push_back(temp);
+
+  temp.name = prefix + "window.time.erase";
+  temp.desc = "Average time of erase in last one second";
+  list.push_back(temp);
 }
 
 void PALOLD::getStatValues(std::vector<double> &values) {
@@ -479,6 +454,10 @@ void PALOLD::getStatValues(std::vector<double> &values) {
   values.push_back(stat.readCount);
   values.push_back(stat.writeCount);
   values.push_back(stat.eraseCount);
+  values.push_back(stat.copybackCount);
+  values.push_back(stat.multiPlaneCount);
+  values.push_back(stat.cacheReadCount);
+  values.push_back(stat.cacheProgramCount);
 
   values.push_back(stat.readCount * param.pageSize);
   values.push_back(stat.writeCount * param.pageSize);
@@ -513,6 +492,19 @@ void PALOLD::getStatValues(std::vector<double> &values) {
 
   stats->getDieActiveTimeAll(active);
   values.push_back(active.average);
+
+  PALStatistics::OperStats bandwidth;
+  PALStatistics::OperStats iops;
+
+  stats->getWindowStat(getTick(), bandwidth, iops, ticks);
+  values.push_back(bandwidth.read);
+  values.push_back(bandwidth.write);
+  values.push_back(iops.read);
+  values.push_back(iops.write);
+  values.push_back(iops.erase);
+  values.push_back(ticks.read);
+  values.push_back(ticks.write);
+  values.push_back(ticks.erase);
 }
 
 void PALOLD::resetStatValues() {
@@ -529,6 +521,10 @@ void PALOLD::read(::CPDPBP &addr, uint64_t &tick) {
   pal->submit(cmd, addr);
   stat.readCount++;
 
+  if (cmd.hidden > 0) {
+    stat.cacheReadCount++;
+  }
+
   tick = cmd.finished;
 }
 
@@ -539,6 +535,10 @@ void PALOLD::write(::CPDPBP &addr, uint64_t &tick) {
   pal->submit(cmd, addr);
   stat.writeCount++;
 
+  if (cmd.hidden > 0) {
+    stat.cacheProgramCount++;
+  }
+
   tick = cmd.finished;
 }
 
@@ -49,9 +49,12 @@ class PALOLD : public AbstractPAL {
     uint64_t readCount;
     uint64_t writeCount;
     uint64_t eraseCount;
+    uint64_t copybackCount;
+    uint64_t multiPlaneCount;
+    uint64_t cacheReadCount;  // Pipelined by cache read/program
+    uint64_t cacheProgramCount;
   } stat;
 
-  void convertCPDPBP(Request &, std::vector<::CPDPBP> &);
   void printCPDPBP(::CPDPBP &, const char *);
   void printPPN(Request &, const char *);
 
@@ -62,6 +65,9 @@ class PALOLD : public AbstractPAL {
   void read(Request &, uint64_t &) override;
   void write(Request &, uint64_t &) override;
   void erase(Request &, uint64_t &) override;
+  void copyback(Request &, Request &, uint64_t &) override;
+
+  PAGE_TYPE getPageType(uint32_t) override;
 
   void getStatList(std::vector<Stats> &, std::string) override;
   void getStatValues(std::vector<double> &) override;
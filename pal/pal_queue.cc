@@ -0,0 +1,633 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pal/pal_queue.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pal/old/Latency.h"
+#include "pal/old/LatencyMLC.h"
+#include "pal/old/LatencySLC.h"
+#include "pal/old/LatencyTLC.h"
+#include "pal/old/PALStatistics.h"
+#include "util/algorithm.hh"
+
+#define MAX_BYPASS 32  // Command is bypassed at most this many times
+
+namespace SimpleSSD {
+
+namespace PAL {
+
+PALQueue::PALQueue(Parameter &p, ConfigReader &c) : AbstractPAL(p, c) {
+  Config::NANDTiming *pTiming = c.getNANDTiming();
+  Config::NANDPower *pPower = c.getNANDPower();
+  uint32_t dieInChannel = param.package * param.die;
+
+  memset(&stat, 0, sizeof(stat));
+
+  policy = (SCHEDULING_POLICY)conf.readUint(CONFIG_PAL, PAL_SCHEDULING_POLICY);
+  useSuspend = conf.readBoolean(CONFIG_PAL, PAL_USE_SUSPEND);
+  maxSuspend = conf.readUint(CONFIG_PAL, PAL_MAX_SUSPEND);
+  suspendLatency = pTiming->suspend;
+
+  switch (conf.readInt(CONFIG_PAL, NAND_FLASH_TYPE)) {
+    case NAND_SLC:
+      lat = new LatencySLC(*pTiming, *pPower);
+      break;
+    case NAND_MLC:
+      lat = new LatencyMLC(*pTiming, *pPower);
+      break;
+    case NAND_TLC:
+      lat = new LatencyTLC(*pTiming, *pPower);
+      break;
+  }
+
+  channels.resize(param.channel);
+  dies.resize(param.channel * dieInChannel);
+
+  for (uint32_t i = 0; i < dies.size(); i++) {
+    dies[i].channel = i / dieInChannel;
+    dies[i].retireEvent =
+        allocate([this, i](uint64_t tick) { retire(i, tick); });
+  }
+
+  debugprint(LOG_PAL_QUEUE, "%u command queues, %s policy",
+             (uint32_t)dies.size(),
+             policy == POLICY_READ_FIRST
+                 ? "read first"
+                 : policy == POLICY_GC_LAST ? "GC last" : "FIFO");
+
+  if (useSuspend) {
+    debugprint(LOG_PAL_QUEUE,
+               "Program/erase suspend enabled, %u times in %" PRIu64 " ps",
+               maxSuspend, suspendLatency);
+  }
+}
+
+PALQueue::~PALQueue() {
+  delete lat;
+}
+
+uint8_t PALQueue::getPriority(PAL_OPERATION oper, bool gc) {
+  switch (policy) {
+    case POLICY_READ_FIRST:
+      return oper == OPER_READ ? 0 : 1;
+    case POLICY_GC_LAST:
+      return gc ? 1 : 0;
+    default:
+      return 0;
+  }
+}
+
+uint32_t PALQueue::getDieIndex(::CPDPBP &addr) {
+  return addr.Die + addr.Package * param.die +
+         addr.Channel * param.die * param.package;
+}
+
+// Find first tick after from, where channel is idle for len ticks
+uint64_t PALQueue::findChannel(uint32_t ch, uint64_t from, uint64_t len) {
+  auto &busy = channels[ch];
+  auto iter = std::upper_bound(
+      busy.begin(), busy.end(), from,
+      [](uint64_t tick, const Interval &i) { return tick < i.end; });
+
+  for (; iter != busy.end() && iter->begin < from + len; iter++) {
+    from = MAX(from, iter->end);
+  }
+
+  return from;
+}
+
+void PALQueue::reserveChannel(uint32_t ch, uint64_t begin, uint64_t len) {
+  auto &busy = channels[ch];
+
+  if (len == 0) {
+    return;
+  }
+
+  auto iter = std::upper_bound(
+      busy.begin(), busy.end(), begin,
+      [](uint64_t tick, const Interval &i) { return tick < i.begin; });
+
+  busy.insert(iter, {begin, begin + len});
+}
+
+void PALQueue::releaseChannel(uint32_t ch, uint64_t begin, uint64_t len) {
+  auto &busy = channels[ch];
+
+  if (len == 0) {
+    return;
+  }
+
+  auto iter = std::lower_bound(
+      busy.begin(), busy.end(), begin,
+      [](const Interval &i, uint64_t tick) { return i.begin < tick; });
+
+  if (iter == busy.end() || iter->begin != begin) {
+    panic("Channel is not reserved");
+  }
+
+  busy.erase(iter);
+}
+
+// Drop busy time before tick
+void PALQueue::pruneChannel(uint32_t ch, uint64_t tick) {
+  auto &busy = channels[ch];
+  auto iter = std::upper_bound(
+      busy.begin(), busy.end(), tick,
+      [](uint64_t tick, const Interval &i) { return tick < i.end; });
+
+  busy.erase(busy.begin(), iter);
+}
+
+// Die is occupied from DMA0 to DMA1, as in PAL2
+void PALQueue::place(Command &cmd, uint32_t ch, uint64_t from) {
+  cmd.startedAt = findChannel(ch, from, cmd.dma0);
+  reserveChannel(ch, cmd.startedAt, cmd.dma0);
+
+  cmd.dma1At = findChannel(ch, cmd.startedAt + cmd.dma0 + cmd.mem, cmd.dma1);
+  reserveChannel(ch, cmd.dma1At, cmd.dma1);
+
+  cmd.finishedAt = cmd.dma1At + cmd.dma1;
+}
+
+// Suspend program or erase in memory operation to serve read
+bool PALQueue::suspend(Die &die, std::deque<Command>::iterator op,
+                       Command &cmd) {
+  uint64_t memAt = op->startedAt + op->dma0;
+
+  if (!useSuspend || cmd.oper != OPER_READ || op->oper == OPER_READ ||
+      op->suspended >= maxSuspend || op->priority < cmd.priority) {
+    return false;
+  }
+
+  // Not worth to suspend when memory operation is about to finish
+  if (cmd.arrived < memAt ||
+      cmd.arrived + suspendLatency >= memAt + op->mem) {
+    return false;
+  }
+
+  // Die is serving read of previous suspend
+  if (op != die.queue.begin() && (op - 1)->finishedAt > cmd.arrived) {
+    return false;
+  }
+
+  uint64_t finishedAt = op->finishedAt;
+  uint64_t saved;
+
+  releaseChannel(die.channel, op->dma1At, op->dma1);
+
+  place(cmd, die.channel, cmd.arrived + suspendLatency);
+
+  // Resume after read, later than completion returned to FTL
+  op->mem += cmd.finishedAt - cmd.arrived;
+  op->suspended++;
+  op->dma1At = findChannel(die.channel, memAt + op->mem, op->dma1);
+  op->finishedAt = op->dma1At + op->dma1;
+  reserveChannel(die.channel, op->dma1At, op->dma1);
+
+  // Without suspend, read starts after the operation
+  saved = finishedAt > cmd.startedAt ? finishedAt - cmd.startedAt : 0;
+
+  if (op->oper == OPER_ERASE) {
+    stat.eraseSuspendCount++;
+  }
+  else {
+    stat.programSuspendCount++;
+  }
+
+  stat.suspendDelay += op->finishedAt - finishedAt;
+  stat.suspendSaved += saved;
+  stat.maxSuspendSaved = MAX(stat.maxSuspendSaved, saved);
+
+  return true;
+}
+
+void PALQueue::submit(::Command &req, ::CPDPBP &addr, bool gc) {
+  Die &die = dies[getDieIndex(addr)];
+  Command cmd;
+
+  cmd.oper = req.operation;
+  cmd.copyback = req.copyback;
+  cmd.priority = getPriority(req.operation, gc);
+  cmd.arrived = req.arrived;
+  cmd.suspended = 0;
+  cmd.dma0 = req.getBusyLatency(lat, addr.Page, BUSY_DMA0);
+  cmd.mem = req.getBusyLatency(lat, addr.Page, BUSY_MEM);
+  cmd.dma1 = req.getBusyLatency(lat, addr.Page, BUSY_DMA1);
+
+  pruneChannel(die.channel, getTick());
+
+  // Bypass commands with lower priority or arrived later, which are not
+  // started on arrival of this command
+  auto pos = die.queue.end();
+
+  while (pos != die.queue.begin() && die.queue.end() - pos < MAX_BYPASS) {
+    auto prev = pos - 1;
+
+    if (prev->startedAt <= cmd.arrived || prev->priority < cmd.priority ||
+        (prev->priority == cmd.priority && prev->arrived <= cmd.arrived)) {
+      break;
+    }
+
+    pos = prev;
+  }
+
+  uint64_t bypass = die.queue.end() - pos;
+
+  if (bypass > 0) {
+    // Keep state to roll back bypass which breaks returned completion
+    auto queue = die.queue;
+    auto busy = channels[die.channel];
+    auto backup = stat;
+
+    while (!enqueue(die, cmd, bypass)) {
+      die.queue = queue;
+      channels[die.channel] = busy;
+      stat = backup;
+
+      stat.bypassDenied++;
+      bypass--;
+    }
+  }
+  else {
+    enqueue(die, cmd, 0);
+  }
+
+  stat.maxQueueDepth = MAX(stat.maxQueueDepth, die.queue.size());
+  stat.oper[cmd.oper].count += req.planes;
+
+  if (cmd.copyback) {
+    stat.copybackCount += req.planes;
+  }
+
+  if (req.planes > 1) {
+    stat.multiPlaneCount++;
+  }
+
+  schedule(die.retireEvent, die.queue.front().finishedAt);
+
+  req.finished = cmd.finishedAt;
+}
+
+// Insert command before last bypass commands of die queue and push them back
+// Returns false if any of them finishes after its returned completion.
+bool PALQueue::enqueue(Die &die, Command &cmd, uint64_t bypass) {
+  auto pos = die.queue.end() - bypass;
+
+  for (auto iter = pos; iter != die.queue.end(); iter++) {
+    releaseChannel(die.channel, iter->startedAt, iter->dma0);
+    releaseChannel(die.channel, iter->dma1At, iter->dma1);
+  }
+
+  uint64_t from = cmd.arrived;
+  auto next = pos;  // First bypassed command
+
+  if (pos != die.queue.begin() && suspend(die, pos - 1, cmd)) {
+    // Read finishes before suspended command
+    cmd.returned = cmd.finishedAt;
+    pos = die.queue.insert(pos - 1, cmd);
+    next = pos + 2;
+  }
+  else {
+    if (pos != die.queue.begin()) {
+      from = MAX(from, (pos - 1)->finishedAt);
+    }
+
+    place(cmd, die.channel, from);
+    cmd.returned = cmd.finishedAt;
+    pos = die.queue.insert(pos, cmd);
+    next = pos + 1;
+  }
+
+  // Push back bypassed commands
+  from = (next - 1)->finishedAt;
+
+  for (auto iter = next; iter != die.queue.end(); iter++) {
+    uint64_t finishedAt = iter->finishedAt;
+
+    place(*iter, die.channel, MAX(from, iter->arrived));
+
+    if (iter->finishedAt > iter->returned) {
+      return false;
+    }
+
+    stat.bypassCount++;
+
+    if (iter->finishedAt > finishedAt) {
+      stat.bypassDelay += iter->finishedAt - finishedAt;
+    }
+
+    from = iter->finishedAt;
+  }
+
+  return true;
+}
+
+void PALQueue::retire(uint32_t idx, uint64_t tick) {
+  Die &die = dies[idx];
+
+  while (die.queue.size() > 0 && die.queue.front().finishedAt <= tick) {
+    Command &cmd = die.queue.front();
+    OperStat &operStat = stat.oper[cmd.oper];
+    uint64_t wait = cmd.startedAt - cmd.arrived;
+
+    operStat.retired++;
+    operStat.waitTime += wait;
+    operStat.maxWaitTime = MAX(operStat.maxWaitTime, wait);
+    operStat.totalTime += cmd.finishedAt - cmd.arrived;
+
+    die.queue.pop_front();
+  }
+
+  if (die.queue.size() > 0) {
+    schedule(die.retireEvent, die.queue.front().finishedAt);
+  }
+}
+
+void PALQueue::read(Request &req, uint64_t &tick) {
+  uint64_t finishedAt = tick;
+  ::Command cmd(tick, 0, OPER_READ, param.superPageSize);
+  std::vector<::CPDPBP> list;
+
+  cmd.slc = req.slc;
+
+  printPPN(req, "READ");
+
+  convertCPDPBP(req, list);
+
+  for (uint64_t i = 0; i < list.size(); i += cmd.planes) {
+    auto &iter = list.at(i);
+
+    printCPDPBP(iter, "READ");
+
+    cmd.planes = getMultiPlaneCount(list, i);
+
+    submit(cmd, iter, req.gc);
+
+    finishedAt = MAX(finishedAt, cmd.finished);
+  }
+
+  tick = finishedAt;
+}
+
+void PALQueue::write(Request &req, uint64_t &tick) {
+  uint64_t finishedAt = tick;
+  ::Command cmd(tick, 0, OPER_WRITE, param.superPageSize);
+  std::vector<::CPDPBP> list;
+
+  cmd.slc = req.slc;
+
+  printPPN(req, "WRITE");
+
+  convertCPDPBP(req, list);
+
+  for (uint64_t i = 0; i < list.size(); i += cmd.planes) {
+    auto &iter = list.at(i);
+
+    printCPDPBP(iter, "WRITE");
+
+    cmd.planes = getMultiPlaneCount(list, i);
+
+    submit(cmd, iter, req.gc);
+
+    finishedAt = MAX(finishedAt, cmd.finished);
+  }
+
+  tick = finishedAt;
+}
+
+void PALQueue::erase(Request &req, uint64_t &tick) {
+  uint64_t finishedAt = tick;
+  ::Command cmd(tick, 0, OPER_ERASE, param.superPageSize * param.page);
+  std::vector<::CPDPBP> list;
+
+  cmd.slc = req.slc;
+
+  printPPN(req, "ERASE");
+
+  convertCPDPBP(req, list);
+
+  for (uint64_t i = 0; i < list.size(); i += cmd.planes) {
+    auto &iter = list.at(i);
+
+    printCPDPBP(iter, "ERASE");
+
+    cmd.planes = getMultiPlaneCount(list, i);
+
+    submit(cmd, iter, req.gc);
+
+    finishedAt = MAX(finishedAt, cmd.finished);
+  }
+
+  tick = finishedAt;
+}
+
+void PALQueue::copyback(Request &from, Request &to, uint64_t &tick) {
+  uint64_t finishedAt = tick;
+  ::Command cmd(tick, 0, OPER_WRITE, param.superPageSize);
+  std::vector<::CPDPBP> source;
+  std::vector<::CPDPBP> list;
+
+  printPPN(from, "CBSRC");
+  printPPN(to, "CBDST");
+
+  convertCPDPBP(from, source);
+  convertCPDPBP(to, list);
+
+  if (source.size() != list.size()) {
+    panic("I/O flag of copyback source and destination does not match");
+  }
+
+  cmd.copyback = true;
+
+  for (uint64_t i = 0; i < list.size(); i += cmd.planes) {
+    auto &src = source.at(i);
+    auto &dst = list.at(i);
+
+    if (src.Channel != dst.Channel || src.Package != dst.Package ||
+        src.Die != dst.Die || src.Plane != dst.Plane) {
+      panic("Copyback across planes is not supported");
+    }
+
+    printCPDPBP(dst, "CPBK");
+
+    cmd.sourcePage = src.Page;
+    cmd.planes =
+        MIN(getMultiPlaneCount(source, i), getMultiPlaneCount(list, i));
+
+    submit(cmd, dst, to.gc);
+
+    finishedAt = MAX(finishedAt, cmd.finished);
+  }
+
+  tick = finishedAt;
+}
+
+PAGE_TYPE PALQueue::getPageType(uint32_t pageIndex) {
+  return (PAGE_TYPE)lat->GetPageType(pageIndex);
+}
+
+void PALQueue::printCPDPBP(::CPDPBP &addr, const char *prefix) {
+  debugprint(LOG_PAL_QUEUE,
+             "%-5s | C %5u | W %5u | D %5u | P %5u | B %5u | P %5u", prefix,
+             addr.Channel, addr.Package, addr.Die, addr.Plane, addr.Block,
+             addr.Page);
+}
+
+void PALQueue::printPPN(Request &req, const char *prefix) {
+  debugprint(LOG_PAL_QUEUE, "%-5s | Block %u | Page %u", prefix,
+             req.blockIndex, req.pageIndex);
+}
+
+void PALQueue::getStatList(std::vector<Stats> &list, std::string prefix) {
+  static const char name[OPER_NUM][8] = {"read", "program", "erase"};
+  Stats temp;
+
+  for (int i = 0; i < OPER_NUM; i++) {
+    temp.name = prefix + name[i] + ".count";
+    temp.desc = std::string("Total ") + name[i] + " operation count";
+    list.push_back(temp);
+  }
+
+  temp.name = prefix + "copyback.count";
+  temp.desc = "Total copyback operation count";
+  list.push_back(temp);
+
+  temp.name = prefix + "multiplane.count";
+  temp.desc = "Total multi-plane operation count";
+  list.push_back(temp);
+
+  for (int i = 0; i < OPER_NUM; i++) {
+    temp.name = prefix + name[i] + ".bytes";
+    temp.desc = std::string("Total ") + name[i] + " operation bytes";
+    list.push_back(temp);
+  }
+
+  for (int i = 0; i < OPER_NUM; i++) {
+    temp.name = prefix + name[i] + ".time.wait";
+    temp.desc = std::string("Average queueing delay of ") + name[i];
+    list.push_back(temp);
+
+    temp.name = prefix + name[i] + ".time.wait.max";
+    temp.desc = std::string("Maximum queueing delay of ") + name[i];
+    list.push_back(temp);
+
+    temp.name = prefix + name[i] + ".time.total";
+    temp.desc = std::string("Average time of ") + name[i];
+    list.push_back(temp);
+  }
+
+  temp.name = prefix + "queue.bypass.count";
+  temp.desc = "Commands pushed back by command with higher priority";
+  list.push_back(temp);
+
+  temp.name = prefix + "queue.bypass.delay";
+  temp.desc = "Average delay of pushed back command";
+  list.push_back(temp);
+
+  temp.name = prefix + "queue.bypass.denied";
+  temp.desc = "Bypasses given up as command would finish after returned time";
+  list.push_back(temp);
+
+  temp.name = prefix + "queue.depth.max";
+  temp.desc = "Maximum number of commands in die queue";
+  list.push_back(temp);
+
+  temp.name = prefix + "suspend.program.count";
+  temp.desc = "Total program suspend count";
+  list.push_back(temp);
+
+  temp.name = prefix + "suspend.erase.count";
+  temp.desc = "Total erase suspend count";
+  list.push_back(temp);
+
+  temp.name = prefix + "suspend.delay";
+  temp.desc = "Average delay of suspended operation per suspend, not "
+              "visible to FTL";
+  list.push_back(temp);
+
+  temp.name = prefix + "suspend.saved";
+  temp.desc = "Average read latency saved by suspend";
+  list.push_back(temp);
+
+  temp.name = prefix + "suspend.saved.max";
+  temp.desc = "Maximum read latency saved by suspend";
+  list.push_back(temp);
+}
+
+void PALQueue::getStatValues(std::vector<double> &values) {
+  for (int i = 0; i < OPER_NUM; i++) {
+    values.push_back(stat.oper[i].count);
+  }
+
+  values.push_back(stat.copybackCount);
+  values.push_back(stat.multiPlaneCount);
+
+  values.push_back(stat.oper[OPER_READ].count * param.pageSize);
+  values.push_back(stat.oper[OPER_WRITE].count * param.pageSize);
+  values.push_back(stat.oper[OPER_ERASE].count * param.pageSize * param.page);
+
+  for (int i = 0; i < OPER_NUM; i++) {
+    OperStat &operStat = stat.oper[i];
+
+    if (operStat.retired > 0) {
+      values.push_back((double)operStat.waitTime / operStat.retired);
+      values.push_back(operStat.maxWaitTime);
+      values.push_back((double)operStat.totalTime / operStat.retired);
+    }
+    else {
+      values.push_back(0.);
+      values.push_back(0.);
+      values.push_back(0.);
+    }
+  }
+
+  values.push_back(stat.bypassCount);
+  values.push_back(stat.bypassCount > 0
+                       ? (double)stat.bypassDelay / stat.bypassCount
+                       : 0.);
+  values.push_back(stat.bypassDenied);
+  values.push_back(stat.maxQueueDepth);
+
+  uint64_t suspendCount = stat.programSuspendCount + stat.eraseSuspendCount;
+
+  values.push_back(stat.programSuspendCount);
+  values.push_back(stat.eraseSuspendCount);
+
+  if (suspendCount > 0) {
+    values.push_back((double)stat.suspendDelay / suspendCount);
+    values.push_back((double)stat.suspendSaved / suspendCount);
+  }
+  else {
+    values.push_back(0.);
+    values.push_back(0.);
+  }
+
+  values.push_back(stat.maxSuspendSaved);
+}
+
+void PALQueue::resetStatValues() {
+  memset(&stat, 0, sizeof(stat));
+}
+
+}  // namespace PAL
+
+}  // namespace SimpleSSD
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PAL_PAL_QUEUE__
+#define __PAL_PAL_QUEUE__
+
+#include <cinttypes>
+#include <deque>
+#include <vector>
+
+#include "pal/abstract_pal.hh"
+#include "util/old/SimpleSSD_types.h"
+
+struct _Command;
+class Latency;
+
+namespace SimpleSSD {
+
+namespace PAL {
+
+// NAND command scheduler with per-die command queues
+// Completion of command should be returned on submission, so a command is
+// placed into the queue of its die when submitted. A command which is not
+// started yet is bypassed by a command with higher priority, and it is
+// pushed back with its channel transfers. As its completion is already
+// returned, bypass is taken only when all pushed back commands still finish
+// by their returned completion. Otherwise fewer commands are bypassed.
+// Only the last few commands of a queue can be bypassed, so commands with
+// low priority are not starved.
+// When suspend is enabled, read to a die in the middle of program or erase
+// suspends the operation, which resumes after the read. Unlike bypass, the
+// suspended operation finishes after its returned completion. This delay is
+// not visible to FTL, and only shows up in suspend statistics.
+// Commands are retired from queues by events at their completion.
+class PALQueue : public AbstractPAL {
+ private:
+  typedef struct {
+    PAL_OPERATION oper;
+    bool copyback;
+    uint8_t priority;  // Lower is served first
+    uint64_t arrived;
+    uint32_t suspended;  // # of suspends while this command is running
+    uint64_t dma0;       // Latency of each phase
+    uint64_t mem;        // Includes time spent for suspending reads
+    uint64_t dma1;
+    uint64_t startedAt;   // Begin of DMA0
+    uint64_t dma1At;      // Begin of DMA1
+    uint64_t finishedAt;  // End of DMA1
+    uint64_t returned;    // Completion returned on submission
+  } Command;
+
+  typedef struct {
+    uint64_t begin;
+    uint64_t end;
+  } Interval;
+
+  typedef struct {
+    std::deque<Command> queue;  // In start order
+    uint32_t channel;
+    Event retireEvent;
+  } Die;
+
+  typedef struct {
+    uint64_t count;     // Pages
+    uint64_t retired;   // Below are sum of retired commands
+    uint64_t waitTime;  // Queueing delay before DMA0
+    uint64_t maxWaitTime;
+    uint64_t totalTime;
+  } OperStat;
+
+  ::Latency *lat;
+  SCHEDULING_POLICY policy;
+  bool useSuspend;
+  uint32_t maxSuspend;
+  uint64_t suspendLatency;
+
+  std::vector<std::deque<Interval>> channels;  // Busy time of each channel
+  std::vector<Die> dies;
+
+  struct {
+    uint64_t copybackCount;
+    uint64_t multiPlaneCount;
+    OperStat oper[OPER_NUM];
+    uint64_t bypassCount;   // Commands pushed back by other command
+    uint64_t bypassDelay;   // Sum of pushed back time
+    uint64_t bypassDenied;  // Bypasses given up to keep returned completion
+    uint64_t maxQueueDepth;
+    uint64_t programSuspendCount;
+    uint64_t eraseSuspendCount;
+    uint64_t suspendDelay;  // Sum of time added to suspended commands
+    uint64_t suspendSaved;  // Sum of read latency saved by suspend
+    uint64_t maxSuspendSaved;
+  } stat;
+
+  uint8_t getPriority(PAL_OPERATION, bool);
+  uint32_t getDieIndex(::CPDPBP &);
+
+  uint64_t findChannel(uint32_t, uint64_t, uint64_t);
+  void reserveChannel(uint32_t, uint64_t, uint64_t);
+  void releaseChannel(uint32_t, uint64_t, uint64_t);
+  void pruneChannel(uint32_t, uint64_t);
+
+  void place(Command &, uint32_t, uint64_t);
+  bool suspend(Die &, std::deque<Command>::iterator, Command &);
+  bool enqueue(Die &, Command &, uint64_t);
+  void submit(::_Command &, ::CPDPBP &, bool);
+  void retire(uint32_t, uint64_t);
+
+  void printCPDPBP(::CPDPBP &, const char *);
+  void printPPN(Request &, const char *);
+
+ public:
+  PALQueue(Parameter &, ConfigReader &);
+  ~PALQueue();
+
+  void read(Request &, uint64_t &) override;
+  void write(Request &, uint64_t &) override;
+  void erase(Request &, uint64_t &) override;
+  void copyback(Request &, Request &, uint64_t &) override;
+
+  PAGE_TYPE getPageType(uint32_t) override;
+
+  void getStatList(std::vector<Stats> &, std::string) override;
+  void getStatValues(std::vector<double> &) override;
+  void resetStatValues() override;
+};
+
+}  // namespace PAL
+
+}  // namespace SimpleSSD
+
+#endif
@@ -105,8 +105,12 @@ const std::string logName[LOG_NUM] = {
     "ICL::GenericCache",  //!< LOG_ICL_GENERIC_CACHE
     "FTL",                //!< LOG_FTL
     "FTL::PageMapping",   //!< LOG_FTL_PAGE_MAPPING
+    "FTL::DFTL",          //!< LOG_FTL_DFTL
+    "FTL::NKMapping",     //!< LOG_FTL_NK_MAPPING
     "PAL",                //!< LOG_PAL
     "PAL::PALOLD",        //!< LOG_PAL_OLD
+    "PAL::PALQueue",      //!< LOG_PAL_QUEUE
+    "PAL::PALLite",       //!< LOG_PAL_LITE
 };
 
 void debugprint(LOG_ID id, const char *format, ...) {
@@ -25,22 +25,18 @@
 
 namespace SimpleSSD {
 
-template <class T>
-void StateObject::pushValue(std::vector<uint8_t> &data, T value) {
-  uint32_t valueSize = sizeof(value);
-  uint8_t *src = (uint8_t *)&value;
+void StateObject::pushArray(std::vector<uint8_t> &data, const void *value,
+                            uint64_t valueSize) {
   uint8_t *dst = nullptr;
 
   data.resize(data.size() + valueSize);
 
   dst = data.data() + data.size() - valueSize;
-  memcpy(dst, src, valueSize);
+  memcpy(dst, value, valueSize);
 }
 
-template <class T>
-void StateObject::popValue(std::vector<uint8_t> &data, T value) {
-  uint32_t valueSize = sizeof(value);
-  uint8_t *dst = (uint8_t *)&value;
+void StateObject::popArray(std::vector<uint8_t> &data, void *value,
+                           uint64_t valueSize) {
   uint8_t *src = nullptr;
 
   if (data.size() < valueSize) {
@@ -48,9 +44,9 @@ void StateObject::popValue(std::vector<uint8_t> &data, T value) {
   }
 
   src = data.data() + data.size() - valueSize;
-  memcpy(dst, src, valueSize);
+  memcpy(value, src, valueSize);
 
-  data.erase(data.begin() + data.size() - valueSize, data.end());
+  data.resize(data.size() - valueSize);
 }
 
 }  // namespace SimpleSSD
@@ -27,12 +27,22 @@
 
 namespace SimpleSSD {
 
+// Values are pushed to and popped from the end of data stream,
+// so loadState should pop values in reverse order of saveState.
 class StateObject {
  protected:
+  static void pushArray(std::vector<uint8_t> &, const void *, uint64_t);
+  static void popArray(std::vector<uint8_t> &, void *, uint64_t);
+
   template <class T>
-  static void pushValue(std::vector<uint8_t> &, T);
+  static void pushValue(std::vector<uint8_t> &data, T value) {
+    pushArray(data, &value, sizeof(T));
+  }
+
   template <class T>
-  static void popValue(std::vector<uint8_t> &, T);
+  static void popValue(std::vector<uint8_t> &data, T &value) {
+    popArray(data, &value, sizeof(T));
+  }
 
  public:
   StateObject() {}
@@ -37,8 +37,12 @@ typedef enum {
   LOG_ICL_GENERIC_CACHE,
   LOG_FTL,
   LOG_FTL_PAGE_MAPPING,
+  LOG_FTL_DFTL,
+  LOG_FTL_NK_MAPPING,
   LOG_PAL,
   LOG_PAL_OLD,
+  LOG_PAL_QUEUE,
+  LOG_PAL_LITE,
   LOG_NUM
 } LOG_ID;
 
@@ -35,6 +35,7 @@ Request::_Request()
       reqSubID(0),
       offset(0),
       length(0),
+      streamID(0),
       finishedAt(0),
       context(nullptr) {}
 
@@ -43,6 +44,7 @@ Request::_Request(DMAFunction &f, void *c)
       reqSubID(0),
       offset(0),
       length(0),
+      streamID(0),
       finishedAt(0),
       function(f),
       context(c) {}
@@ -55,21 +57,34 @@ bool Request::operator()(const Request &a, const Request &b) {
 
 namespace ICL {
 
-Request::_Request() : reqID(0), reqSubID(0), offset(0), length(0) {}
+Request::_Request()
+    : reqID(0),
+      reqSubID(0),
+      offset(0),
+      length(0),
+      streamID(0),
+      hostLength(0) {}
 
 Request::_Request(HIL::Request &r)
     : reqID(r.reqID),
       reqSubID(r.reqSubID),
       offset(r.offset),
       length(r.length),
-      range(r.range) {}
+      range(r.range),
+      streamID(r.streamID),
+      hostLength(r.length) {}
 
 }  // namespace ICL
 
 namespace FTL {
 
 Request::_Request(uint32_t iocount)
-    : reqID(0), reqSubID(0), lpn(0), ioFlag(iocount) {}
+    : reqID(0),
+      reqSubID(0),
+      lpn(0),
+      ioFlag(iocount),
+      streamID(0),
+      hostLength(0) {}
 
 Request::_Request(uint32_t iocount, ICL::Request &r)
     : reqID(r.reqID),
@@ -78,7 +93,9 @@ Request::_Request(uint32_t iocount, ICL::Request &r)
       // since iocount stands for page# per superpage
       lpn(r.range.slpn / iocount),
       // mjo: Represents pages in a superpage. Each bit maps to a page
-      ioFlag(iocount) {
+      ioFlag(iocount),
+      streamID(r.streamID),
+      hostLength(r.hostLength) {
   ioFlag.set(r.range.slpn % iocount);
 }
 
@@ -87,14 +104,22 @@ Request::_Request(uint32_t iocount, ICL::Request &r)
 namespace PAL {
 
 Request::_Request(uint32_t iocount)
-    : reqID(0), reqSubID(0), blockIndex(0), pageIndex(0), ioFlag(iocount) {}
+    : reqID(0),
+      reqSubID(0),
+      blockIndex(0),
+      pageIndex(0),
+      ioFlag(iocount),
+      slc(false),
+      gc(false) {}
 
 Request::_Request(FTL::Request &r)
     : reqID(r.reqID),
       reqSubID(r.reqSubID),
       blockIndex(0),
       pageIndex(0),
-      ioFlag(r.ioFlag) {}
+      ioFlag(r.ioFlag),
+      slc(false),
+      gc(false) {}
 
 }  // namespace PAL
 
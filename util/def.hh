@@ -45,6 +45,7 @@ typedef struct _Request {
   uint64_t offset;
   uint64_t length;
   LPNRange range;
+  uint32_t streamID;  // Stream identifier from host, 0 if not specified
 
   uint64_t finishedAt;
   DMAFunction function;
@@ -66,6 +67,8 @@ typedef struct _Request {
   uint64_t offset;
   uint64_t length;
   LPNRange range;
+  uint32_t streamID;
+  uint64_t hostLength;  // Length of whole host request in bytes
 
   _Request();
   _Request(HIL::Request &);
@@ -80,6 +83,8 @@ typedef struct _Request {
   uint64_t reqSubID;
   uint64_t lpn;
   Bitset ioFlag;
+  uint32_t streamID;
+  uint64_t hostLength;  // Length of host request in bytes, 0 if not from host
 
   _Request(uint32_t);
   _Request(uint32_t, ICL::Request &);
@@ -95,6 +100,8 @@ typedef struct _Request {
   uint32_t blockIndex;
   uint32_t pageIndex;
   Bitset ioFlag;
+  bool slc;  // Block is programmed in SLC mode (pSLC)
+  bool gc;   // Issued by garbage collection
 
   _Request(uint32_t);
   _Request(FTL::Request &);
@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "util/histogram.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "sim/trace.hh"
+
+namespace SimpleSSD {
+
+// Maximum # of points passed to k-means
+// If there are more distinct values, adjacent values are merged.
+const uint64_t MAX_CLUSTER_POINTS = 256;
+
+Histogram::Histogram() : count(0), sum(0), squareSum(0) {}
+
+void Histogram::clear() {
+  bins.clear();
+  count = 0;
+  sum = 0;
+  squareSum = 0;
+}
+
+void Histogram::insert(uint64_t value, uint64_t n) {
+  if (value >= bins.size()) {
+    bins.resize(value + 1, 0);
+  }
+
+  bins[value] += n;
+  count += n;
+  sum += value * n;
+  squareSum += value * value * n;
+}
+
+void Histogram::erase(uint64_t value, uint64_t n) {
+  if (value >= bins.size() || bins[value] < n) {
+    panic("Histogram underflow");
+  }
+
+  bins[value] -= n;
+  count -= n;
+  sum -= value * n;
+  squareSum -= value * value * n;
+}
+
+// Move one sample of given value to value + 1
+void Histogram::increase(uint64_t value) {
+  erase(value);
+  insert(value + 1);
+}
+
+uint64_t Histogram::getCount() {
+  return count;
+}
+
+uint64_t Histogram::getMax() {
+  for (uint64_t i = bins.size(); i > 0; i--) {
+    if (bins[i - 1] > 0) {
+      return i - 1;
+    }
+  }
+
+  return 0;
+}
+
+double Histogram::getMean() {
+  if (count == 0) {
+    return 0.;
+  }
+
+  return (double)sum / count;
+}
+
+double Histogram::getStandardDeviation() {
+  double mean = getMean();
+  double variance;
+
+  if (count == 0) {
+    return 0.;
+  }
+
+  variance = (double)squareSum / count - mean * mean;
+
+  return variance > 0. ? sqrt(variance) : 0.;
+}
+
+// Returns smallest value v which satisfies P(X <= v) >= q
+uint64_t Histogram::getQuantile(double q) {
+  uint64_t target = (uint64_t)ceil(q * count);
+  uint64_t acc = 0;
+
+  if (target == 0) {
+    target = 1;
+  }
+
+  for (uint64_t i = 0; i < bins.size(); i++) {
+    acc += bins[i];
+
+    if (acc >= target) {
+      return i;
+    }
+  }
+
+  return getMax();
+}
+
+// Optimal 1-D k-means over histogram bins (Gronlund et al., 2017)
+// Points are distinct values weighted by sample count, so this is exact when
+// there are at most MAX_CLUSTER_POINTS distinct values, and approximate
+// otherwise. Centroids are returned in ascending order. When there are fewer
+// points than clusters, smallest point is split into several clusters.
+void Histogram::getCentroids(uint32_t k, std::vector<double> &centroids) {
+  std::vector<double> weight;
+  std::vector<double> value;
+  uint64_t distinct = 0;
+  uint64_t width;
+
+  centroids.clear();
+
+  if (k == 0) {
+    return;
+  }
+
+  if (count == 0) {
+    centroids.resize(k, 0.);
+
+    return;
+  }
+
+  // Collect points
+  for (auto &iter : bins) {
+    if (iter > 0) {
+      distinct++;
+    }
+  }
+
+  width = (bins.size() + MAX_CLUSTER_POINTS - 1) / MAX_CLUSTER_POINTS;
+
+  if (distinct <= MAX_CLUSTER_POINTS) {
+    width = 1;
+  }
+
+  for (uint64_t begin = 0; begin < bins.size(); begin += width) {
+    uint64_t end = std::min<uint64_t>(begin + width, bins.size());
+    double w = 0.;
+    double s = 0.;
+
+    for (uint64_t i = begin; i < end; i++) {
+      w += bins[i];
+      s += (double)bins[i] * i;
+    }
+
+    if (w > 0.) {
+      weight.push_back(w);
+      value.push_back(s / w);
+    }
+  }
+
+  uint64_t n = weight.size();
+
+  if (n <= k) {
+    // Extra clusters have same centroid with smallest point
+    centroids.resize(k - n, value[0]);
+    centroids.insert(centroids.end(), value.begin(), value.end());
+
+    return;
+  }
+
+  // Prefix sums for O(1) cluster cost
+  std::vector<double> w(n + 1, 0.);
+  std::vector<double> ws(n + 1, 0.);
+  std::vector<double> ws2(n + 1, 0.);
+
+  for (uint64_t i = 0; i < n; i++) {
+    w[i + 1] = w[i] + weight[i];
+    ws[i + 1] = ws[i] + weight[i] * value[i];
+    ws2[i + 1] = ws2[i] + weight[i] * value[i] * value[i];
+  }
+
+  // Cost of cluster [i, j]
+  auto cost = [&](uint64_t i, uint64_t j) -> double {
+    double sw = w[j + 1] - w[i];
+    double s = ws[j + 1] - ws[i];
+
+    return ws2[j + 1] - ws2[i] - s * s / sw;
+  };
+
+  // D[c][j]: Minimum cost of clustering points [0, j] into c + 1 clusters
+  std::vector<std::vector<double>> D(k, std::vector<double>(n));
+  std::vector<std::vector<uint64_t>> T(k, std::vector<uint64_t>(n, 0));
+
+  for (uint64_t j = 0; j < n; j++) {
+    D[0][j] = cost(0, j);
+  }
+
+  for (uint32_t c = 1; c < k; c++) {
+    for (uint64_t j = c; j < n; j++) {
+      D[c][j] = std::numeric_limits<double>::infinity();
+
+      for (uint64_t i = c; i <= j; i++) {
+        double d = D[c - 1][i - 1] + cost(i, j);
+
+        if (d < D[c][j]) {
+          D[c][j] = d;
+          T[c][j] = i;
+        }
+      }
+    }
+  }
+
+  // Backtrack
+  centroids.resize(k);
+
+  uint64_t end = n - 1;
+
+  for (uint32_t c = k; c > 0; c--) {
+    uint64_t begin = T[c - 1][end];
+
+    centroids[c - 1] = (ws[end + 1] - ws[begin]) / (w[end + 1] - w[begin]);
+
+    if (begin > 0) {
+      end = begin - 1;
+    }
+  }
+}
+
+}  // namespace SimpleSSD
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2017 CAMELab
+ *
+ * This file is part of SimpleSSD.
+ *
+ * SimpleSSD is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimpleSSD is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimpleSSD.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#ifndef __UTIL_HISTOGRAM__
+#define __UTIL_HISTOGRAM__
+
+#include <cinttypes>
+#include <vector>
+
+namespace SimpleSSD {
+
+// Histogram of small non-negative integer samples, such as write count of
+// physical pages. Memory usage is proportional to the largest sample value,
+// not to the number of samples.
+class Histogram {
+ private:
+  std::vector<uint64_t> bins;  // bins[v] = # of samples of value v
+  uint64_t count;
+  uint64_t sum;
+  uint64_t squareSum;
+
+ public:
+  Histogram();
+
+  void clear();
+  void insert(uint64_t, uint64_t = 1);
+  void erase(uint64_t, uint64_t = 1);
+  void increase(uint64_t);
+
+  uint64_t getCount();
+  uint64_t getMax();
+  double getMean();
+  double getStandardDeviation();
+  uint64_t getQuantile(double);
+  void getCentroids(uint32_t, std::vector<double> &);
+};
+
+}  // namespace SimpleSSD
+
+#endif